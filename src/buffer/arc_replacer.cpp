@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) : capacity_(num_frames) {}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < capacity_, "invalid frame id");
+  std::scoped_lock lock{latch_};
+  auto it = frames_.find(frame_id);
+  if (it != frames_.end()) {
+    // A hit: the frame has now been seen at least twice and becomes the most recently used frame of T2.
+    if (access_type != AccessType::Scan) {
+      ResidentList(it->second.list_).erase(it->second.pos_);
+      it->second.list_ = ListId::T2;
+      it->second.pos_ = t2_.insert(t2_.end(), frame_id);
+    }
+    return;
+  }
+
+  page_id_t key = page_id == INVALID_PAGE_ID ? frame_id : page_id;
+  ListId list = ListId::T1;
+  if (auto ghost = ghosts_.find(key); ghost != ghosts_.end()) {
+    if (access_type != AccessType::Scan) {
+      // A ghost hit in B1 means T1 was too small, one in B2 that T2 was.
+      if (ghost->second.list_ == ListId::B1) {
+        p_ = std::min(capacity_, p_ + std::max<size_t>(1, b2_.size() / b1_.size()));
+      } else {
+        p_ -= std::min(p_, std::max<size_t>(1, b1_.size() / b2_.size()));
+      }
+      list = ListId::T2;
+    }
+    (ghost->second.list_ == ListId::B1 ? b1_ : b2_).erase(ghost->second.pos_);
+    ghosts_.erase(ghost);
+  } else {
+    // Keep |T1| + |B1| <= c and the whole directory <= 2c.
+    if (t1_.size() + b1_.size() >= capacity_ && !b1_.empty()) {
+      DropGhost(ListId::B1);
+    }
+    if (t1_.size() + t2_.size() + b1_.size() + b2_.size() >= 2 * capacity_) {
+      DropGhost(b2_.empty() ? ListId::B1 : ListId::B2);
+    }
+  }
+  auto &resident = ResidentList(list);
+  frames_[frame_id] = FrameInfo{list, resident.insert(resident.end(), frame_id), key, false};
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock lock{latch_};
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end() || it->second.is_evictable_ == set_evictable) {
+    return;
+  }
+  it->second.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+auto ARCReplacer::EvictFrom(ListId list, frame_id_t *frame_id) -> bool {
+  auto &resident = ResidentList(list);
+  for (auto pos = resident.begin(); pos != resident.end(); ++pos) {
+    auto info = frames_.find(*pos);
+    if (!info->second.is_evictable_) {
+      continue;
+    }
+    *frame_id = *pos;
+    auto &ghosts = list == ListId::T1 ? b1_ : b2_;
+    ListId ghost_list = list == ListId::T1 ? ListId::B1 : ListId::B2;
+    ghosts_[info->second.key_] = GhostInfo{ghost_list, ghosts.insert(ghosts.end(), info->second.key_)};
+    resident.erase(pos);
+    frames_.erase(info);
+    curr_size_--;
+    return true;
+  }
+  return false;
+}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock{latch_};
+  if (curr_size_ == 0) {
+    return false;
+  }
+  if (!t1_.empty() && t1_.size() > p_) {
+    return EvictFrom(ListId::T1, frame_id) || EvictFrom(ListId::T2, frame_id);
+  }
+  return EvictFrom(ListId::T2, frame_id) || EvictFrom(ListId::T1, frame_id);
+}
+
+void ARCReplacer::DropGhost(ListId list) {
+  auto &ghosts = list == ListId::B1 ? b1_ : b2_;
+  if (ghosts.empty()) {
+    return;
+  }
+  ghosts_.erase(ghosts.front());
+  ghosts.pop_front();
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock{latch_};
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    return;
+  }
+  if (!it->second.is_evictable_) {
+    throw Exception("cannot remove a non-evictable frame from the replacer");
+  }
+  ResidentList(it->second.list_).erase(it->second.pos_);
+  frames_.erase(it);
+  curr_size_--;
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::scoped_lock lock{latch_};
+  return curr_size_;
+}
+
+}  // namespace bustub
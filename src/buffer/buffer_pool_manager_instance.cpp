@@ -0,0 +1,929 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.cpp
+//
+// Identification: src/buffer/buffer_pool_manager_instance.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_instance.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+#include "fmt/format.h"
+#include "storage/page/page_checksum.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     const FrameArenaOptions &arena_options)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, replacer_policy,
+                                arena_options) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, size_t num_instances, size_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     const FrameArenaOptions &arena_options)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(pool_size) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(instance_index < num_instances,
+                "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should "
+                "just be 0.");
+#ifdef BUSTUB_PER_PAGE_FRAMES
+  pages_ = new Page[pool_size_];
+#else
+  // we allocate a consecutive memory space for the buffer pool
+  arena_ = std::make_unique<FrameArena>(pool_size_, arena_options, num_instances, instance_index);
+  pages_ = static_cast<Page *>(::operator new[](sizeof(Page) * pool_size_));
+  for (size_t i = 0; i < pool_size_; ++i) {
+    new (&pages_[i]) Page(arena_->GetFrame(static_cast<frame_id_t>(i)));
+  }
+#endif
+  frames_ = std::make_unique<FrameHeader[]>(pool_size_);
+  replacer_ = MakeReplacer(replacer_policy, pool_size, replacer_k);
+  // Initially, every page is in the free list.
+  for (size_t i = 0; i < pool_size_; ++i) {
+    free_list_.emplace_back(static_cast<int>(i));
+  }
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopBackgroundWriter();
+  {
+    std::scoped_lock lock{prefetch_latch_};
+    stop_prefetch_ = true;
+    prefetch_cv_.notify_one();
+  }
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+#ifdef BUSTUB_PER_PAGE_FRAMES
+  delete[] pages_;
+#else
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_);
+#endif
+}
+
+auto BufferPoolManagerInstance::AcquireLatch() -> std::unique_lock<std::mutex> {
+  std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    num_latch_waits_.fetch_add(1, std::memory_order_relaxed);
+    lock.lock();
+  }
+  return lock;
+}
+
+void BufferPoolManagerInstance::GetReplaceFrameId(frame_id_t *frame_id, bool keep_prefetched) {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return;
+  }
+  if (ReclaimRetiredFrame(frame_id)) {
+    return;
+  }
+  std::vector<std::pair<frame_id_t, AccessType>> skipped;
+  size_t second_chances = 0;
+  bool found;
+  while ((found = replacer_->Evict(frame_id))) {
+    FrameHeader &frame = frames_[*frame_id];
+    page_id_t victim_page_id = frame.page_id_.load(std::memory_order_relaxed);
+    if (keep_prefetched && frame.prefetched_.load(std::memory_order_relaxed)) {
+      skipped.emplace_back(*frame_id, AccessType::Scan);
+      continue;
+    }
+    // Pin-free readers used the frame since it was last picked, which the replacer has not seen: record one access.
+    if (frame.referenced_.exchange(false, std::memory_order_relaxed) && second_chances++ < pool_size_) {
+      replacer_->RecordAccess(*frame_id, AccessType::Unknown, victim_page_id);
+      replacer_->SetEvictable(*frame_id, true);
+      continue;
+    }
+    if (victim_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    /* The victim still holds a page: write it back if needed and drop it from the page table. */
+    if (frame.is_dirty_.load(std::memory_order_relaxed)) {
+      num_fg_writes_.fetch_add(1, std::memory_order_relaxed);
+      WritePageToDisk(*frame_id);
+      if (enable_bg_writer_.load(std::memory_order_relaxed)) {
+        std::scoped_lock lock{bg_writer_latch_};
+        bg_writer_wakeup_ = true;
+        bg_writer_cv_.notify_one();
+      }
+    }
+    if (!DetachFrame(*frame_id)) {
+      skipped.emplace_back(*frame_id, AccessType::Unknown);
+      continue;
+    }
+    num_evictions_.fetch_add(1, std::memory_order_relaxed);
+    if (compressed_cache_ != nullptr) {
+      compressed_cache_->Insert(victim_page_id, pages_[*frame_id].GetData());
+    }
+    // A frame a pin-free reader may still look at stays retired; an older retired frame may be free by now, or else
+    // the next victim is tried. Waiting here would hold the latch for as long as readers keep entering epochs.
+    if (RetireFrame(*frame_id) || ReclaimRetiredFrame(frame_id)) {
+      break;
+    }
+  }
+  // Hand the skipped frames back in the order they came out; skipped read-ahead as scan accesses like the ones that
+  // loaded it.
+  for (auto [skipped_frame_id, access_type] : skipped) {
+    replacer_->RecordAccess(skipped_frame_id, access_type,
+                            frames_[skipped_frame_id].page_id_.load(std::memory_order_relaxed));
+    replacer_->SetEvictable(skipped_frame_id, true);
+  }
+  if (!found && !ReclaimRetiredFrame(frame_id)) {
+    *frame_id = -1;
+  }
+}
+
+/**
+ * A recycled frame is only taken back if it is unpinned and still holds the ring's page: a page somebody else pinned
+ * in the meantime is left to them, and a frame the pool reused for another page no longer belongs to the ring. In
+ * both cases the slot moves to a fresh frame, as it does when a pin-free reader still uses the frame. Pins only go
+ * from 0 to 1 under the latch, so an unpinned frame stays unpinned while this runs.
+ */
+auto BufferPoolManagerInstance::GetRingFrameId(BufferRing *ring, frame_id_t *frame_id) -> BufferRing::Slot * {
+  auto &instance_ring = ring->rings_[this];
+  const size_t max_frames = std::max<size_t>(1, pool_size_ / BUFFER_RING_MAX_POOL_FRACTION);
+  const size_t capacity = std::clamp<size_t>(ring->GetNumFrames() / num_instances_, 1, max_frames);
+  if (instance_ring.slots_.size() < capacity) {
+    GetReplaceFrameId(frame_id);
+    if (*frame_id == -1) {
+      return nullptr;
+    }
+    instance_ring.slots_.push_back({*frame_id, INVALID_PAGE_ID});
+    return &instance_ring.slots_.back();
+  }
+
+  auto &slot = instance_ring.slots_[instance_ring.next_];
+  instance_ring.next_ = (instance_ring.next_ + 1) % instance_ring.slots_.size();
+  FrameHeader &frame = frames_[slot.frame_id_];
+  bool recycled = slot.page_id_ != INVALID_PAGE_ID && frame.page_id_.load(std::memory_order_relaxed) == slot.page_id_ &&
+                  frame.pin_count_.load(std::memory_order_relaxed) == 0;
+  if (recycled) {
+    if (frame.is_dirty_.load(std::memory_order_relaxed)) {
+      num_fg_writes_.fetch_add(1, std::memory_order_relaxed);
+      WritePageToDisk(slot.frame_id_);
+    }
+    recycled = DetachFrame(slot.frame_id_);
+  }
+  if (recycled) {
+    replacer_->Remove(slot.frame_id_);
+    num_evictions_.fetch_add(1, std::memory_order_relaxed);
+    recycled = RetireFrame(slot.frame_id_);
+  }
+  if (!recycled) {
+    GetReplaceFrameId(frame_id);
+    if (*frame_id == -1) {
+      return nullptr;
+    }
+    slot.frame_id_ = *frame_id;
+    return &slot;
+  }
+  *frame_id = slot.frame_id_;
+  return &slot;
+}
+
+/**
+ * A pin-free reader latches the frame and then checks that it still holds its page, and we clear the page id and then
+ * check the latch, with a full fence in between on both sides: either we see the latch, or the reader sees the frame
+ * go and looks for the page again under our latch.
+ */
+auto BufferPoolManagerInstance::DetachFrame(frame_id_t frame_id) -> bool {
+  FrameHeader &frame = frames_[frame_id];
+  const page_id_t page_id = frame.page_id_.load(std::memory_order_relaxed);
+  frame.page_id_.store(INVALID_PAGE_ID, std::memory_order_seq_cst);
+  // after the page id, so that an optimistic reader that still saw the page id recorded the version from before
+  pages_[frame_id].version_.fetch_add(2, std::memory_order_seq_cst);
+  if (pages_[frame_id].IsLatched()) {
+    frame.page_id_.store(page_id, std::memory_order_relaxed);
+    return false;
+  }
+  page_table_.Erase(page_id);
+  return true;
+}
+
+auto BufferPoolManagerInstance::RetireFrame(frame_id_t frame_id) -> bool {
+  const uint64_t epoch = epochs_.Advance();
+  if (epoch < epochs_.GetOldestActiveEpoch()) {
+    return true;
+  }
+  retired_frames_.emplace_back(frame_id, epoch);
+  return false;
+}
+
+/**
+ * Pin-free readers leave their epoch right after the lookup and never wait for the latch inside one, so a retired frame
+ * frees up without our help; we only have to get out of the way, the latch included.
+ */
+auto BufferPoolManagerInstance::WaitForRetiredFrames(std::unique_lock<std::mutex> *lock, int round) -> bool {
+  if (retired_frames_.empty() || round >= RETIRED_FRAME_WAIT_ROUNDS) {
+    return false;
+  }
+  lock->unlock();
+  std::this_thread::yield();
+  lock->lock();
+  return true;
+}
+
+/**
+ * An optimistic reader may have read the id of a page before the page was deleted and fetched it after, and the id
+ * may have been allocated again since. The reader pins the frame only until it has recorded a version, and it finds
+ * that the page it came from changed, so the copy only has to go before the new page takes the id. Until it does, the
+ * frame is ours: GetReplaceFrameId took it out of the replacer and the page table.
+ */
+void BufferPoolManagerInstance::DropStaleFrame(std::unique_lock<std::mutex> *lock, page_id_t page_id) {
+  frame_id_t frame_id;
+  while (page_table_.Find(page_id, &frame_id)) {
+    if (frames_[frame_id].pin_count_.load(std::memory_order_relaxed) == 0 && DetachFrame(frame_id)) {
+      replacer_->Remove(frame_id);
+      if (RetireFrame(frame_id)) {
+        ResetFrame(frame_id, INVALID_PAGE_ID);
+        free_list_.push_back(frame_id);
+      }
+      return;
+    }
+    lock->unlock();
+    std::this_thread::yield();
+    lock->lock();
+  }
+}
+
+auto BufferPoolManagerInstance::ReclaimRetiredFrame(frame_id_t *frame_id) -> bool {
+  if (retired_frames_.empty()) {
+    return false;
+  }
+  const uint64_t oldest_epoch = epochs_.GetOldestActiveEpoch();
+  auto it = std::find_if(retired_frames_.begin(), retired_frames_.end(),
+                         [oldest_epoch](const auto &retired) { return retired.second < oldest_epoch; });
+  if (it == retired_frames_.end()) {
+    return false;
+  }
+  *frame_id = it->first;
+  *it = retired_frames_.back();
+  retired_frames_.pop_back();
+  return true;
+}
+
+void BufferPoolManagerInstance::WritePageToDisk(frame_id_t frame_id) {
+  const page_id_t page_id = frames_[frame_id].page_id_.load(std::memory_order_relaxed);
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  CopyForWriteBack(frame_id, page_id, data.data());
+  disk_manager_->WritePage(page_id, data.data());
+}
+
+void BufferPoolManagerInstance::PinForWriteBack(frame_id_t frame_id) {
+  frames_[frame_id].pin_count_.fetch_add(1, std::memory_order_relaxed);
+  replacer_->SetEvictable(frame_id, false);
+  pages_[frame_id].IncPin();
+}
+
+/**
+ * The checksum is computed over the copy: a writer may change the frame as soon as the read latch is gone, and a
+ * stamp in the frame itself would then no longer match what we write.
+ */
+void BufferPoolManagerInstance::CopyForWriteBack(frame_id_t frame_id, page_id_t page_id, char *data) {
+  // Clear the dirty flag before copying, so that a change made after the copy marks the page dirty again.
+  frames_[frame_id].is_dirty_.store(false, std::memory_order_relaxed);
+  pages_[frame_id].SetDirty(false);
+  pages_[frame_id].RLatch();
+  memcpy(data, pages_[frame_id].GetData(), BUSTUB_PAGE_SIZE);
+  pages_[frame_id].RUnlatch();
+  PageChecksum::Stamp(page_id, data);
+}
+
+void BufferPoolManagerInstance::PinFrame(frame_id_t frame_id, AccessType access_type) {
+  frames_[frame_id].prefetched_.store(false, std::memory_order_relaxed);
+  replacer_->RecordAccess(frame_id, access_type, frames_[frame_id].page_id_.load(std::memory_order_relaxed));
+  // The release pairs with the acquire in TryPinFrame: a lock-free reader that pins the frame also sees its contents.
+  if (frames_[frame_id].pin_count_.fetch_add(1, std::memory_order_release) == 0) {
+    replacer_->SetEvictable(frame_id, false);
+  }
+  pages_[frame_id].IncPin();
+}
+
+auto BufferPoolManagerInstance::TryPinFrame(frame_id_t frame_id) -> bool {
+  auto &pin_count = frames_[frame_id].pin_count_;
+  int pins = pin_count.load(std::memory_order_relaxed);
+  while (pins > 0) {
+    if (pin_count.compare_exchange_weak(pins, pins + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+      pages_[frame_id].IncPin();
+      return true;
+    }
+  }
+  return false;
+}
+
+auto BufferPoolManagerInstance::TryUnpinFrame(frame_id_t frame_id) -> bool {
+  auto &pin_count = frames_[frame_id].pin_count_;
+  int pins = pin_count.load(std::memory_order_relaxed);
+  while (pins > 1) {
+    if (pin_count.compare_exchange_weak(pins, pins - 1, std::memory_order_release, std::memory_order_relaxed)) {
+      pages_[frame_id].DecPin();
+      return true;
+    }
+  }
+  return false;
+}
+
+auto BufferPoolManagerInstance::UnpinFrame(frame_id_t frame_id) -> bool {
+  auto &pin_count = frames_[frame_id].pin_count_;
+  int pins = pin_count.load(std::memory_order_relaxed);
+  while (pins > 0) {
+    if (pin_count.compare_exchange_weak(pins, pins - 1, std::memory_order_release, std::memory_order_relaxed)) {
+      if (pins == 1) {
+        replacer_->SetEvictable(frame_id, true);
+      }
+      pages_[frame_id].DecPin();
+      return true;
+    }
+  }
+  return false;
+}
+
+void BufferPoolManagerInstance::ResetFrame(frame_id_t frame_id, page_id_t page_id) {
+  FrameHeader &frame = frames_[frame_id];
+  frame.pin_count_.store(0, std::memory_order_relaxed);
+  frame.is_dirty_.store(false, std::memory_order_relaxed);
+  frame.lsn_.store(INVALID_LSN, std::memory_order_relaxed);
+  frame.prefetched_.store(false, std::memory_order_relaxed);
+  frame.referenced_.store(false, std::memory_order_relaxed);
+  frame.page_id_.store(page_id, std::memory_order_relaxed);
+  pages_[frame_id].Reset();
+  pages_[frame_id].SetPageId(page_id);
+}
+
+auto BufferPoolManagerInstance::NewPage(page_id_t *page_id, page_id_t hint, BufferRing *ring) -> Page * {
+  CheckWritable();
+  auto lock = AcquireLatch();
+  frame_id_t frame_id;
+  BufferRing::Slot *ring_slot = nullptr;
+  for (int round = 0;; round++) {
+    if (ring != nullptr) {
+      ring_slot = GetRingFrameId(ring, &frame_id);
+    } else {
+      GetReplaceFrameId(&frame_id);
+    }
+    if (frame_id != -1) {
+      break;
+    }
+    if (!WaitForRetiredFrames(&lock, round)) {
+      num_all_pinned_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+  }
+  *page_id = AllocatePage(hint);
+  DropStaleFrame(&lock, *page_id);
+  if (compressed_cache_ != nullptr) {
+    // a deallocated page id may come back, and its old contents must not
+    compressed_cache_->Erase(*page_id);
+  }
+  if (ring_slot != nullptr) {
+    ring_slot->page_id_ = *page_id;
+  }
+  ResetFrame(frame_id, *page_id);
+  // the id may have belonged to a deleted page, whose contents are still on disk
+  frames_[frame_id].is_dirty_.store(true, std::memory_order_relaxed);
+  PinFrame(frame_id, AccessType::Unknown);
+  page_table_.Insert(*page_id, frame_id);
+  return &pages_[frame_id];
+}
+
+auto BufferPoolManagerInstance::FetchPage(page_id_t page_id, AccessType access_type, BufferRing *ring) -> Page * {
+  heat_map_.RecordAccess(page_id);
+  /*
+   * Fast path: a page that is resident and already pinned by someone else cannot be evicted, so it can be pinned
+   * again without the latch. The frame is re-checked after pinning because it may have been reused for another page
+   * between the lookup and the pin. The replacer is not told about these accesses: they fall within the period in
+   * which the frame is already pinned, which LRU-K and 2Q treat as correlated references of a single access.
+   */
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id) && TryPinFrame(frame_id)) {
+    if (frames_[frame_id].page_id_.load(std::memory_order_relaxed) == page_id) {
+      num_hits_.Add();
+      return &pages_[frame_id];
+    }
+    if (!TryUnpinFrame(frame_id)) {
+      auto lock = AcquireLatch();
+      UnpinFrame(frame_id);
+    }
+  }
+
+  auto lock = AcquireLatch();
+  BufferRing::Slot *ring_slot = nullptr;
+  for (int round = 0;; round++) {
+    if (page_table_.Find(page_id, &frame_id)) {
+      /* Found page_id in page table hence in buffer pool. */
+      num_hits_.Add();
+      PinFrame(frame_id, access_type);
+      return &pages_[frame_id];
+    }
+    /* Replace a page with the page from disk. */
+    if (ring != nullptr) {
+      ring_slot = GetRingFrameId(ring, &frame_id);
+    } else {
+      GetReplaceFrameId(&frame_id);
+    }
+    if (frame_id != -1) {
+      break;
+    }
+    if (!WaitForRetiredFrames(&lock, round)) {
+      num_all_pinned_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+  }
+  if (ring_slot != nullptr) {
+    ring_slot->page_id_ = page_id;
+  }
+  num_misses_.Add();
+  ResetFrame(frame_id, page_id);
+  if (!ReadPageIntoFrame(frame_id, page_id)) {
+    // leave nothing of the page behind, so that the next fetch reads it again
+    ResetFrame(frame_id, INVALID_PAGE_ID);
+    free_list_.push_back(frame_id);
+    throw Exception(ExceptionType::CORRUPTION, fmt::format("page {} failed its checksum", page_id));
+  }
+  frames_[frame_id].lsn_.store(pages_[frame_id].GetLSN(), std::memory_order_relaxed);
+  PinFrame(frame_id, access_type);
+  page_table_.Insert(page_id, frame_id);
+  return &pages_[frame_id];
+}
+
+auto BufferPoolManagerInstance::ReadPageIntoFrame(frame_id_t frame_id, page_id_t page_id) -> bool {
+  if (compressed_cache_ != nullptr && compressed_cache_->Take(page_id, pages_[frame_id].GetData())) {
+    return true;
+  }
+  disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+  return VerifyPage(page_id, pages_[frame_id].GetData());
+}
+
+auto BufferPoolManagerInstance::VerifyPage(page_id_t page_id, const char *page_data) -> bool {
+  if (!verify_checksums_.load(std::memory_order_relaxed) || PageChecksum::Verify(page_id, page_data)) {
+    return true;
+  }
+  num_checksum_failures_.fetch_add(1, std::memory_order_relaxed);
+  LOG_WARN("page %d failed its checksum", page_id);
+  return false;
+}
+
+auto BufferPoolManagerInstance::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type)
+    -> bool {
+  /* A caller that holds a pin keeps the frame on its page, so only the last unpin needs the latch. */
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id) && frames_[frame_id].page_id_.load(std::memory_order_relaxed) == page_id) {
+    MarkDirty(frame_id, is_dirty);
+    if (TryUnpinFrame(frame_id)) {
+      return true;
+    }
+  }
+  /* The lock-free lookup can miss, so only trust a miss under the latch. */
+  auto lock = AcquireLatch();
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return false;
+  }
+  MarkDirty(frame_id, is_dirty);
+  return UnpinFrame(frame_id);
+}
+
+void BufferPoolManagerInstance::MarkDirty(frame_id_t frame_id, bool is_dirty) {
+  if (is_dirty && frames_[frame_id].pin_count_.load(std::memory_order_relaxed) > 0) {
+    frames_[frame_id].lsn_.store(pages_[frame_id].GetLSN(), std::memory_order_relaxed);
+    frames_[frame_id].is_dirty_.store(true, std::memory_order_relaxed);
+    pages_[frame_id].SetDirty(true);
+  }
+}
+
+/**
+ * The page is copied under its read latch, which a writer may hold while it waits for our latch, so the copy is made
+ * without our latch; the pin keeps the page in its frame meanwhile.
+ */
+auto BufferPoolManagerInstance::FlushPage(page_id_t page_id) -> bool {
+  frame_id_t frame_id;
+  {
+    auto lock = AcquireLatch();
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+    PinForWriteBack(frame_id);
+  }
+  WritePageToDisk(frame_id);
+  auto lock = AcquireLatch();
+  UnpinFrame(frame_id);
+  return true;
+}
+
+/**
+ * Pages are pinned and copied a batch at a time, like in FlushPage, so that a large pool is neither copied at once nor
+ * kept pinned all the while. A page that left its frame since we listed it was written back on eviction if dirty.
+ */
+void BufferPoolManagerInstance::FlushAllPages() {
+  std::vector<std::pair<page_id_t, frame_id_t>> resident;
+  {
+    auto lock = AcquireLatch();
+    for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
+      page_id_t page_id = frames_[frame_id].page_id_.load(std::memory_order_relaxed);
+      if (page_id != INVALID_PAGE_ID) {
+        resident.emplace_back(page_id, static_cast<frame_id_t>(frame_id));
+      }
+    }
+  }
+  // In page id order, so that the disk manager can coalesce pages with adjacent ids.
+  std::sort(resident.begin(), resident.end());
+  std::vector<char> data(BG_WRITER_BATCH_SIZE * BUSTUB_PAGE_SIZE);
+  for (size_t begin = 0; begin < resident.size(); begin += BG_WRITER_BATCH_SIZE) {
+    const size_t end = std::min<size_t>(begin + BG_WRITER_BATCH_SIZE, resident.size());
+    std::vector<std::pair<page_id_t, frame_id_t>> batch;
+    {
+      auto lock = AcquireLatch();
+      for (size_t i = begin; i < end; i++) {
+        auto [page_id, frame_id] = resident[i];
+        if (frames_[frame_id].page_id_.load(std::memory_order_relaxed) == page_id) {
+          PinForWriteBack(frame_id);
+          batch.emplace_back(page_id, frame_id);
+        }
+      }
+    }
+    std::vector<std::pair<page_id_t, const char *>> pages;
+    for (size_t i = 0; i < batch.size(); i++) {
+      auto [page_id, frame_id] = batch[i];
+      CopyForWriteBack(frame_id, page_id, &data[i * BUSTUB_PAGE_SIZE]);
+      pages.emplace_back(page_id, &data[i * BUSTUB_PAGE_SIZE]);
+    }
+    disk_manager_->WritePages(pages);
+    auto lock = AcquireLatch();
+    for (const auto &[page_id, frame_id] : batch) {
+      UnpinFrame(frame_id);
+    }
+  }
+  disk_manager_->FlushFreeSpaceMap();
+}
+
+auto BufferPoolManagerInstance::DeletePage(page_id_t page_id) -> bool {
+  CheckWritable();
+  auto lock = AcquireLatch();
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);
+  }
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    DeallocatePage(page_id);
+    return true;
+  }
+  if (frames_[frame_id].pin_count_.load(std::memory_order_relaxed) > 0 || !DetachFrame(frame_id)) {
+    return false;
+  }
+  replacer_->Remove(frame_id);
+  if (RetireFrame(frame_id)) {
+    ResetFrame(frame_id, INVALID_PAGE_ID);
+    free_list_.push_back(frame_id);
+  }
+  DeallocatePage(page_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::StartBackgroundWriter(size_t clean_target) {
+  if (enable_bg_writer_.exchange(true)) {
+    return;
+  }
+  bg_writer_clean_target_ = std::min(clean_target, pool_size_);
+  bg_writer_thread_ = std::thread(&BufferPoolManagerInstance::RunBackgroundWriter, this);
+}
+
+void BufferPoolManagerInstance::StopBackgroundWriter() {
+  if (!enable_bg_writer_.exchange(false)) {
+    return;
+  }
+  {
+    std::scoped_lock lock{bg_writer_latch_};
+    bg_writer_cv_.notify_one();
+  }
+  bg_writer_thread_.join();
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriter() {
+  bool forced = false;
+  while (enable_bg_writer_.load(std::memory_order_relaxed)) {
+    if (WriteBackDirtyFrames(forced) > 0) {
+      forced = false;
+      continue;
+    }
+    std::unique_lock lock{bg_writer_latch_};
+    bg_writer_cv_.wait_for(lock, bg_writer_interval,
+                           [this] { return bg_writer_wakeup_ || !enable_bg_writer_.load(std::memory_order_relaxed); });
+    forced = std::exchange(bg_writer_wakeup_, false);
+  }
+}
+
+auto BufferPoolManagerInstance::WriteBackDirtyFrames(bool forced) -> size_t {
+  /*
+   * Count the frames that can be reused without a write without the latch. The count may be stale by the time we act
+   * on it, which only makes the writer a little early or late.
+   */
+  size_t clean = 0;
+  for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
+    const FrameHeader &frame = frames_[frame_id];
+    if (frame.page_id_.load(std::memory_order_relaxed) == INVALID_PAGE_ID ||
+        (frame.pin_count_.load(std::memory_order_relaxed) == 0 && !frame.is_dirty_.load(std::memory_order_relaxed))) {
+      clean++;
+    }
+  }
+  if (clean >= bg_writer_clean_target_ && !forced) {
+    return 0;
+  }
+  // The replacer picked a dirty victim even though enough frames were clean, so clean a full batch.
+  const size_t wanted =
+      clean >= bg_writer_clean_target_ ? BG_WRITER_BATCH_SIZE
+                                       : std::min<size_t>(bg_writer_clean_target_ - clean, BG_WRITER_BATCH_SIZE);
+
+  std::vector<std::pair<page_id_t, frame_id_t>> batch;
+  {
+    auto lock = AcquireLatch();
+    for (size_t i = 0; i < pool_size_ && batch.size() < wanted; i++) {
+      auto frame_id = static_cast<frame_id_t>((bg_writer_cursor_ + i) % pool_size_);
+      FrameHeader &frame = frames_[frame_id];
+      page_id_t page_id = frame.page_id_.load(std::memory_order_relaxed);
+      if (page_id == INVALID_PAGE_ID || frame.pin_count_.load(std::memory_order_relaxed) != 0 ||
+          !frame.is_dirty_.load(std::memory_order_relaxed)) {
+        continue;
+      }
+      PinForWriteBack(frame_id);
+      batch.emplace_back(page_id, frame_id);
+    }
+  }
+  if (batch.empty()) {
+    return 0;
+  }
+  bg_writer_cursor_ = (static_cast<size_t>(batch.back().second) + 1) % pool_size_;
+
+  // Writing in page id order turns runs of neighbouring dirty pages into sequential disk writes.
+  std::sort(batch.begin(), batch.end());
+  std::vector<char> data(batch.size() * BUSTUB_PAGE_SIZE);
+  std::mutex done_latch;
+  std::condition_variable done_cv;
+  size_t pending = batch.size();
+  for (size_t i = 0; i < batch.size(); i++) {
+    auto [page_id, frame_id] = batch[i];
+    CopyForWriteBack(frame_id, page_id, &data[i * BUSTUB_PAGE_SIZE]);
+    // Submit the whole batch before waiting, so that a disk manager with asynchronous I/O overlaps the writes.
+    disk_manager_->WritePageAsync(page_id, &data[i * BUSTUB_PAGE_SIZE], [&done_latch, &done_cv, &pending](bool) {
+      std::scoped_lock lock{done_latch};
+      if (--pending == 0) {
+        done_cv.notify_one();
+      }
+    });
+  }
+  {
+    std::unique_lock lock{done_latch};
+    done_cv.wait(lock, [&pending] { return pending == 0; });
+  }
+  num_bg_writes_.fetch_add(batch.size(), std::memory_order_relaxed);
+
+  auto lock = AcquireLatch();
+  for (const auto &[page_id, frame_id] : batch) {
+    UnpinFrame(frame_id);
+  }
+  return batch.size();
+}
+
+void BufferPoolManagerInstance::Prefetch(const std::vector<page_id_t> &page_ids) {
+  std::scoped_lock lock{prefetch_latch_};
+  if (stop_prefetch_) {
+    return;
+  }
+  for (auto page_id : page_ids) {
+    if (prefetch_queue_.size() >= pool_size_) {
+      break;
+    }
+    if (page_id != INVALID_PAGE_ID) {
+      prefetch_queue_.push_back(page_id);
+    }
+  }
+  if (!prefetch_thread_.joinable()) {
+    prefetch_thread_ = std::thread(&BufferPoolManagerInstance::RunPrefetcher, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::RunPrefetcher() {
+  std::vector<page_id_t> page_ids;
+  while (true) {
+    {
+      std::unique_lock lock{prefetch_latch_};
+      prefetch_cv_.wait(lock, [this] { return stop_prefetch_ || !prefetch_queue_.empty(); });
+      if (stop_prefetch_) {
+        return;
+      }
+      page_ids.assign(prefetch_queue_.begin(), prefetch_queue_.end());
+      prefetch_queue_.clear();
+    }
+    PrefetchPages(page_ids);
+  }
+}
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  auto lock = AcquireLatch();
+  std::vector<std::pair<page_id_t, char *>> reads;
+  std::vector<page_id_t> loaded_page_ids;
+  std::vector<frame_id_t> frame_ids;
+  std::vector<bool> from_disk;
+  for (auto page_id : page_ids) {
+    frame_id_t frame_id;
+    if (page_table_.Find(page_id, &frame_id) ||
+        std::find(loaded_page_ids.begin(), loaded_page_ids.end(), page_id) != loaded_page_ids.end()) {
+      continue;
+    }
+    GetReplaceFrameId(&frame_id, true);
+    if (frame_id == -1) {
+      break;
+    }
+    ResetFrame(frame_id, page_id);
+    const bool cached = compressed_cache_ != nullptr && compressed_cache_->Take(page_id, pages_[frame_id].GetData());
+    if (!cached) {
+      reads.emplace_back(page_id, pages_[frame_id].GetData());
+    }
+    loaded_page_ids.push_back(page_id);
+    frame_ids.push_back(frame_id);
+    from_disk.push_back(!cached);
+  }
+  // One call for the whole batch lets the disk manager coalesce pages with adjacent ids.
+  disk_manager_->ReadPages(reads);
+  for (size_t i = 0; i < frame_ids.size(); i++) {
+    frame_id_t frame_id = frame_ids[i];
+    if (from_disk[i] && !VerifyPage(loaded_page_ids[i], pages_[frame_id].GetData())) {
+      // drop the page; a fetch will read it again and report it
+      ResetFrame(frame_id, INVALID_PAGE_ID);
+      free_list_.push_back(frame_id);
+      continue;
+    }
+    num_prefetches_.fetch_add(1, std::memory_order_relaxed);
+    frames_[frame_id].lsn_.store(pages_[frame_id].GetLSN(), std::memory_order_relaxed);
+    // Pinning and unpinning at once records the scan access and leaves the frame evictable.
+    PinFrame(frame_id, AccessType::Scan);
+    UnpinFrame(frame_id);
+    frames_[frame_id].prefetched_.store(true, std::memory_order_relaxed);
+    page_table_.Insert(loaded_page_ids[i], frame_id);
+  }
+}
+
+auto BufferPoolManagerInstance::AllocatePage(page_id_t hint) -> page_id_t {
+  const page_id_t page_id = disk_manager_->AllocatePage(hint, num_instances_, instance_index_);
+  BUSTUB_ASSERT(page_id % static_cast<page_id_t>(num_instances_) == static_cast<page_id_t>(instance_index_),
+                "allocated pages must mod back to this BPI");
+  return page_id;
+}
+
+auto BufferPoolManagerInstance::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  stats.pool_size_ = pool_size_;
+  stats.hits_ = num_hits_.Load();
+  stats.misses_ = num_misses_.Load();
+  stats.evictions_ = num_evictions_.load(std::memory_order_relaxed);
+  stats.dirty_write_backs_ = num_fg_writes_.load(std::memory_order_relaxed);
+  stats.background_writes_ = num_bg_writes_.load(std::memory_order_relaxed);
+  stats.all_pinned_ = num_all_pinned_.load(std::memory_order_relaxed);
+  stats.latch_waits_ = num_latch_waits_.load(std::memory_order_relaxed);
+  stats.prefetches_ = num_prefetches_.load(std::memory_order_relaxed);
+  stats.mapped_reads_ = num_mapped_reads_.load(std::memory_order_relaxed);
+  stats.checksum_failures_ = num_checksum_failures_.load(std::memory_order_relaxed);
+  auto lock = AcquireLatch();
+  if (compressed_cache_ != nullptr) {
+    stats.compressed_cache_capacity_ = compressed_cache_->GetCapacity();
+    stats.compressed_cache_size_ = compressed_cache_->GetSize();
+    stats.compressed_cache_pages_ = compressed_cache_->GetPageCount();
+    stats.compressed_cache_hits_ = compressed_cache_->GetHitCount();
+    stats.compressed_cache_misses_ = compressed_cache_->GetMissCount();
+  }
+  return stats;
+}
+
+void BufferPoolManagerInstance::SetVerifyChecksums(bool verify) {
+  verify_checksums_.store(verify, std::memory_order_relaxed);
+}
+
+void BufferPoolManagerInstance::SetCompressedCacheCapacity(size_t capacity) {
+  auto lock = AcquireLatch();
+  compressed_cache_ = capacity == 0 ? nullptr : std::make_unique<CompressedPageCache>(capacity);
+}
+
+void BufferPoolManagerInstance::SetHeatMapSampleInterval(size_t sample_interval) {
+  heat_map_.SetSampleInterval(sample_interval);
+}
+
+auto BufferPoolManagerInstance::GetHottestPages(size_t n) -> std::vector<std::pair<page_id_t, size_t>> {
+  return heat_map_.GetHottest(n);
+}
+
+/**
+ * Only a read-only disk manager maps pages, so the mapping and the frames hold the same version of every page, and the
+ * lock-free lookup may miss a page that was just fetched: that only costs the frame its hit.
+ */
+auto BufferPoolManagerInstance::FetchPageMapped(page_id_t page_id) -> ReadPageGuard {
+  const char *data = disk_manager_->PinMappedPage(page_id);
+  if (data == nullptr) {
+    return {};
+  }
+  frame_id_t frame_id;
+  const bool resident = page_table_.Find(page_id, &frame_id);
+  if (resident || (verify_checksums_.load(std::memory_order_relaxed) && !PageChecksum::Verify(page_id, data))) {
+    // a corrupted page goes the way of every other read, which reports it
+    disk_manager_->UnpinMappedPage(page_id);
+    return {};
+  }
+  num_mapped_reads_.fetch_add(1, std::memory_order_relaxed);
+  heat_map_.RecordAccess(page_id);
+  return {disk_manager_, page_id, data};
+}
+
+/**
+ * The epoch only covers the lookup: once the version is recorded, an eviction bumps it, so the frame may be reused
+ * under the guard. It cannot be reused before that, so the version we record belongs to the page we looked up.
+ */
+auto BufferPoolManagerInstance::FetchPageOptimistic(page_id_t page_id) -> OptimisticReadGuard {
+  if (ReadPageGuard mapped = FetchPageMapped(page_id); mapped.IsMapped()) {
+    return OptimisticReadGuard(std::move(mapped));
+  }
+  const size_t epoch_slot = epochs_.Enter();
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) {
+    // the version before the page id: DetachFrame clears the page id before it bumps the version
+    const uint64_t version = pages_[frame_id].GetVersion();
+    if ((version & 1) == 0 && frames_[frame_id].page_id_.load(std::memory_order_seq_cst) == page_id) {
+      epochs_.Exit(epoch_slot);
+      RecordPinFreeHit(frame_id, page_id);
+      return {&pages_[frame_id], version};
+    }
+  }
+  epochs_.Exit(epoch_slot);
+  /* Not resident, being evicted or being written: fetch the page and hold a pin until we have an even version. */
+  Page *page = FetchPage(page_id);
+  if (page == nullptr) {
+    return {};
+  }
+  uint64_t version;
+  while (((version = page->GetVersion()) & 1) != 0) {
+    std::this_thread::yield();
+  }
+  UnpinPage(page_id, false);
+  return {page, version};
+}
+
+/**
+ * The epoch only covers the lookup and the latch: once we hold the latch, DetachFrame leaves the frame alone. Before
+ * that, the frame may be detached but not reused, so the latch we try is never the latch of another page.
+ */
+auto BufferPoolManagerInstance::FetchPageEpoch(page_id_t page_id) -> EpochReadGuard {
+  const size_t epoch_slot = epochs_.Enter();
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id) && pages_[frame_id].TryRLatch()) {
+    // pairs with DetachFrame: either it sees our latch, or we see the frame go
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (frames_[frame_id].page_id_.load(std::memory_order_relaxed) == page_id) {
+      epochs_.Exit(epoch_slot);
+      RecordPinFreeHit(frame_id, page_id);
+      return EpochReadGuard(&pages_[frame_id]);
+    }
+    pages_[frame_id].RUnlatch();
+  }
+  epochs_.Exit(epoch_slot);
+  /* Not resident, being evicted or being written: fetch the page, and drop the pin once the latch holds the frame. */
+  Page *page = FetchPage(page_id);
+  if (page == nullptr) {
+    return {};
+  }
+  page->RLatch();
+  UnpinPage(page_id, false);
+  return EpochReadGuard(page);
+}
+
+void BufferPoolManagerInstance::RecordPinFreeHit(frame_id_t frame_id, page_id_t page_id) {
+  // only write the flag when it changes, so that readers of a hot page keep its cache line shared
+  if (!frames_[frame_id].referenced_.load(std::memory_order_relaxed)) {
+    frames_[frame_id].referenced_.store(true, std::memory_order_relaxed);
+  }
+  num_hits_.Add();
+  heat_map_.RecordAccess(page_id);
+}
+
+}  // namespace bustub
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <algorithm>
+
+#include "fmt/format.h"
+
+namespace bustub {
+
+auto BufferPoolStats::operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+  pool_size_ += other.pool_size_;
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  evictions_ += other.evictions_;
+  dirty_write_backs_ += other.dirty_write_backs_;
+  background_writes_ += other.background_writes_;
+  all_pinned_ += other.all_pinned_;
+  latch_waits_ += other.latch_waits_;
+  prefetches_ += other.prefetches_;
+  mapped_reads_ += other.mapped_reads_;
+  checksum_failures_ += other.checksum_failures_;
+  compressed_cache_capacity_ += other.compressed_cache_capacity_;
+  compressed_cache_size_ += other.compressed_cache_size_;
+  compressed_cache_pages_ += other.compressed_cache_pages_;
+  compressed_cache_hits_ += other.compressed_cache_hits_;
+  compressed_cache_misses_ += other.compressed_cache_misses_;
+  return *this;
+}
+
+auto BufferPoolStats::GetHitRate() const -> double {
+  const size_t total = hits_ + misses_;
+  return total == 0 ? 0.0 : static_cast<double>(hits_) / static_cast<double>(total);
+}
+
+auto BufferPoolStats::GetCompressedCacheHitRate() const -> double {
+  const size_t total = compressed_cache_hits_ + compressed_cache_misses_;
+  return total == 0 ? 0.0 : static_cast<double>(compressed_cache_hits_) / static_cast<double>(total);
+}
+
+auto BufferPoolStats::ToPairs() const -> std::vector<std::pair<std::string, std::string>> {
+  return {{"pool_size", fmt::format("{}", pool_size_)},
+          {"hits", fmt::format("{}", hits_)},
+          {"misses", fmt::format("{}", misses_)},
+          {"hit_rate", fmt::format("{:.4f}", GetHitRate())},
+          {"evictions", fmt::format("{}", evictions_)},
+          {"dirty_write_backs", fmt::format("{}", dirty_write_backs_)},
+          {"background_writes", fmt::format("{}", background_writes_)},
+          {"all_pinned", fmt::format("{}", all_pinned_)},
+          {"latch_waits", fmt::format("{}", latch_waits_)},
+          {"prefetches", fmt::format("{}", prefetches_)},
+          {"mapped_reads", fmt::format("{}", mapped_reads_)},
+          {"checksum_failures", fmt::format("{}", checksum_failures_)},
+          {"compressed_cache_capacity", fmt::format("{}", compressed_cache_capacity_)},
+          {"compressed_cache_size", fmt::format("{}", compressed_cache_size_)},
+          {"compressed_cache_pages", fmt::format("{}", compressed_cache_pages_)},
+          {"compressed_cache_hits", fmt::format("{}", compressed_cache_hits_)},
+          {"compressed_cache_misses", fmt::format("{}", compressed_cache_misses_)},
+          {"compressed_cache_hit_rate", fmt::format("{:.4f}", GetCompressedCacheHitRate())}};
+}
+
+auto BufferPoolStats::ToString() const -> std::string {
+  std::string result;
+  for (const auto &[name, value] : ToPairs()) {
+    result += fmt::format("{}={} ", name, value);
+  }
+  if (!result.empty()) {
+    result.pop_back();
+  }
+  return result;
+}
+
+void PageHeatMap::Sample(page_id_t page_id) {
+  std::scoped_lock lock(latch_);
+  samples_[page_id]++;
+}
+
+auto PageHeatMap::GetHottest(size_t n) const -> std::vector<std::pair<page_id_t, size_t>> {
+  std::vector<std::pair<page_id_t, size_t>> hottest;
+  {
+    std::scoped_lock lock(latch_);
+    hottest.assign(samples_.begin(), samples_.end());
+  }
+  n = std::min(n, hottest.size());
+  // ties go to the lower page id, so that the result does not depend on the hash table order
+  std::partial_sort(hottest.begin(), hottest.begin() + n, hottest.end(), [](const auto &a, const auto &b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  hottest.resize(n);
+  return hottest;
+}
+
+void PageHeatMap::Reset() {
+  std::scoped_lock lock(latch_);
+  samples_.clear();
+}
+
+}  // namespace bustub
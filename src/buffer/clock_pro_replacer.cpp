@@ -0,0 +1,250 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.cpp
+//
+// Identification: src/buffer/clock_pro_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/clock_pro_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ClockProReplacer::ClockProReplacer(size_t num_frames)
+    : hand_hot_(clock_.end()),
+      hand_cold_(clock_.end()),
+      hand_test_(clock_.end()),
+      capacity_(num_frames),
+      cold_target_(std::max<size_t>(1, num_frames / 2)) {}
+
+auto ClockProReplacer::Next(Iter it) -> Iter {
+  ++it;
+  return it == clock_.end() ? clock_.begin() : it;
+}
+
+auto ClockProReplacer::InsertAtHead(Entry entry) -> Iter {
+  if (clock_.empty()) {
+    auto it = clock_.insert(clock_.end(), entry);
+    hand_hot_ = hand_cold_ = hand_test_ = it;
+    return it;
+  }
+  return clock_.insert(hand_hot_, entry);
+}
+
+void ClockProReplacer::MoveToHead(Iter it) {
+  if (clock_.size() == 1) {
+    return;
+  }
+  for (auto *hand : {&hand_hot_, &hand_cold_, &hand_test_}) {
+    if (*hand == it) {
+      *hand = Next(it);
+    }
+  }
+  clock_.splice(hand_hot_, clock_, it);
+}
+
+void ClockProReplacer::Erase(Iter it) {
+  if (clock_.size() == 1) {
+    clock_.clear();
+    hand_hot_ = hand_cold_ = hand_test_ = clock_.end();
+    return;
+  }
+  for (auto *hand : {&hand_hot_, &hand_cold_, &hand_test_}) {
+    if (*hand == it) {
+      *hand = Next(it);
+    }
+  }
+  clock_.erase(it);
+}
+
+void ClockProReplacer::RunHandHot() {
+  for (size_t steps = clock_.size(); steps > 0 && !clock_.empty(); steps--) {
+    auto it = hand_hot_;
+    hand_hot_ = Next(it);
+    if (it->frame_id_ == -1) {
+      // HAND_hot passing a non-resident page ends its test period for good.
+      non_resident_.erase(it->key_);
+      Erase(it);
+      cold_target_ = std::max<size_t>(1, cold_target_ - 1);
+    } else if (it->hot_) {
+      if (it->ref_) {
+        it->ref_ = false;
+      } else {
+        it->hot_ = false;
+        num_hot_--;
+        return;
+      }
+    } else if (it->in_test_) {
+      it->in_test_ = false;
+      cold_target_ = std::max<size_t>(1, cold_target_ - 1);
+    }
+  }
+}
+
+void ClockProReplacer::RunHandTest() {
+  for (size_t steps = clock_.size(); steps > 0 && !clock_.empty(); steps--) {
+    auto it = hand_test_;
+    hand_test_ = Next(it);
+    if (it->frame_id_ == -1) {
+      non_resident_.erase(it->key_);
+      Erase(it);
+      cold_target_ = std::max<size_t>(1, cold_target_ - 1);
+      return;
+    }
+    if (!it->hot_ && it->in_test_) {
+      it->in_test_ = false;
+      cold_target_ = std::max<size_t>(1, cold_target_ - 1);
+    }
+  }
+}
+
+void ClockProReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < capacity_, "invalid frame id");
+  std::scoped_lock lock{latch_};
+  if (auto it = resident_.find(frame_id); it != resident_.end()) {
+    if (access_type != AccessType::Scan) {
+      it->second->ref_ = true;
+    }
+    return;
+  }
+
+  page_id_t key = page_id == INVALID_PAGE_ID ? frame_id : page_id;
+  bool reaccessed = false;
+  if (auto ghost = non_resident_.find(key); ghost != non_resident_.end()) {
+    reaccessed = access_type != AccessType::Scan;
+    Erase(ghost->second);
+    non_resident_.erase(ghost);
+  }
+  if (reaccessed) {
+    // The page came back within its test period, so cold pages deserve more space.
+    cold_target_ = std::min(std::max<size_t>(1, capacity_ - 1), cold_target_ + 1);
+    resident_[frame_id] = InsertAtHead(Entry{key, frame_id, true, false, false, false});
+    num_hot_++;
+    while (num_hot_ > HotLimit() && num_hot_ > 0) {
+      size_t before = num_hot_;
+      RunHandHot();
+      if (num_hot_ == before) {
+        break;
+      }
+    }
+    return;
+  }
+  resident_[frame_id] = InsertAtHead(Entry{key, frame_id, false, false, access_type != AccessType::Scan, false});
+}
+
+void ClockProReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock lock{latch_};
+  auto it = resident_.find(frame_id);
+  if (it == resident_.end() || it->second->is_evictable_ == set_evictable) {
+    return;
+  }
+  it->second->is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+auto ClockProReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock{latch_};
+  if (curr_size_ == 0) {
+    return false;
+  }
+
+  // HAND_cold: every referenced cold page is moved to the head once, so two laps find a victim if there is one.
+  for (size_t steps = 2 * clock_.size() + 1; steps > 0; steps--) {
+    auto it = hand_cold_;
+    hand_cold_ = Next(it);
+    if (it->frame_id_ == -1 || it->hot_ || !it->is_evictable_) {
+      continue;
+    }
+    if (it->ref_) {
+      it->ref_ = false;
+      if (it->in_test_) {
+        it->hot_ = true;
+        it->in_test_ = false;
+        num_hot_++;
+        MoveToHead(it);
+        while (num_hot_ > HotLimit() && num_hot_ > 0) {
+          size_t before = num_hot_;
+          RunHandHot();
+          if (num_hot_ == before) {
+            break;
+          }
+        }
+      } else {
+        it->in_test_ = true;
+        MoveToHead(it);
+      }
+      continue;
+    }
+
+    *frame_id = it->frame_id_;
+    resident_.erase(it->frame_id_);
+    curr_size_--;
+    if (it->in_test_) {
+      // Remember the page for the rest of its test period.
+      it->frame_id_ = -1;
+      it->is_evictable_ = false;
+      non_resident_[it->key_] = it;
+      while (non_resident_.size() > capacity_) {
+        RunHandTest();
+      }
+    } else {
+      Erase(it);
+    }
+    return true;
+  }
+
+  // Every evictable frame is hot, which happens when all cold frames are pinned. Evict the first hot one.
+  for (auto it = hand_hot_, end = hand_hot_; !clock_.empty();) {
+    if (it->frame_id_ != -1 && it->is_evictable_) {
+      *frame_id = it->frame_id_;
+      resident_.erase(it->frame_id_);
+      curr_size_--;
+      if (it->hot_) {
+        num_hot_--;
+      }
+      Erase(it);
+      return true;
+    }
+    it = Next(it);
+    if (it == end) {
+      break;
+    }
+  }
+  return false;
+}
+
+void ClockProReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock{latch_};
+  auto it = resident_.find(frame_id);
+  if (it == resident_.end()) {
+    return;
+  }
+  if (!it->second->is_evictable_) {
+    throw Exception("cannot remove a non-evictable frame from the replacer");
+  }
+  if (it->second->hot_) {
+    num_hot_--;
+  }
+  Erase(it->second);
+  resident_.erase(it);
+  curr_size_--;
+}
+
+auto ClockProReplacer::Size() -> size_t {
+  std::scoped_lock lock{latch_};
+  return curr_size_;
+}
+
+}  // namespace bustub
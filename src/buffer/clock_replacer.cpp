@@ -12,108 +12,85 @@
 
 #include "buffer/clock_replacer.h"
 
+#include "common/exception.h"
+#include "common/macros.h"
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {
-    /* Each FrameInfo starts not being in clock. */
-    for (size_t i=0; i < num_pages; i++) 
-        clock_.push_back({false, false, i + 1});
-    head_ = 0;
-    num_pages_ = num_pages;
-    size_ = 0;
-
-
-}
+ClockReplacer::ClockReplacer(size_t num_pages) : clock_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-
-/* Loops through frame in clock until an element that is
-   false is found, or until back to the start. If back to 
-   start, no victim found so false returned. 'i' keeps
-   track of if back to start. */
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { 
-    size_t i = 0;
-    while(i < num_pages_) {
-        if (clock_[head_].in_clock_) {
-            if (clock_[head_].ref_) {
-                clock_[head_].ref_ = false;
-                head_ ++;
-                head_ = head_ % num_pages_;
-                i ++;
-            } else {
-                /* Set frame_id to victim. */
-                *frame_id = clock_[head_].frame_id_;
-                clock_[head_].in_clock_ = false;
-                size_ --;
-                return true;
-            }
-        } else {
-            /* If frame at head_ not in clock, skip forward one. */
-            head_ ++;
-            head_ = head_ % num_pages_;
-        }
-    }
-    return false;
+void ClockReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, [[maybe_unused]] page_id_t page_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < clock_.size(), "invalid frame id");
+  std::scoped_lock lock{latch_};
+  auto &frame = clock_[frame_id];
+  // A scan gives a newly loaded frame no second chance, and does not refresh frames that are already resident.
+  if (!frame.tracked_) {
+    frame.tracked_ = true;
+    frame.ref_ = access_type != AccessType::Scan;
+  } else if (access_type != AccessType::Scan) {
+    frame.ref_ = true;
+  }
 }
 
-void ClockReplacer::Pin(frame_id_t frame_id) {
-
-    int frame_index = GetFrameIndex(frame_id);
-    if (frame_index == -1) {
-        return;
-    }
-
-    if (clock_[frame_index].in_clock_ == false) {
-        return;
-    }
-    clock_[frame_index].in_clock_ = false;
-    size_ --;
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < clock_.size(), "invalid frame id");
+  std::scoped_lock lock{latch_};
+  auto &frame = clock_[frame_id];
+  if (!frame.tracked_ || frame.is_evictable_ == set_evictable) {
+    return;
+  }
+  frame.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    size_++;
+  } else {
+    size_--;
+  }
 }
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {
-    int frame_index = GetFrameIndex(frame_id);
-    if (frame_index == -1) {
-        return;
+/* Sweeps the clock at most twice: the first pass may only clear reference bits. */
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock{latch_};
+  if (size_ == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < 2 * clock_.size() + 1; i++) {
+    auto &frame = clock_[head_];
+    size_t current = head_;
+    head_ = (head_ + 1) % clock_.size();
+    if (!frame.tracked_ || !frame.is_evictable_) {
+      continue;
     }
-    if (clock_[frame_index].in_clock_ == true) {
-        return;
+    if (frame.ref_) {
+      frame.ref_ = false;
+      continue;
     }
-    clock_[frame_index].in_clock_ = true; 
-    clock_[frame_index].ref_ = true;
-    size_t prev_index; 
-    if (head_ == 0) 
-        prev_index = num_pages_ - 1;
-    else 
-        prev_index = head_ - 1;
-    
-    MoveFrameIndex(frame_index, prev_index);
-    size_ ++;
-}
-
-
-auto ClockReplacer::Size() -> size_t {
-    return size_;
+    *frame_id = static_cast<frame_id_t>(current);
+    frame = FrameInfo{};
+    size_--;
+    return true;
+  }
+  return false;
 }
 
-/* Moves the element of clock_ at index 'from_index' to 'to_index'. */
-void ClockReplacer::MoveFrameIndex(size_t from_index, size_t to_index) {
-    FrameInfo element = clock_[from_index];
-    clock_.erase(clock_.begin() + from_index);
-    clock_.insert(clock_.begin() + to_index, element);
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < clock_.size(), "invalid frame id");
+  std::scoped_lock lock{latch_};
+  auto &frame = clock_[frame_id];
+  if (!frame.tracked_) {
+    return;
+  }
+  if (!frame.is_evictable_) {
+    throw Exception("cannot remove a non-evictable frame from the replacer");
+  }
+  frame = FrameInfo{};
+  size_--;
 }
 
-/* Gets the index of frame with frame_id in clock_. */
-int ClockReplacer::GetFrameIndex(frame_id_t frame_id) {
-    for (int i = 0; (size_t)i < clock_.size(); i++) {
-        if ((int)clock_[i].frame_id_ == frame_id) {
-            
-            return i;
-        }
-            
-    }
-    return -1;
+auto ClockReplacer::Size() -> size_t {
+  std::scoped_lock lock{latch_};
+  return size_;
 }
 
-}  // namespace bustub
\ No newline at end of file
+}  // namespace bustub
@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+namespace bustub {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 0xFFFF;
+constexpr int HASH_BITS = 11;
+/** Lengths that do not fit the 4 bits of the token continue in bytes of 255 and a final byte below 255. */
+constexpr size_t LENGTH_MASK = 15;
+
+auto Load32(const char *p) -> uint32_t {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+auto Hash(uint32_t sequence) -> uint32_t { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+void PutLength(size_t length, std::string *out) {
+  for (; length >= 255; length -= 255) {
+    out->push_back(static_cast<char>(255));
+  }
+  out->push_back(static_cast<char>(length));
+}
+
+auto GetLength(const unsigned char **ip, const unsigned char *end, size_t *length) -> bool {
+  unsigned char byte;
+  do {
+    if (*ip == end) {
+      return false;
+    }
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/** Append a sequence: the literals, then a match of match_length bytes at offset, or no match if match_length is 0. */
+void PutSequence(const char *literals, size_t literal_length, size_t offset, size_t match_length, std::string *out) {
+  const size_t match_code = match_length == 0 ? 0 : match_length - MIN_MATCH;
+  out->push_back(static_cast<char>((std::min(literal_length, LENGTH_MASK) << 4) | std::min(match_code, LENGTH_MASK)));
+  if (literal_length >= LENGTH_MASK) {
+    PutLength(literal_length - LENGTH_MASK, out);
+  }
+  out->append(literals, literal_length);
+  if (match_length == 0) {
+    return;
+  }
+  out->push_back(static_cast<char>(offset & 0xFF));
+  out->push_back(static_cast<char>(offset >> 8));
+  if (match_code >= LENGTH_MASK) {
+    PutLength(match_code - LENGTH_MASK, out);
+  }
+}
+
+}  // namespace
+
+/*
+ * Greedy parse with a hash table of the last position of every 4-byte sequence. The last sequence carries the
+ * trailing literals and no match, which tells the decoder where the input ends.
+ */
+auto PageCodec::Compress(const char *src, size_t size, std::string *out, size_t max_size) -> bool {
+  out->clear();
+  std::array<uint32_t, 1 << HASH_BITS> table;
+  table.fill(UINT32_MAX);
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= size) {
+    const uint32_t sequence = Load32(src + pos);
+    uint32_t &candidate = table[Hash(sequence)];
+    const size_t match = candidate;
+    candidate = static_cast<uint32_t>(pos);
+    if (match == UINT32_MAX || pos - match > MAX_OFFSET || Load32(src + match) != sequence) {
+      pos++;
+      continue;
+    }
+    size_t length = MIN_MATCH;
+    while (pos + length < size && src[match + length] == src[pos + length]) {
+      length++;
+    }
+    PutSequence(src + anchor, pos - anchor, pos - match, length, out);
+    if (out->size() >= max_size) {
+      return false;
+    }
+    pos += length;
+    anchor = pos;
+  }
+  PutSequence(src + anchor, size - anchor, 0, 0, out);
+  return out->size() < max_size;
+}
+
+auto PageCodec::Decompress(const char *src, size_t src_size, char *dst, size_t size) -> bool {
+  const auto *ip = reinterpret_cast<const unsigned char *>(src);
+  const auto *end = ip + src_size;
+  size_t op = 0;
+  while (ip < end) {
+    const unsigned char token = *ip++;
+    size_t literal_length = token >> 4;
+    if (literal_length == LENGTH_MASK && !GetLength(&ip, end, &literal_length)) {
+      return false;
+    }
+    if (literal_length > static_cast<size_t>(end - ip) || literal_length > size - op) {
+      return false;
+    }
+    memcpy(dst + op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == end) {
+      break;
+    }
+    if (end - ip < 2) {
+      return false;
+    }
+    const size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    size_t match_length = token & LENGTH_MASK;
+    if (match_length == LENGTH_MASK && !GetLength(&ip, end, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > op || match_length > size - op) {
+      return false;
+    }
+    // byte by byte, since a match may overlap the bytes it produces, e.g. a run of zeros at offset 1
+    for (size_t i = 0; i < match_length; i++, op++) {
+      dst[op] = dst[op - offset];
+    }
+  }
+  return op == size;
+}
+
+auto CompressedPageCache::Insert(page_id_t page_id, const char *data) -> bool {
+  Erase(page_id);
+  std::string compressed;
+  const size_t max_size = std::min<size_t>(BUSTUB_PAGE_SIZE, capacity_ + 1);
+  if (!PageCodec::Compress(data, BUSTUB_PAGE_SIZE, &compressed, max_size)) {
+    return false;
+  }
+  while (size_.load(std::memory_order_relaxed) + compressed.size() > capacity_) {
+    Remove(std::prev(entries_.end()));
+  }
+  size_.fetch_add(compressed.size(), std::memory_order_relaxed);
+  num_pages_.fetch_add(1, std::memory_order_relaxed);
+  entries_.push_front({page_id, std::move(compressed)});
+  index_[page_id] = entries_.begin();
+  return true;
+}
+
+auto CompressedPageCache::Take(page_id_t page_id, char *data) -> bool {
+  auto it = index_.find(page_id);
+  if (it == index_.end()) {
+    num_misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  const std::string &compressed = it->second->data_;
+  const bool decompressed = PageCodec::Decompress(compressed.data(), compressed.size(), data, BUSTUB_PAGE_SIZE);
+  Remove(it->second);
+  if (!decompressed) {
+    num_misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  num_hits_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    Remove(it->second);
+  }
+}
+
+void CompressedPageCache::Remove(std::list<Entry>::iterator it) {
+  size_.fetch_sub(it->data_.size(), std::memory_order_relaxed);
+  num_pages_.fetch_sub(1, std::memory_order_relaxed);
+  index_.erase(it->page_id_);
+  entries_.erase(it);
+}
+
+}  // namespace bustub
@@ -0,0 +1,34 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.cpp
+//
+// Identification: src/buffer/epoch_manager.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/epoch_manager.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+/**
+ * A reader that is not counted here published its epoch after this scan, and so after the epoch was advanced past the
+ * retired frame: its lookups cannot find the frame any more.
+ */
+auto EpochManager::GetOldestActiveEpoch() const -> uint64_t {
+  uint64_t oldest = NO_ACTIVE_EPOCH;
+  for (const auto &slot : slots_) {
+    const uint64_t state = slot.state_.load(std::memory_order_seq_cst);
+    if ((state & READERS_MASK) != 0) {
+      oldest = std::min(oldest, state >> EPOCH_SHIFT);
+    }
+  }
+  return oldest;
+}
+
+}  // namespace bustub
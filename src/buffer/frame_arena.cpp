@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+/**
+ * Parse the online node list of the kernel, e.g. "0-1,4", into node ids
+ */
+static auto GetOnlineNodes() -> std::vector<int> {
+  std::vector<int> nodes;
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string range;
+  while (std::getline(online, range, ',')) {
+    try {
+      auto dash = range.find('-');
+      int first = std::stoi(range.substr(0, dash));
+      int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int node = first; node <= last; node++) {
+        nodes.push_back(node);
+      }
+    } catch (const std::exception &) {
+      break;
+    }
+  }
+  if (nodes.empty()) {
+    nodes.push_back(0);
+  }
+  return nodes;
+}
+
+auto FrameArena::GetNumNodes() -> size_t { return GetOnlineNodes().size(); }
+
+FrameArena::FrameArena(size_t num_frames, const FrameArenaOptions &options, size_t num_instances,
+                       size_t instance_index) {
+  size_ = (num_frames * BUSTUB_PAGE_SIZE + FRAME_ARENA_ALIGNMENT - 1) / FRAME_ARENA_ALIGNMENT * FRAME_ARENA_ALIGNMENT;
+  if (size_ == 0) {
+    return;
+  }
+
+  void *data = MAP_FAILED;
+  if (options.huge_pages_) {
+    // only succeeds if huge pages have been reserved, e.g. with vm.nr_hugepages
+    data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    huge_pages_ = data != MAP_FAILED;
+  }
+  if (data == MAP_FAILED) {
+    // map one extra block and trim it, so that the arena starts on a huge page boundary
+    data = mmap(nullptr, size_ + FRAME_ARENA_ALIGNMENT, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map the frame arena");
+    }
+    auto addr = reinterpret_cast<uintptr_t>(data);
+    auto aligned = (addr + FRAME_ARENA_ALIGNMENT - 1) / FRAME_ARENA_ALIGNMENT * FRAME_ARENA_ALIGNMENT;
+    if (aligned > addr) {
+      munmap(data, aligned - addr);
+    }
+    munmap(reinterpret_cast<void *>(aligned + size_), addr + FRAME_ARENA_ALIGNMENT - aligned);
+    data = reinterpret_cast<void *>(aligned);
+    if (options.huge_pages_) {
+      huge_pages_ = madvise(data, size_, MADV_HUGEPAGE) == 0;
+    }
+  }
+  data_ = static_cast<char *>(data);
+
+  if (!options.numa_aware_) {
+    return;
+  }
+  // nothing is touched yet, so binding now decides where every page is allocated
+  auto nodes = GetOnlineNodes();
+  if (num_instances > 1) {
+    BindToNode(0, size_, nodes[instance_index % nodes.size()]);
+    return;
+  }
+  // partitions are cut on huge page boundaries, since a huge page can only live on one node
+  const size_t num_blocks = size_ / FRAME_ARENA_ALIGNMENT;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    const size_t begin = i * num_blocks / nodes.size() * FRAME_ARENA_ALIGNMENT;
+    const size_t end = (i + 1) * num_blocks / nodes.size() * FRAME_ARENA_ALIGNMENT;
+    if (begin < end) {
+      BindToNode(begin, end, nodes[i]);
+    }
+  }
+}
+
+FrameArena::~FrameArena() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+auto FrameArena::GetNode(frame_id_t frame_id) const -> int {
+  const size_t offset = static_cast<size_t>(frame_id) * BUSTUB_PAGE_SIZE;
+  auto it = std::upper_bound(partition_begin_.begin(), partition_begin_.end(), offset);
+  if (it == partition_begin_.begin()) {
+    return -1;
+  }
+  return partition_node_[it - partition_begin_.begin() - 1];
+}
+
+void FrameArena::BindToNode(size_t begin, size_t end, int node) {
+  partition_begin_.push_back(begin);
+  partition_node_.push_back(node);
+  constexpr size_t mask_bits = sizeof(unsigned long) * 8;  // NOLINT
+  if (static_cast<size_t>(node) >= mask_bits) {
+    return;
+  }
+  unsigned long node_mask = 1UL << node;  // NOLINT
+  // the kernel reads one bit less than maxnode says
+  if (syscall(SYS_mbind, data_ + begin, end - begin, MPOL_PREFERRED, &node_mask, mask_bits + 1, 0) != 0) {
+    LOG_DEBUG("can't bind the frame arena to a NUMA node");
+  }
+}
+
+}  // namespace bustub
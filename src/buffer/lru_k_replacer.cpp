@@ -15,16 +15,84 @@
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {
+  BUSTUB_ASSERT(k > 0, "k must be at least 1");
+}
 
-auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool { return false; }
+auto LRUKReplacer::KeyOf(frame_id_t frame_id, const LRUKNode &node) const -> EvictionKey {
+  int evict_class = 2;
+  if (node.scan_only_) {
+    evict_class = 0;
+  } else if (node.history_.size() < k_) {
+    evict_class = 1;
+  }
+  return {evict_class, node.history_.front(), frame_id};
+}
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {}
+auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock{latch_};
+  if (evictable_.empty()) {
+    return false;
+  }
+  *frame_id = std::get<2>(*evictable_.begin());
+  evictable_.erase(evictable_.begin());
+  node_store_.erase(*frame_id);
+  return true;
+}
 
-void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {}
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, [[maybe_unused]] page_id_t page_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  std::scoped_lock lock{latch_};
+  auto &node = node_store_[frame_id];
+  if (access_type == AccessType::Scan && !node.history_.empty()) {
+    return;
+  }
+  if (node.is_evictable_) {
+    evictable_.erase(KeyOf(frame_id, node));
+  }
+  node.history_.push_back(current_timestamp_++);
+  if (node.history_.size() > k_) {
+    node.history_.pop_front();
+  }
+  if (access_type != AccessType::Scan) {
+    node.scan_only_ = false;
+  }
+  if (node.is_evictable_) {
+    evictable_.insert(KeyOf(frame_id, node));
+  }
+}
 
-void LRUKReplacer::Remove(frame_id_t frame_id) {}
+void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  std::scoped_lock lock{latch_};
+  auto it = node_store_.find(frame_id);
+  if (it == node_store_.end() || it->second.is_evictable_ == set_evictable) {
+    return;
+  }
+  it->second.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    evictable_.insert(KeyOf(frame_id, it->second));
+  } else {
+    evictable_.erase(KeyOf(frame_id, it->second));
+  }
+}
 
-auto LRUKReplacer::Size() -> size_t { return 0; }
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock{latch_};
+  auto it = node_store_.find(frame_id);
+  if (it == node_store_.end()) {
+    return;
+  }
+  if (!it->second.is_evictable_) {
+    throw Exception("cannot remove a non-evictable frame from the replacer");
+  }
+  evictable_.erase(KeyOf(frame_id, it->second));
+  node_store_.erase(it);
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock lock{latch_};
+  return evictable_.size();
+}
 
 }  // namespace bustub
@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) : capacity_(8), hash_shift_(61) {
+  while (capacity_ < num_frames * 2) {
+    capacity_ <<= 1;
+    hash_shift_--;
+  }
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+  for (size_t i = 0; i < capacity_; i++) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::HomeSlot(page_id_t page_id) const -> size_t {
+  // Fibonacci hashing spreads the strided page ids of a parallel buffer pool instance over the whole table.
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                             hash_shift_);
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const -> bool {
+  size_t slot = HomeSlot(page_id);
+  for (size_t probes = 0; probes < capacity_; probes++) {
+    uint64_t entry = slots_[slot].load(std::memory_order_acquire);
+    if (entry == EMPTY_SLOT) {
+      return false;
+    }
+    if (KeyOf(entry) == page_id) {
+      *frame_id = FrameOf(entry);
+      return true;
+    }
+    slot = (slot + 1) & (capacity_ - 1);
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id >= 0, "only valid page ids can be mapped");
+  if (size_ + tombstones_ + 1 > capacity_ * 3 / 4) {
+    Compact();
+  }
+  size_t slot = HomeSlot(page_id);
+  while (true) {
+    uint64_t entry = slots_[slot].load(std::memory_order_relaxed);
+    if (entry == EMPTY_SLOT || KeyOf(entry) == TOMBSTONE_PAGE_ID) {
+      if (entry != EMPTY_SLOT) {
+        tombstones_--;
+      }
+      slots_[slot].store(Pack(page_id, frame_id), std::memory_order_release);
+      size_++;
+      return;
+    }
+    BUSTUB_ASSERT(KeyOf(entry) != page_id, "page is already in the page table");
+    slot = (slot + 1) & (capacity_ - 1);
+  }
+}
+
+auto PageTable::Erase(page_id_t page_id) -> bool {
+  size_t slot = HomeSlot(page_id);
+  for (size_t probes = 0; probes < capacity_; probes++) {
+    uint64_t entry = slots_[slot].load(std::memory_order_relaxed);
+    if (entry == EMPTY_SLOT) {
+      return false;
+    }
+    if (KeyOf(entry) == page_id) {
+      // Leave a tombstone so that lookups of keys further along the probe sequence still find them.
+      slots_[slot].store(Pack(TOMBSTONE_PAGE_ID, FrameOf(entry)), std::memory_order_release);
+      size_--;
+      tombstones_++;
+      return true;
+    }
+    slot = (slot + 1) & (capacity_ - 1);
+  }
+  return false;
+}
+
+void PageTable::Compact() {
+  std::vector<std::pair<page_id_t, frame_id_t>> live;
+  live.reserve(size_);
+  for (size_t i = 0; i < capacity_; i++) {
+    uint64_t entry = slots_[i].load(std::memory_order_relaxed);
+    if (entry != EMPTY_SLOT && KeyOf(entry) != TOMBSTONE_PAGE_ID) {
+      live.emplace_back(KeyOf(entry), FrameOf(entry));
+    }
+    slots_[i].store(EMPTY_SLOT, std::memory_order_release);
+  }
+  size_ = 0;
+  tombstones_ = 0;
+  for (const auto &[page_id, frame_id] : live) {
+    size_t slot = HomeSlot(page_id);
+    while (slots_[slot].load(std::memory_order_relaxed) != EMPTY_SLOT) {
+      slot = (slot + 1) & (capacity_ - 1);
+    }
+    slots_[slot].store(Pack(page_id, frame_id), std::memory_order_release);
+    size_++;
+  }
+}
+
+}  // namespace bustub
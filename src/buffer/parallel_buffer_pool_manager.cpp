@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     const FrameArenaOptions &arena_options) {
+  BUSTUB_ASSERT(num_instances > 0, "a parallel buffer pool needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        pool_size, num_instances, i, disk_manager, replacer_k, log_manager, replacer_policy, arena_options));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
+  size_t pool_size = 0;
+  for (auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::GetPage(frame_id_t frame_id) -> Page * {
+  auto index = static_cast<size_t>(frame_id);
+  for (auto &instance : instances_) {
+    if (index < instance->GetPoolSize()) {
+      return instance->GetPage(static_cast<frame_id_t>(index));
+    }
+    index -= instance->GetPoolSize();
+  }
+  UNREACHABLE("frame id out of range");
+}
+
+auto ParallelBufferPoolManager::Sum(size_t (BufferPoolManagerInstance::*counter)() const) const -> size_t {
+  size_t sum = 0;
+  for (const auto &instance : instances_) {
+    sum += (instance.get()->*counter)();
+  }
+  return sum;
+}
+
+void ParallelBufferPoolManager::StartBackgroundWriter(size_t clean_target) {
+  const size_t per_instance = (clean_target + instances_.size() - 1) / instances_.size();
+  for (auto &instance : instances_) {
+    instance->StartBackgroundWriter(per_instance);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  for (auto &instance : instances_) {
+    instance->StopBackgroundWriter();
+  }
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+void ParallelBufferPoolManager::SetHeatMapSampleInterval(size_t sample_interval) {
+  for (auto &instance : instances_) {
+    instance->SetHeatMapSampleInterval(sample_interval);
+  }
+}
+
+void ParallelBufferPoolManager::SetCompressedCacheCapacity(size_t capacity) {
+  for (auto &instance : instances_) {
+    instance->SetCompressedCacheCapacity(capacity / instances_.size());
+  }
+}
+
+void ParallelBufferPoolManager::SetVerifyChecksums(bool verify) {
+  for (auto &instance : instances_) {
+    instance->SetVerifyChecksums(verify);
+  }
+}
+
+auto ParallelBufferPoolManager::GetHottestPages(size_t n) -> std::vector<std::pair<page_id_t, size_t>> {
+  // every page is sampled by its own instance only, so the n hottest pages are among the n hottest of each instance
+  std::vector<std::pair<page_id_t, size_t>> hottest;
+  for (auto &instance : instances_) {
+    auto instance_hottest = instance->GetHottestPages(n);
+    hottest.insert(hottest.end(), instance_hottest.begin(), instance_hottest.end());
+  }
+  std::sort(hottest.begin(), hottest.end(), [](const auto &a, const auto &b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  if (hottest.size() > n) {
+    hottest.resize(n);
+  }
+  return hottest;
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance * {
+  BUSTUB_ASSERT(page_id >= 0, "invalid page id");
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+auto ParallelBufferPoolManager::NewPage(page_id_t *page_id, page_id_t hint, BufferRing *ring) -> Page * {
+  const size_t num_instances = instances_.size();
+  if (hint != INVALID_PAGE_ID) {
+    Page *page = GetBufferPoolManager(hint)->NewPage(page_id, hint, ring);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  const size_t start = next_instance_.fetch_add(1, std::memory_order_relaxed);
+  for (size_t i = 0; i < num_instances; i++) {
+    Page *page = instances_[(start + i) % num_instances]->NewPage(page_id, hint, ring);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+void ParallelBufferPoolManager::Prefetch(const std::vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      per_instance[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!per_instance[i].empty()) {
+      instances_[i]->Prefetch(per_instance[i]);
+    }
+  }
+}
+
+auto ParallelBufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type, BufferRing *ring) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, access_type, ring);
+}
+
+auto ParallelBufferPoolManager::FetchPageMapped(page_id_t page_id) -> ReadPageGuard {
+  return GetBufferPoolManager(page_id)->FetchPageMapped(page_id);
+}
+
+auto ParallelBufferPoolManager::FetchPageOptimistic(page_id_t page_id) -> OptimisticReadGuard {
+  return GetBufferPoolManager(page_id)->FetchPageOptimistic(page_id);
+}
+
+auto ParallelBufferPoolManager::FetchPageEpoch(page_id_t page_id) -> EpochReadGuard {
+  return GetBufferPoolManager(page_id)->FetchPageEpoch(page_id);
+}
+
+auto ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type) -> bool {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty, access_type);
+}
+
+auto ParallelBufferPoolManager::FlushPage(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPages() {
+  for (auto &instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+auto ParallelBufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+}  // namespace bustub
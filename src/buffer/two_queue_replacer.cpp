@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames)
+    : capacity_(num_frames), kin_(std::max<size_t>(1, num_frames / 4)), kout_(std::max<size_t>(1, num_frames / 2)) {}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < capacity_, "invalid frame id");
+  std::scoped_lock lock{latch_};
+  auto it = frames_.find(frame_id);
+  if (it != frames_.end()) {
+    if (access_type != AccessType::Scan) {
+      it->second.scan_only_ = false;
+      if (it->second.in_am_) {
+        am_.splice(am_.end(), am_, it->second.pos_);
+      }
+    }
+    return;
+  }
+
+  page_id_t key = page_id == INVALID_PAGE_ID ? frame_id : page_id;
+  bool to_am = false;
+  if (auto ghost = ghosts_.find(key); ghost != ghosts_.end()) {
+    to_am = access_type != AccessType::Scan;
+    a1out_.erase(ghost->second);
+    ghosts_.erase(ghost);
+  }
+  auto &queue = to_am ? am_ : a1in_;
+  frames_[frame_id] =
+      FrameInfo{to_am, queue.insert(queue.end(), frame_id), key, access_type == AccessType::Scan, false};
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock lock{latch_};
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end() || it->second.is_evictable_ == set_evictable) {
+    return;
+  }
+  it->second.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+auto TwoQueueReplacer::EvictFrom(bool from_am, frame_id_t *frame_id) -> bool {
+  auto &queue = from_am ? am_ : a1in_;
+  for (auto pos = queue.begin(); pos != queue.end(); ++pos) {
+    auto info = frames_.find(*pos);
+    if (!info->second.is_evictable_) {
+      continue;
+    }
+    *frame_id = *pos;
+    if (!from_am && !info->second.scan_only_) {
+      ghosts_[info->second.key_] = a1out_.insert(a1out_.end(), info->second.key_);
+      if (a1out_.size() > kout_) {
+        ghosts_.erase(a1out_.front());
+        a1out_.pop_front();
+      }
+    }
+    queue.erase(pos);
+    frames_.erase(info);
+    curr_size_--;
+    return true;
+  }
+  return false;
+}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock{latch_};
+  if (curr_size_ == 0) {
+    return false;
+  }
+  if (a1in_.size() > kin_) {
+    return EvictFrom(false, frame_id) || EvictFrom(true, frame_id);
+  }
+  return EvictFrom(true, frame_id) || EvictFrom(false, frame_id);
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock{latch_};
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    return;
+  }
+  if (!it->second.is_evictable_) {
+    throw Exception("cannot remove a non-evictable frame from the replacer");
+  }
+  (it->second.in_am_ ? am_ : a1in_).erase(it->second.pos_);
+  frames_.erase(it);
+  curr_size_--;
+}
+
+auto TwoQueueReplacer::Size() -> size_t {
+  std::scoped_lock lock{latch_};
+  return curr_size_;
+}
+
+}  // namespace bustub
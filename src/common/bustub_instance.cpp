@@ -1,3 +1,4 @@
+#include <cctype>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -11,7 +12,8 @@
 #include "binder/statement/index_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/bustub_instance.h"
@@ -37,11 +39,14 @@
 
 namespace bustub {
 
+/** Number of pages \bpm_stats lists from the heat map. */
+static constexpr size_t BPM_STATS_HOTTEST_PAGES = 10;
+
 auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext> {
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+BustubInstance::BustubInstance(const std::string &db_file_name, size_t bpm_instances, size_t pool_size) {
   enable_logging = false;
 
   // Storage related.
@@ -50,10 +55,17 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // We need more frames for GenerateTestTable to work. Therefore, the default is DEFAULT_INSTANCE_POOL_SIZE instead of
+  // BUFFER_POOL_SIZE. With several instances, each of them gets pool_size frames.
   try {
-    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    if (bpm_instances > 1) {
+      buffer_pool_manager_ =
+          new ParallelBufferPoolManager(bpm_instances, pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    } else {
+      buffer_pool_manager_ = new BufferPoolManagerInstance(pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    }
+    // Keep a quarter of the frames clean so that queries rarely wait for a dirty page to be written back.
+    buffer_pool_manager_->StartBackgroundWriter(buffer_pool_manager_->GetPoolSize() / 4);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -73,7 +85,7 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
 
-BustubInstance::BustubInstance() {
+BustubInstance::BustubInstance(size_t bpm_instances, size_t pool_size) {
   enable_logging = false;
 
   // Storage related.
@@ -82,10 +94,17 @@ BustubInstance::BustubInstance() {
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // We need more frames for GenerateTestTable to work. Therefore, the default is DEFAULT_INSTANCE_POOL_SIZE instead of
+  // BUFFER_POOL_SIZE. With several instances, each of them gets pool_size frames.
   try {
-    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    if (bpm_instances > 1) {
+      buffer_pool_manager_ =
+          new ParallelBufferPoolManager(bpm_instances, pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    } else {
+      buffer_pool_manager_ = new BufferPoolManagerInstance(pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    }
+    // Keep a quarter of the frames clean so that queries rarely wait for a dirty page to be written back.
+    buffer_pool_manager_->StartBackgroundWriter(buffer_pool_manager_->GetPoolSize() / 4);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -146,6 +165,66 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayBufferPoolStats(ResultWriter &writer) {
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("counter");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  for (const auto &[name, value] : buffer_pool_manager_->GetStats().ToPairs()) {
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(value);
+    writer.EndRow();
+  }
+  writer.EndTable();
+
+  auto hottest = buffer_pool_manager_->GetHottestPages(BPM_STATS_HOTTEST_PAGES);
+  if (hottest.empty()) {
+    return;
+  }
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("page_id");
+  writer.WriteHeaderCell("sampled_accesses");
+  writer.EndHeader();
+  for (const auto &[page_id, samples] : hottest) {
+    writer.BeginRow();
+    writer.WriteCell(fmt::format("{}", page_id));
+    writer.WriteCell(fmt::format("{}", samples));
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
+auto BustubInstance::ParsePoolSize(const std::string &arg) -> size_t {
+  size_t pool_size = 0;
+  size_t parsed = 0;
+  try {
+    pool_size = std::stoul(arg, &parsed);
+  } catch (const std::exception &) {
+    parsed = 0;
+  }
+  // stoul accepts a sign and stops at the first non-digit; neither is a valid size
+  if (parsed == 0 || parsed != arg.size() || !std::isdigit(static_cast<unsigned char>(arg[0])) || pool_size == 0) {
+    throw Exception("usage: --pool-size <frames per buffer pool instance, at least 1>");
+  }
+  return pool_size;
+}
+
+void BustubInstance::CmdSetHeatMap(const std::string &sql, ResultWriter &writer) {
+  size_t sample_interval;
+  try {
+    sample_interval = std::stoul(sql.substr(std::string("\\bpm_heatmap").size()));
+  } catch (const std::exception &) {
+    throw Exception("usage: \\bpm_heatmap <sample interval, 0 to turn off>");
+  }
+  buffer_pool_manager_->SetHeatMapSampleInterval(sample_interval);
+  WriteOneCell(sample_interval == 0 ? "Heat map sampling is off"
+                                    : fmt::format("Sampling one in every {} page accesses", sample_interval),
+               writer);
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -159,6 +238,8 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\bpm_stats: show buffer pool counters, and the hottest pages if the heat map is on
+\bpm_heatmap <n>: sample one in every n page accesses into the heat map, 0 to stop
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -197,6 +278,14 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayIndices(writer);
       return true;
     }
+    if (sql == "\\bpm_stats") {
+      CmdDisplayBufferPoolStats(writer);
+      return true;
+    }
+    if (sql.rfind("\\bpm_heatmap", 0) == 0) {
+      CmdSetHeatMap(sql, writer);
+      return true;
+    }
     if (sql == "\\help") {
       CmdDisplayHelp(writer);
       return true;
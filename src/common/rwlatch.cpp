@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// rwlatch.cpp
+//
+// Identification: src/common/rwlatch.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/rwlatch.h"
+
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+
+namespace bustub {
+
+/** How often a waiter re-checks the latch before it parks. */
+static constexpr int LATCH_SPIN_COUNT = 128;
+
+static constexpr int PARKING_LOT_BITS = 6;
+
+/**
+ * Parked threads wait in a bucket of a shared parking lot rather than on the latch itself, which keeps the latch one
+ * word. Latches that hash to the same bucket wake each other's threads now and then; those just park again.
+ */
+struct ParkingBucket {
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+static auto GetParkingBucket(const void *latch) -> ParkingBucket & {
+  static ParkingBucket parking_lot[1 << PARKING_LOT_BITS];
+  const auto hash = reinterpret_cast<uintptr_t>(latch) * 0x9E3779B97F4A7C15ULL;
+  return parking_lot[hash >> (64 - PARKING_LOT_BITS)];
+}
+
+static inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#else
+  std::this_thread::yield();
+#endif
+}
+
+void ReaderWriterLatch::WLockSlow() {
+  RecordWait();
+  // announce the writer first, so that no new reader gets in
+  state_.fetch_add(WAITING_WRITER, std::memory_order_relaxed);
+  for (int spins = 0;; spins++) {
+    uint64_t state = state_.load(std::memory_order_relaxed);
+    if ((state & (WRITER | READERS_MASK)) == 0) {
+      if (state_.compare_exchange_weak(state, (state - WAITING_WRITER) | WRITER, std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+    if (spins < LATCH_SPIN_COUNT) {
+      CpuRelax();
+    } else {
+      Park(state);
+    }
+  }
+}
+
+void ReaderWriterLatch::RLockSlow() {
+  RecordWait();
+  for (int spins = 0;; spins++) {
+    uint64_t state = state_.load(std::memory_order_relaxed);
+    if ((state & (WRITER | WAITING_WRITERS_MASK)) == 0) {
+      if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+    if (spins < LATCH_SPIN_COUNT) {
+      CpuRelax();
+    } else {
+      Park(state);
+    }
+  }
+}
+
+/**
+ * PARKED is set under the bucket mutex, and a release that clears it takes the same mutex before it notifies, so the
+ * wakeup cannot slip in between setting the bit and waiting.
+ */
+auto ReaderWriterLatch::Park(uint64_t state) -> bool {
+  auto &bucket = GetParkingBucket(this);
+  std::unique_lock lock(bucket.mutex_);
+  if (!state_.compare_exchange_strong(state, state | PARKED, std::memory_order_relaxed)) {
+    return false;
+  }
+  bucket.cv_.wait(lock);
+  return true;
+}
+
+void ReaderWriterLatch::Unpark() {
+  auto &bucket = GetParkingBucket(this);
+  std::scoped_lock lock(bucket.mutex_);
+  bucket.cv_.notify_all();
+}
+
+}  // namespace bustub
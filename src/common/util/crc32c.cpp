@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The Castagnoli polynomial, bit-reversed. */
+constexpr uint32_t POLYNOMIAL = 0x82F63B78;
+
+constexpr auto MakeTable() -> std::array<uint32_t, 256> {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? POLYNOMIAL : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> TABLE = MakeTable();
+
+auto ExtendSoftware(uint32_t crc, const unsigned char *data, size_t size) -> uint32_t {
+  for (size_t i = 0; i < size; i++) {
+    crc = TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) auto ExtendHardware(uint32_t crc, const unsigned char *data, size_t size)
+    -> uint32_t {
+  uint64_t crc64 = crc;
+  for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; size > 0; data++, size--) {
+    crc = _mm_crc32_u8(crc, *data);
+  }
+  return crc;
+}
+
+#endif
+
+auto HasSse42() -> bool {
+#if defined(__x86_64__)
+  static const bool has_sse42 = (__builtin_cpu_init(), __builtin_cpu_supports("sse4.2"));
+  return has_sse42;
+#else
+  return false;
+#endif
+}
+
+}  // namespace
+
+auto Crc32c::Extend(uint32_t crc, const char *data, size_t size) -> uint32_t {
+  const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+  crc = ~crc;
+#if defined(__x86_64__)
+  if (HasSse42()) {
+    return ~ExtendHardware(crc, bytes, size);
+  }
+#endif
+  return ~ExtendSoftware(crc, bytes, size);
+}
+
+auto Crc32c::IsHardwareAccelerated() -> bool { return HasSse42(); }
+
+}  // namespace bustub
@@ -12,19 +12,106 @@
 
 #include "execution/executors/nested_index_join_executor.h"
 
+#include <algorithm>
+
+#include "type/value_factory.h"
+
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void NestIndexJoinExecutor::Init() { throw NotImplementedException("NestIndexJoinExecutor is not implemented"); }
+void NestIndexJoinExecutor::Init() {
+  child_executor_->Init();
+  auto *catalog = exec_ctx_->GetCatalog();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  inner_table_info_ = catalog->GetTable(plan_->GetInnerTableOid());
+  results_.clear();
+  next_result_ = 0;
+}
+
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (next_result_ == results_.size()) {
+    if (!JoinBatch()) {
+      return false;
+    }
+  }
+  *tuple = std::move(results_[next_result_++]);
+  return true;
+}
+
+auto NestIndexJoinExecutor::JoinBatch() -> bool {
+  results_.clear();
+  next_result_ = 0;
+
+  const Schema &outer_schema = child_executor_->GetOutputSchema();
+  const Schema *key_schema = index_info_->index_->GetKeySchema();
+  std::vector<Tuple> outer_tuples;
+  std::vector<Value> key_values;
+  Tuple outer_tuple;
+  RID outer_rid;
+  while (outer_tuples.size() < INDEX_JOIN_BATCH_SIZE && child_executor_->Next(&outer_tuple, &outer_rid)) {
+    key_values.push_back(plan_->KeyPredicate()->Evaluate(&outer_tuple, outer_schema));
+    outer_tuples.push_back(std::move(outer_tuple));
+  }
+  if (outer_tuples.empty()) {
+    return false;
+  }
+
+  // probe in key order; a null key matches nothing and is left out
+  std::vector<size_t> order;
+  for (size_t i = 0; i < key_values.size(); i++) {
+    if (!key_values[i].IsNull()) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&key_values](size_t a, size_t b) {
+    return key_values[a].CompareLessThan(key_values[b]) == CmpBool::CmpTrue;
+  });
+  std::vector<Tuple> keys;
+  keys.reserve(order.size());
+  for (size_t i : order) {
+    keys.emplace_back(std::vector<Value>{key_values[i]}, key_schema);
+  }
+  std::vector<std::vector<RID>> sorted_matches;
+  index_info_->index_->ScanKeys(keys, &sorted_matches, exec_ctx_->GetTransaction());
+  std::vector<std::vector<RID>> matches(outer_tuples.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    matches[order[i]] = std::move(sorted_matches[i]);
+  }
 
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  const Schema &inner_schema = plan_->InnerTableSchema();
+  for (size_t i = 0; i < outer_tuples.size(); i++) {
+    std::vector<Value> outer_values;
+    for (uint32_t column = 0; column < outer_schema.GetColumnCount(); column++) {
+      outer_values.push_back(outer_tuples[i].GetValue(&outer_schema, column));
+    }
+    for (const RID &inner_rid : matches[i]) {
+      Tuple inner_tuple;
+      if (!inner_table_info_->table_->GetTuple(inner_rid, &inner_tuple, exec_ctx_->GetTransaction())) {
+        continue;
+      }
+      std::vector<Value> values = outer_values;
+      for (uint32_t column = 0; column < inner_schema.GetColumnCount(); column++) {
+        values.push_back(inner_tuple.GetValue(&inner_schema, column));
+      }
+      results_.emplace_back(std::move(values), &GetOutputSchema());
+    }
+    if (matches[i].empty() && plan_->GetJoinType() == JoinType::LEFT) {
+      std::vector<Value> values = outer_values;
+      for (uint32_t column = 0; column < inner_schema.GetColumnCount(); column++) {
+        values.push_back(ValueFactory::GetNullValueByType(inner_schema.GetColumn(column).GetType()));
+      }
+      results_.emplace_back(std::move(values), &GetOutputSchema());
+    }
+  }
+  return true;
+}
 
 }  // namespace bustub
@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha).
+ *
+ * Resident frames live in T1 (seen once recently) or T2 (seen at least twice). The replacer also remembers the pages
+ * it recently evicted from T1 and T2 in the ghost lists B1 and B2. A page that comes back while it is in B1 grows the
+ * target size p of T1, one that comes back from B2 shrinks it, and Evict takes from T1 whenever T1 is larger than p.
+ *
+ * Pinned frames cannot be evicted, so Evict takes the least recently used evictable frame of the chosen list and
+ * falls back to the other list if the chosen one has none. Scan accesses never promote a frame into T2 and never
+ * adapt p.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ARCReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+ private:
+  enum class ListId { T1, T2, B1, B2 };
+
+  struct FrameInfo {
+    ListId list_;
+    std::list<frame_id_t>::iterator pos_;
+    /** The page id, or the frame id if the page id is unknown. Moves to a ghost list on eviction. */
+    page_id_t key_;
+    bool is_evictable_{false};
+  };
+
+  struct GhostInfo {
+    ListId list_;
+    std::list<page_id_t>::iterator pos_;
+  };
+
+  /** @return the resident list of the given id */
+  auto ResidentList(ListId list) -> std::list<frame_id_t> & { return list == ListId::T1 ? t1_ : t2_; }
+
+  /** @brief Evict the least recently used evictable frame of list, if any. */
+  auto EvictFrom(ListId list, frame_id_t *frame_id) -> bool;
+
+  /** @brief Forget the least recently used page of ghost list. */
+  void DropGhost(ListId list);
+
+  /** Resident lists, least recently used first. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  /** Ghost lists of recently evicted pages, least recently evicted first. */
+  std::list<page_id_t> b1_;
+  std::list<page_id_t> b2_;
+  std::unordered_map<frame_id_t, FrameInfo> frames_;
+  std::unordered_map<page_id_t, GhostInfo> ghosts_;
+  /** Target size of T1. */
+  size_t p_{0};
+  size_t capacity_;
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
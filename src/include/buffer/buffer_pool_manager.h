@@ -12,103 +12,143 @@
 
 #pragma once
 
-#include <list>
-#include <memory>
-#include <mutex>  // NOLINT
-#include <unordered_map>
-#include <cassert>
-
-#include "buffer/lru_k_replacer.h"
-#include "buffer/lru_replacer.h"
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/buffer_ring.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
-#include "recovery/log_manager.h"
-#include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
 /**
- * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ * BufferPoolManager is the interface of a buffer pool, which reads disk pages to and from memory. It is implemented
+ * by BufferPoolManagerInstance, a single pool of frames, and ParallelBufferPoolManager, which spreads the pages over
+ * several instances. The page guard wrappers are implemented here on top of the virtual functions.
  */
 class BufferPoolManager {
  public:
+  BufferPoolManager() = default;
+  virtual ~BufferPoolManager() = default;
+
+  /** @brief Return the size (number of frames) of the buffer pool. */
+  virtual auto GetPoolSize() -> size_t = 0;
+
+  /**
+   * @brief Get the page held by a frame of the buffer pool, whether it is in use or not.
+   * @param frame_id the frame, in [0, GetPoolSize())
+   */
+  virtual auto GetPage(frame_id_t frame_id) -> Page * = 0;
+
+  /** @return the number of page fetches that were served without going to disk */
+  virtual auto GetHitCount() const -> size_t = 0;
+
+  /** @return the number of page fetches that had to read the page from disk */
+  virtual auto GetMissCount() const -> size_t = 0;
+
+  /** @return the number of times a thread had to wait for a buffer pool latch */
+  virtual auto GetContentionCount() const -> size_t = 0;
+
+  /** @return the number of dirty pages written back by the background writer */
+  virtual auto GetBackgroundWriteCount() const -> size_t = 0;
+
+  /** @return the number of dirty victims NewPage and FetchPage had to write back before reusing their frame */
+  virtual auto GetForegroundWriteCount() const -> size_t = 0;
+
+  /** @return the number of pages read from disk that failed their checksum */
+  virtual auto GetChecksumFailureCount() const -> size_t = 0;
+
+  /** @return the number of pages loaded by Prefetch */
+  virtual auto GetPrefetchCount() const -> size_t = 0;
+
+  /** @return the number of pages FetchPageRead served from the mapping of the database file */
+  virtual auto GetMappedReadCount() const -> size_t = 0;
+
   /**
-   * @brief Creates a new BufferPoolManager.
-   * @param pool_size the size of the buffer pool
-   * @param disk_manager the disk manager
-   * @param replacer_k the lookback constant k for the LRU-K replacer
-   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @brief Take a snapshot of the counters of the buffer pool.
+   * @return the counters
    */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+  virtual auto GetStats() -> BufferPoolStats = 0;
 
   /**
-   * @brief Destroy an existing BufferPoolManager.
+   * @brief Sample page accesses into a heat map by page id, one in every sample_interval fetches of each thread.
+   * @param sample_interval the sampling interval, 0 to stop sampling; samples taken so far are kept
    */
-  ~BufferPoolManager();
+  virtual void SetHeatMapSampleInterval(size_t sample_interval) = 0;
 
-  /** @brief Return the size (number of frames) of the buffer pool. */
-  auto GetPoolSize() -> size_t { return pool_size_; }
+  /**
+   * @param n the number of pages to return
+   * @return the n pages with the most sampled accesses and their sample counts, hottest first
+   */
+  virtual auto GetHottestPages(size_t n) -> std::vector<std::pair<page_id_t, size_t>> = 0;
 
-  /** @brief Return the pointer to all the pages in the buffer pool. */
-  auto GetPages() -> Page * { return pages_; }
+  /**
+   * @brief Keep up to capacity bytes of evicted pages compressed in memory, see CompressedPageCache.
+   * @param capacity the number of compressed bytes to keep, 0 to turn the cache off
+   */
+  virtual void SetCompressedCacheCapacity(size_t capacity) = 0;
 
-  void GetReplaceFrameId(frame_id_t *frameid);
+  /**
+   * @brief Turn the verification of page checksums on reads from disk on or off.
+   * @param verify true to verify the checksum of every page read from disk or the mapping of the database file
+   */
+  virtual void SetVerifyChecksums(bool verify) = 0;
 
   /**
-   * @brief Create a new page in the buffer pool. Set page_id to the new page's id, or nullptr if all frames
-   * are currently in use and not evictable (in another words, pinned).
-   *
-   * You should pick the replacement frame from either the free list or the replacer (always find from the free list
-   * first), and then call the AllocatePage() method to get a new page id. If the replacement frame has a dirty page,
-   * you should write it back to the disk first. You also need to reset the memory and metadata for the new page.
-   *
-   * Remember to "Pin" the frame by calling replacer.SetEvictable(frame_id, false)
-   * so that the replacer wouldn't evict the frame before the buffer pool manager "Unpin"s it.
-   * Also, remember to record the access history of the frame in the replacer for the lru-k algorithm to work.
-   *
+   * @brief Start writing dirty unpinned pages back to disk in the background.
+   * @param clean_target the number of reusable clean frames to keep
+   */
+  virtual void StartBackgroundWriter(size_t clean_target) = 0;
+
+  /** @brief Stop the background writer. Does nothing if it is not running. */
+  virtual void StopBackgroundWriter() = 0;
+
+  /**
+   * @brief Start loading pages that a scan is about to read, without waiting for them.
+   * @param page_ids the pages to load, in the order they will be read
+   */
+  virtual void Prefetch(const std::vector<page_id_t> &page_ids) = 0;
+
+  /** @return true if the database file is opened read-only, so that no page can be created, changed or deleted */
+  virtual auto IsReadOnly() const -> bool = 0;
+
+  /**
+   * @brief Create a new page in the buffer pool.
    * @param[out] page_id id of created page
+   * @param hint a page the new page will be read together with, so that it is placed close to it, or INVALID_PAGE_ID
+   * @param ring the ring of a bulk operation the new page takes its frame from, or nullptr for the whole pool
    * @return nullptr if no new pages could be created, otherwise pointer to new page
+   * @throws Exception if the buffer pool is read-only
    */
-  auto NewPage(page_id_t *page_id) -> Page *;
+  virtual auto NewPage(page_id_t *page_id, page_id_t hint = INVALID_PAGE_ID, BufferRing *ring = nullptr) -> Page * = 0;
 
   /**
    * @brief PageGuard wrapper for NewPage
-   *
-   * Functionality should be the same as NewPage, except that
-   * instead of returning a pointer to a page, you return a
-   * BasicPageGuard structure.
-   *
    * @param[out] page_id, the id of the new page
+   * @param hint a page to place the new page close to, or INVALID_PAGE_ID
    * @return BasicPageGuard holding a new page
    */
-  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+  auto NewPageGuarded(page_id_t *page_id, page_id_t hint = INVALID_PAGE_ID) -> BasicPageGuard;
 
   /**
-   * @brief Fetch the requested page from the buffer pool. Return nullptr if page_id needs to be fetched from the disk
-   * but all frames are currently in use and not evictable (in another word, pinned).
-   *
-   * First search for page_id in the buffer pool. If not found, pick a replacement frame from either the free list or
-   * the replacer (always find from the free list first), read the page from disk by calling disk_manager_->ReadPage(),
-   * and replace the old page in the frame. Similar to NewPage(), if the old page is dirty, you need to write it back
-   * to disk and update the metadata of the new page
-   *
-   * In addition, remember to disable eviction and record the access history of the frame like you did for NewPage().
-   *
+   * @brief Fetch the requested page from the buffer pool, pinned.
    * @param page_id id of page to be fetched
-   * @param access_type type of access to the page, only needed for leaderboard tests.
+   * @param access_type type of access to the page
+   * @param ring the ring of a large sequential operation that a miss takes its frame from, or nullptr
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   * @throws Exception of type CORRUPTION if the page read from disk fails its checksum
    */
-  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
+  virtual auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown, BufferRing *ring = nullptr)
+      -> Page * = 0;
 
   /**
    * @brief PageGuard wrappers for FetchPage
    *
-   * Functionality should be the same as FetchPage, except
-   * that, depending on the function called, a guard is returned.
-   * If FetchPageRead or FetchPageWrite is called, it is expected that
-   * the returned page already has a read or write latch held, respectively.
+   * FetchPageRead tries FetchPageMapped first. FetchPageRead and FetchPageWrite return the page with its read or write
+   * latch held, respectively. FetchPageWrite throws an Exception if the buffer pool is read-only.
    *
    * @param page_id, the id of the page to fetch
    * @return PageGuard holding the fetched page
@@ -118,93 +158,55 @@ class BufferPoolManager {
   auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
 
   /**
-   * @brief Unpin the target page from the buffer pool. If page_id is not in the buffer pool or its pin count is already
-   * 0, return false.
-   *
-   * Decrement the pin count of a page. If the pin count reaches 0, the frame should be evictable by the replacer.
-   * Also, set the dirty flag on the page to indicate if the page was modified.
-   *
-   * @param page_id id of page to be unpinned
-   * @param is_dirty true if the page should be marked as dirty, false otherwise
-   * @param access_type type of access to the page, only needed for leaderboard tests.
-   * @return false if the page is not in the page table or its pin count is <= 0 before this call, true otherwise
+   * @brief Fetch a page for an optimistic read, without the page latch or a pin.
+   * @param page_id the id of the page to fetch
+   * @return an OptimisticReadGuard for the page, empty if page_id cannot be fetched
    */
-  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
-  
-  /** @brief Kobi added this method. */
-  auto PinPage(page_id_t page_id) -> bool;
+  virtual auto FetchPageOptimistic(page_id_t page_id) -> OptimisticReadGuard = 0;
 
   /**
-   * @brief Flush the target page to disk.
-   *
-   * Use the DiskManager::WritePage() method to flush a page to disk, REGARDLESS of the dirty flag.
-   * Unset the dirty flag of the page after flushing.
-   *
-   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
-   * @return false if the page could not be found in the page table, true otherwise
+   * @brief Fetch a page for reading with its read latch but without pinning it.
+   * @param page_id the id of the page to fetch
+   * @return an EpochReadGuard for the page, empty if page_id cannot be fetched
    */
-  auto FlushPage(page_id_t page_id) -> bool;
+  virtual auto FetchPageEpoch(page_id_t page_id) -> EpochReadGuard = 0;
 
   /**
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Read a page that is not in the buffer pool straight from the mapping of the database file.
+   * @param page_id the id of the page to read
+   * @return a guard for which IsMapped() is true, or an empty guard if the page has to be fetched into a frame
    */
-  void FlushAllPages();
+  virtual auto FetchPageMapped(page_id_t page_id) -> ReadPageGuard = 0;
 
   /**
-   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
-   * page is pinned and cannot be deleted, return false immediately.
-   *
-   * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
-   * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
-   * imitate freeing the page on the disk.
-   *
-   * @param page_id id of page to be deleted
-   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   * @brief Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @param access_type type of access to the page
+   * @return false if the page is not in the page table or its pin count is <= 0 before this call, true otherwise
    */
-  auto DeletePage(page_id_t page_id) -> bool;
-
- private:
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
-
-  /** Array of buffer pool pages. */
-  Page *pages_;
-  /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. Please ignore this for P1. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUReplacer> replacer_;
-  /** List of free frames that don't have any pages on them. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  virtual auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool = 0;
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
-   * @return the id of the allocated page
+   * @brief Flush the target page to disk, regardless of the dirty flag.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
    */
-  auto AllocatePage() -> page_id_t;
-
-  page_id_t PageIdFromFrameId(frame_id_t frame_id);
-
-  void WritePageToDisk(page_id_t page_id);
+  virtual auto FlushPage(page_id_t page_id) -> bool = 0;
 
-  void PageFromPageId(page_id_t page_id, Page *page);
-
-  void ReadPageFromDisk(page_id_t read_page_id, page_id_t replace_page_id);
+  /** @brief Flush all the pages in the buffer pool, and the free-space map of the disk manager, to disk. */
+  virtual void FlushAllPages() = 0;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
-   * @param page_id id of the page to deallocate
+   * @brief Delete a page from the buffer pool and deallocate it on disk.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   * @throws Exception if the buffer pool is read-only
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  virtual auto DeletePage(page_id_t page_id) -> bool = 0;
 
+ protected:
+  /** @throws Exception if the buffer pool is read-only, so that no page is changed while readers use the mapping */
+  void CheckWritable() const;
 };
 }  // namespace bustub
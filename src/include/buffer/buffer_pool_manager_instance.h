@@ -0,0 +1,589 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.h
+//
+// Identification: src/include/buffer/buffer_pool_manager_instance.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/buffer_ring.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/epoch_manager.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+/**
+ * FrameHeader is the buffer pool's book-keeping for one frame. The headers are stored contiguously and indexed by
+ * frame id, so the page held by a frame can be found without searching the page table.
+ */
+struct FrameHeader {
+  /** The page held by the frame, INVALID_PAGE_ID if the frame is free. */
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /** Number of outstanding pins on the frame. Only goes from 0 to 1 and from 1 to 0 under the latch. */
+  std::atomic<int> pin_count_{0};
+  /** True if the frame differs from the page on disk. */
+  std::atomic<bool> is_dirty_{false};
+  /** LSN of the page the last time it was unpinned dirty or read from disk. */
+  std::atomic<lsn_t> lsn_{INVALID_LSN};
+  /** True if the page was loaded by Prefetch and nobody has pinned it yet. */
+  std::atomic<bool> prefetched_{false};
+  /** Set by readers that do not pin the frame, which the replacer does not hear about. See FetchPageEpoch. */
+  std::atomic<bool> referenced_{false};
+};
+
+/**
+ * BufferPoolManagerInstance reads disk pages to and from its internal buffer pool: a single pool of frames with one
+ * page table, free list, replacer and latch.
+ */
+class BufferPoolManagerInstance : public BufferPoolManager {
+ public:
+  /**
+   * @brief Creates a new BufferPoolManagerInstance.
+   * @param pool_size the size of the buffer pool
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_policy the replacement policy used to pick frames to evict
+   * @param arena_options the memory layout of the frames
+   */
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr, ReplacerPolicy replacer_policy = ReplacerPolicy::LRUK,
+                            const FrameArenaOptions &arena_options = {});
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one instance of a ParallelBufferPoolManager.
+   *
+   * Page ids allocated by this instance satisfy page_id % num_instances == instance_index, so that the owning
+   * instance of any page can be found by hashing its id.
+   *
+   * @param pool_size the size of this instance's buffer pool
+   * @param num_instances the total number of instances in the parallel buffer pool
+   * @param instance_index the index of this instance in the parallel buffer pool
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_policy the replacement policy used to pick frames to evict
+   * @param arena_options the memory layout of the frames; a NUMA-aware instance is placed on a single node
+   */
+  BufferPoolManagerInstance(size_t pool_size, size_t num_instances, size_t instance_index, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRUK,
+                            const FrameArenaOptions &arena_options = {});
+
+  /**
+   * @brief Destroy an existing BufferPoolManagerInstance.
+   */
+  ~BufferPoolManagerInstance() override;
+
+  /** @brief Return the size (number of frames) of the buffer pool. */
+  auto GetPoolSize() -> size_t override { return pool_size_; }
+
+  /** @return the number of page fetches that were served without going to disk */
+  auto GetHitCount() const -> size_t override { return num_hits_.Load(); }
+
+  /** @return the number of page fetches that had to read the page from disk */
+  auto GetMissCount() const -> size_t override { return num_misses_.Load(); }
+
+  /** @return the number of times a thread had to wait for this instance's latch */
+  auto GetContentionCount() const -> size_t override { return num_latch_waits_.load(std::memory_order_relaxed); }
+
+  /** @return the number of dirty pages written back by the background writer */
+  auto GetBackgroundWriteCount() const -> size_t override { return num_bg_writes_.load(std::memory_order_relaxed); }
+
+  /** @return the number of dirty victims NewPage and FetchPage had to write back before reusing their frame */
+  auto GetForegroundWriteCount() const -> size_t override { return num_fg_writes_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Take a snapshot of the counters of this instance.
+   * @return the counters
+   */
+  auto GetStats() -> BufferPoolStats override;
+
+  /**
+   * @brief Sample page accesses into a heat map by page id, one in every sample_interval fetches of each thread.
+   * @param sample_interval the sampling interval, 0 to stop sampling; samples taken so far are kept
+   */
+  void SetHeatMapSampleInterval(size_t sample_interval) override;
+
+  /**
+   * @param n the number of pages to return
+   * @return the n pages with the most sampled accesses and their sample counts, hottest first
+   */
+  auto GetHottestPages(size_t n) -> std::vector<std::pair<page_id_t, size_t>> override;
+
+  /**
+   * @brief Keep up to capacity bytes of evicted pages compressed in memory, as a second tier between the frames and
+   * the disk. A miss on a page in the cache decompresses it instead of reading it from disk. Changing the capacity
+   * drops the pages cached so far, and 0 turns the cache off, which is the default. See CompressedPageCache.
+   * @param capacity the number of compressed bytes to keep, split evenly over the instances of a parallel buffer pool
+   */
+  void SetCompressedCacheCapacity(size_t capacity) override;
+
+  /**
+   * @brief Turn the verification of page checksums on reads from disk on or off; it is on by default. Pages are
+   * stamped with their checksum on every write either way, see PageChecksum.
+   * @param verify true to verify the checksum of every page read from disk or the mapping of the database file
+   */
+  void SetVerifyChecksums(bool verify) override;
+
+  /** @return the number of pages read from disk that failed their checksum */
+  auto GetChecksumFailureCount() const -> size_t override {
+    return num_checksum_failures_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Start a thread that writes dirty unpinned pages back to disk in the background, so that the frame the
+   * replacer picks is usually clean and NewPage/FetchPage do not wait for a write.
+   *
+   * Every bg_writer_interval the writer counts the frames that can be reused without a write (free, or unpinned and
+   * clean). If there are fewer than clean_target, it writes up to BG_WRITER_BATCH_SIZE dirty unpinned pages in page
+   * id order. A foreground eviction that still had to write a dirty victim wakes the writer up for a full batch, since
+   * the replacer evidently prefers the dirty frames. Does nothing if the writer is already running.
+   *
+   * @param clean_target the number of reusable clean frames to keep
+   */
+  void StartBackgroundWriter(size_t clean_target) override;
+
+  /**
+   * @brief Stop and join the background writer thread. Does nothing if it is not running.
+   */
+  void StopBackgroundWriter() override;
+
+  /** @return the number of pages loaded by Prefetch */
+  auto GetPrefetchCount() const -> size_t override { return num_prefetches_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Start loading pages that a scan is about to read, without waiting for them.
+   *
+   * The pages are read by a prefetch thread, started on first use, into frames that are left unpinned and recorded as
+   * AccessType::Scan accesses, so that read-ahead does not push frequently used pages out. Pages that are already
+   * resident, or that find every frame pinned, are skipped. Requests are dropped while pool_size pages are already
+   * waiting to be read.
+   *
+   * @param page_ids the pages to load, in the order they will be read
+   */
+  void Prefetch(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * @brief Get the page held by a frame of the buffer pool, whether it is in use or not.
+   * @param frame_id the frame, in [0, GetPoolSize())
+   */
+  auto GetPage(frame_id_t frame_id) -> Page * override { return &pages_[frame_id]; }
+
+  /** @return true if the disk manager is read-only, see DiskManager::IsReadOnly */
+  auto IsReadOnly() const -> bool override { return disk_manager_->IsReadOnly(); }
+
+  /**
+   * @brief Create a new page in the buffer pool. Set page_id to the new page's id, or nullptr if all frames
+   * are currently in use and not evictable (in another words, pinned).
+   *
+   * You should pick the replacement frame from either the free list or the replacer (always find from the free list
+   * first), and then call the AllocatePage() method to get a new page id. If the replacement frame has a dirty page,
+   * you should write it back to the disk first. You also need to reset the memory and metadata for the new page.
+   *
+   * Remember to "Pin" the frame by calling replacer.SetEvictable(frame_id, false)
+   * so that the replacer wouldn't evict the frame before the buffer pool manager "Unpin"s it.
+   * Also, remember to record the access history of the frame in the replacer for the lru-k algorithm to work.
+   *
+   * The new page starts out dirty, so that its zeroed contents replace whatever a deallocated page with the same id
+   * left on disk. A copy of that page an optimistic reader fetched after it was deleted is dropped first, see
+   * DropStaleFrame.
+   *
+   * @param[out] page_id id of created page
+   * @param hint a page the new page will be read together with (e.g. the leaf being split), so that the disk manager
+   * places the new page close to it, or INVALID_PAGE_ID
+   * @param ring the ring of a bulk operation the new page takes its frame from, or nullptr for the whole pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   * @throws Exception if the disk manager is read-only, see DiskManager::IsReadOnly
+   */
+  auto NewPage(page_id_t *page_id, page_id_t hint = INVALID_PAGE_ID, BufferRing *ring = nullptr) -> Page * override;
+
+  /**
+   * @brief Fetch the requested page from the buffer pool. Return nullptr if page_id needs to be fetched from the disk
+   * but all frames are currently in use and not evictable (in another word, pinned).
+   *
+   * First search for page_id in the buffer pool. If not found, pick a replacement frame from either the free list or
+   * the replacer (always find from the free list first), read the page from disk by calling disk_manager_->ReadPage(),
+   * and replace the old page in the frame. Similar to NewPage(), if the old page is dirty, you need to write it back
+   * to disk and update the metadata of the new page
+   *
+   * In addition, remember to disable eviction and record the access history of the frame like you did for NewPage().
+   *
+   * @param page_id id of page to be fetched
+   * @param access_type type of access to the page, only needed for leaderboard tests.
+   * @param ring the ring of a large sequential operation that a miss takes its frame from, or nullptr for the whole
+   * pool
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   * @throws Exception of type CORRUPTION if the page read from disk fails its checksum, see SetVerifyChecksums
+   */
+  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown, BufferRing *ring = nullptr)
+      -> Page * override;
+
+  /**
+   * @brief Fetch a page for an optimistic read: neither the page latch nor a pin is taken, so readers of hot pages do
+   * not write to any shared cache line. The frame is looked up inside an epoch instead, see FetchPageEpoch. Pages that
+   * are not resident are read from the mapping of the database file when the disk manager has one, like in
+   * FetchPageRead, and pinned only until they are in a frame otherwise.
+   *
+   * @param page_id the id of the page to fetch
+   * @return an OptimisticReadGuard for the page, empty if page_id cannot be fetched
+   */
+  auto FetchPageOptimistic(page_id_t page_id) -> OptimisticReadGuard override;
+
+  /**
+   * @brief Fetch a page for reading without pinning it. The guard takes the page read latch, like FetchPageRead, and
+   * the buffer pool never evicts a frame whose latch is held.
+   *
+   * Between looking the frame up and latching it, the reader is inside the epoch of the instance. A frame that is
+   * evicted, or whose page is deleted, is retired and only reused once every reader that entered the epoch before it
+   * was dropped from the page table has exited, so the reader never latches a frame that holds another page by then.
+   * Hits neither pin the frame nor update the replacer. A page that is not resident, or whose latch a writer holds, is
+   * fetched with a pin that is dropped once the page is latched.
+   *
+   * @param page_id the id of the page to fetch
+   * @return an EpochReadGuard for the page, empty if page_id cannot be fetched
+   */
+  auto FetchPageEpoch(page_id_t page_id) -> EpochReadGuard override;
+
+  /**
+   * @brief Read a page that is not in the buffer pool straight from the disk manager's mapping of the database file,
+   * without taking a frame or copying the page. FetchPageRead tries this first.
+   *
+   * Only an MmapDiskManager can do this, which opens the database file read-only: the pool then hands out no page for
+   * writing, so the guard needs no page latch, and a reader walking several mapped pages never sees some of them
+   * before and some after a structure change. A resident page is read from its frame instead.
+   *
+   * @param page_id the id of the page to read
+   * @return a guard for which IsMapped() is true, or an empty guard if the page has to be fetched into a frame
+   */
+  auto FetchPageMapped(page_id_t page_id) -> ReadPageGuard override;
+
+  /** @return the number of pages FetchPageRead served from the mapping of the database file */
+  auto GetMappedReadCount() const -> size_t override { return num_mapped_reads_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Unpin the target page from the buffer pool. If page_id is not in the buffer pool or its pin count is already
+   * 0, return false.
+   *
+   * Decrement the pin count of a page. If the pin count reaches 0, the frame should be evictable by the replacer.
+   * Also, set the dirty flag on the page to indicate if the page was modified.
+   *
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @param access_type type of access to the page, only needed for leaderboard tests.
+   * @return false if the page is not in the page table or its pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool override;
+
+  /**
+   * @brief Flush the target page to disk.
+   *
+   * Use the DiskManager::WritePage() method to flush a page to disk, REGARDLESS of the dirty flag.
+   * Unset the dirty flag of the page after flushing. Waits for a writer of the page, so the calling thread must not
+   * hold the page's write latch.
+   *
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPage(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Flush all the pages in the buffer pool, and the free-space map of the disk manager, to disk. Like FlushPage,
+   * waits for writers, so the calling thread must not hold a write latch.
+   */
+  void FlushAllPages() override;
+
+  /**
+   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
+   * page is pinned or held by an EpochReadGuard and cannot be deleted, return false immediately.
+   *
+   * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
+   * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
+   * imitate freeing the page on the disk.
+   *
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   * @throws Exception if the disk manager is read-only
+   */
+  auto DeletePage(page_id_t page_id) -> bool override;
+
+ private:
+  /** Number of pages in the buffer pool. */
+  const size_t pool_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const size_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const size_t instance_index_ = 0;
+
+  /**
+   * The page buffers of every frame, carved out of one aligned mapping. Not used when built with
+   * BUSTUB_PER_PAGE_FRAMES, where every page allocates its own buffer so that ASAN can catch overflows.
+   */
+  std::unique_ptr<FrameArena> arena_;
+  /** Array of buffer pool pages. */
+  Page *pages_;
+  /** Book-keeping for each frame, indexed by frame id in the same order as pages_. */
+  std::unique_ptr<FrameHeader[]> frames_;
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Pointer to the log manager. Please ignore this for P1. */
+  LogManager *log_manager_ __attribute__((__unused__));
+  /** Page table for keeping track of buffer pool pages. Lookups are lock-free, updates happen under latch_. */
+  PageTable page_table_;
+  /** Replacer to find unpinned pages for replacement. */
+  std::unique_ptr<Replacer> replacer_;
+  /** List of free frames that don't have any pages on them. */
+  std::list<frame_id_t> free_list_;
+  /** Compressed copies of evicted pages, nullptr unless SetCompressedCacheCapacity turned it on. */
+  std::unique_ptr<CompressedPageCache> compressed_cache_;
+  /** Epochs of the readers that use frames without pinning them. */
+  EpochManager epochs_;
+  /** Frames dropped from the page table that pin-free readers may still look at, with the epoch they retired in. */
+  std::vector<std::pair<frame_id_t, uint64_t>> retired_frames_;
+  /** This latch protects the page table, the free list, the replacer and the frame metadata of this instance. */
+  std::mutex latch_;
+  /** Number of fetches served from the buffer pool. */
+  StatsCounter num_hits_;
+  /** Number of fetches that had to go to disk. */
+  StatsCounter num_misses_;
+  /** Number of pages evicted from their frame. */
+  std::atomic<size_t> num_evictions_{0};
+  /** Number of NewPage and FetchPage calls that found every frame pinned. */
+  std::atomic<size_t> num_all_pinned_{0};
+  /** Sampled page accesses, see SetHeatMapSampleInterval. */
+  PageHeatMap heat_map_;
+  /** Number of times latch_ was already held when a thread tried to take it. */
+  std::atomic<size_t> num_latch_waits_{0};
+  /** Number of pages written back by the background writer. */
+  std::atomic<size_t> num_bg_writes_{0};
+  /** Number of dirty victims written back by NewPage and FetchPage. */
+  std::atomic<size_t> num_fg_writes_{0};
+
+  /** The background writer thread, if it is running. */
+  std::thread bg_writer_thread_;
+  /** True while the background writer should keep running. */
+  std::atomic<bool> enable_bg_writer_{false};
+  /** Number of reusable clean frames the background writer tries to keep. */
+  size_t bg_writer_clean_target_{0};
+  /** Frame the next search for dirty pages starts from. Only used by the background writer thread. */
+  size_t bg_writer_cursor_{0};
+  /** Number of pages loaded by the prefetch thread. */
+  std::atomic<size_t> num_prefetches_{0};
+  /** Number of pages served from the mapping of the database file. */
+  std::atomic<size_t> num_mapped_reads_{0};
+  /** Whether pages read from disk have their checksum verified. */
+  std::atomic<bool> verify_checksums_{true};
+  /** Number of pages read from disk that failed their checksum. */
+  std::atomic<size_t> num_checksum_failures_{0};
+
+  /** The prefetch thread, started by the first call to Prefetch. */
+  std::thread prefetch_thread_;
+  /** Pages waiting to be prefetched, oldest request first. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** Set by the destructor to stop the prefetch thread. */
+  bool stop_prefetch_{false};
+  /** Protects prefetch_thread_, prefetch_queue_ and stop_prefetch_. Never held together with latch_. */
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+
+  /** Set when a foreground eviction wrote a dirty page, so that the writer skips the rest of its sleep. */
+  bool bg_writer_wakeup_{false};
+  /** Protects bg_writer_wakeup_. Never held together with latch_ by the writer thread. */
+  std::mutex bg_writer_latch_;
+  std::condition_variable bg_writer_cv_;
+
+  /**
+   * @brief Take latch_, counting the acquisition as contended if another thread already holds it.
+   * @return the held latch
+   */
+  auto AcquireLatch() -> std::unique_lock<std::mutex>;
+
+  /**
+   * @brief Allocate a page on disk, among the page ids that belong to this instance. Caller should acquire the latch
+   * before calling this function.
+   * @param hint a page to place the new page close to, or INVALID_PAGE_ID
+   * @return the id of the allocated page
+   */
+  auto AllocatePage(page_id_t hint = INVALID_PAGE_ID) -> page_id_t;
+
+  /**
+   * @brief Pick a frame for a new page, from the free list first, retired frames second and the replacer third. If the
+   * frame held a page, the page is written back when dirty and removed from the page table; if a pin-free reader may
+   * still be looking at the frame, it is retired and the next victim is tried. Caller must hold the latch.
+   * @param[out] frame_id the frame that can be reused, or -1 if every frame is pinned or retired
+   * @param keep_prefetched if true, pages loaded by Prefetch that nobody has read yet are handed back to the replacer
+   * instead of being reused, so that read-ahead does not evict its own earlier read-ahead
+   */
+  void GetReplaceFrameId(frame_id_t *frame_id, bool keep_prefetched = false);
+
+  /**
+   * @brief Pick a frame for a page of a ring operation: a new frame from GetReplaceFrameId while the ring is not full,
+   * its oldest frame after that. Caller must hold the latch.
+   * @param ring the ring
+   * @param[out] frame_id the frame that can be reused, or -1 if every frame is pinned
+   * @return the slot of the ring the frame is in, whose page id the caller sets once it is known; nullptr if there
+   * is no frame
+   */
+  auto GetRingFrameId(BufferRing *ring, frame_id_t *frame_id) -> BufferRing::Slot *;
+
+  /**
+   * @brief Drop the unpinned page in frame_id from the page table, unless a pin-free reader holds its latch. Bumps the
+   * page version, so that optimistic readers of the frame fail to validate. Caller must hold the latch.
+   * @return false if the frame is latched and keeps its page
+   */
+  auto DetachFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Retire a detached frame. Caller must hold the latch.
+   * @return true if no pin-free reader can still see the frame, so that it can be reused right away; otherwise it is
+   * put on retired_frames_
+   */
+  auto RetireFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Drop a copy of page_id that a reader fetched after the page was deleted, before a new page takes the id.
+   * Waits, with the latch released, until nobody pins or latches the copy.
+   * @param lock the held latch
+   * @param page_id the id AllocatePage just handed out
+   */
+  void DropStaleFrame(std::unique_lock<std::mutex> *lock, page_id_t page_id);
+
+  /**
+   * @brief Take a retired frame that every pin-free reader is done with. Caller must hold the latch.
+   * @return false if there is none
+   */
+  auto ReclaimRetiredFrame(frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Let pin-free readers release the retired frames after GetReplaceFrameId found no frame: drop the latch for a
+   * moment so that the caller can try again, unless no frame is retired or the caller tried often enough already.
+   * @param lock the held latch, released and taken again
+   * @param round how many times the caller waited before
+   * @return false if the caller should give up, as for a pool with every frame pinned
+   */
+  auto WaitForRetiredFrames(std::unique_lock<std::mutex> *lock, int round) -> bool;
+
+  /** @brief Count a hit on frame_id by a reader that does not pin the frame. */
+  void RecordPinFreeHit(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * @brief Fill a frame with a page that is not in the buffer pool, from the compressed page cache if it is there and
+   * from disk otherwise. Caller must hold the latch.
+   * @return false if the page read from disk failed its checksum
+   */
+  auto ReadPageIntoFrame(frame_id_t frame_id, page_id_t page_id) -> bool;
+
+  /** @return true if a page read from disk passes its checksum, or checksums are not verified; counts failures */
+  auto VerifyPage(page_id_t page_id, const char *page_data) -> bool;
+
+  /**
+   * @brief Load page_id into frame_id with a zeroed page and fresh metadata. Caller must hold the latch.
+   * @param frame_id the frame to reset
+   * @param page_id the page the frame will hold
+   */
+  void ResetFrame(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * @brief Write the page held in frame_id to disk and clear its dirty flag. The page is copied under its read latch,
+   * so either the frame is unpinned and the caller holds the latch, or the caller pinned the frame and does not.
+   */
+  void WritePageToDisk(frame_id_t frame_id);
+
+  /**
+   * @brief Pin frame_id for a write-back without recording an access: the write must not look like a use of the page to
+   * the replacer. Caller must hold the latch.
+   */
+  void PinForWriteBack(frame_id_t frame_id);
+
+  /**
+   * @brief Clear the dirty flag of the page in frame_id, copy the page into data under its read latch and stamp the
+   * copy with its checksum.
+   */
+  void CopyForWriteBack(frame_id_t frame_id, page_id_t page_id, char *data);
+
+  /**
+   * @brief Pin the page held in frame_id so that the replacer will not evict it, and record the access in the
+   * replacer. Caller must hold the latch.
+   */
+  void PinFrame(frame_id_t frame_id, AccessType access_type);
+
+  /**
+   * @brief Pin frame_id without the latch. Only succeeds if the frame is already pinned, because a pinned frame can
+   * not be evicted while we do so.
+   * @return true if the frame was pinned
+   */
+  auto TryPinFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Unpin frame_id without the latch. Only succeeds if this is not the last pin, because the last unpin has to
+   * hand the frame to the replacer.
+   * @return true if the frame was unpinned
+   */
+  auto TryUnpinFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Unpin frame_id, making it evictable on the last unpin. Caller must hold the latch.
+   * @return false if the frame was not pinned
+   */
+  auto UnpinFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Body of the background writer thread: write back dirty pages until StopBackgroundWriter is called, and
+   * sleep for bg_writer_interval whenever there was nothing to write.
+   */
+  void RunBackgroundWriter();
+
+  /**
+   * @brief One round of the background writer. The chosen frames are pinned under the latch so that they cannot be
+   * evicted and read back from disk before their write lands, and are written without the latch.
+   * @param forced write a batch even if enough frames are clean, because a foreground eviction still hit a dirty page
+   * @return the number of pages written back
+   */
+  auto WriteBackDirtyFrames(bool forced) -> size_t;
+
+  /** @brief Body of the prefetch thread: load queued pages until the buffer pool is destroyed. */
+  void RunPrefetcher();
+
+  /**
+   * @brief Load pages into unpinned frames, recording scan accesses, with a single ReadPages call. Resident pages are
+   * skipped, and the batch stops early when no frame can be reused.
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids);
+
+  /** @brief Set the dirty flag of a pinned frame if is_dirty is true. */
+  void MarkDirty(frame_id_t frame_id, bool is_dirty);
+
+  /**
+   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @param page_id id of the page to deallocate
+   */
+  void DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+};
+}  // namespace bustub
@@ -0,0 +1,158 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * StatsCounter is a counter for events that happen on every page access, like buffer pool hits. Threads add to one of
+ * STATS_COUNTER_SLOTS cache-line-sized slots, picked once per thread, instead of all bumping the same word. Reading
+ * the counter sums the slots, so it is cheap to update and comparatively expensive to read.
+ */
+class StatsCounter {
+ public:
+  void Add(size_t n = 1) { slots_[GetSlot()].value_.fetch_add(n, std::memory_order_relaxed); }
+
+  auto Load() const -> size_t {
+    size_t sum = 0;
+    for (const auto &slot : slots_) {
+      sum += slot.value_.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  static constexpr size_t STATS_COUNTER_SLOTS = 16;
+
+  struct alignas(64) Slot {
+    std::atomic<size_t> value_{0};
+  };
+
+  /** @return the slot of the calling thread; threads are assigned slots round robin */
+  static auto GetSlot() -> size_t {
+    static std::atomic<size_t> next_slot{0};
+    thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % STATS_COUNTER_SLOTS;
+    return slot;
+  }
+
+  Slot slots_[STATS_COUNTER_SLOTS];
+};
+
+/**
+ * A snapshot of the counters of a buffer pool, summed over its instances for a parallel buffer pool. The counters are
+ * read one at a time while the pool keeps running, so they are not exactly consistent with each other.
+ */
+struct BufferPoolStats {
+  /** Number of frames. */
+  size_t pool_size_{0};
+  /** Fetches served from a frame. */
+  size_t hits_{0};
+  /** Fetches that read the page from disk. */
+  size_t misses_{0};
+  /** Pages pushed out of their frame to make room for another page. */
+  size_t evictions_{0};
+  /** Dirty victims NewPage and FetchPage had to write back before reusing their frame. */
+  size_t dirty_write_backs_{0};
+  /** Dirty pages written back by the background writer. */
+  size_t background_writes_{0};
+  /** NewPage and FetchPage calls that failed because every frame was pinned. */
+  size_t all_pinned_{0};
+  /** Times a thread had to wait for the latch of an instance. */
+  size_t latch_waits_{0};
+  /** Pages loaded by Prefetch. */
+  size_t prefetches_{0};
+  /** Pages read from the mapping of the database file instead of a frame. */
+  size_t mapped_reads_{0};
+  /** Pages read from disk that failed their checksum. */
+  size_t checksum_failures_{0};
+  /** Capacity of the compressed page cache in bytes, 0 if it is off. */
+  size_t compressed_cache_capacity_{0};
+  /** Compressed bytes held by the compressed page cache. */
+  size_t compressed_cache_size_{0};
+  /** Pages held by the compressed page cache. */
+  size_t compressed_cache_pages_{0};
+  /** Misses served from the compressed page cache instead of the disk. */
+  size_t compressed_cache_hits_{0};
+  /** Misses that were not in the compressed page cache either. */
+  size_t compressed_cache_misses_{0};
+
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats &;
+
+  /** @return hits / (hits + misses), 0 if nothing was fetched */
+  auto GetHitRate() const -> double;
+
+  /** @return the fraction of misses the compressed page cache served, 0 if it was never asked */
+  auto GetCompressedCacheHitRate() const -> double;
+
+  /** @return the counters as (name, value) pairs, in declaration order */
+  auto ToPairs() const -> std::vector<std::pair<std::string, std::string>>;
+
+  auto ToString() const -> std::string;
+};
+
+/**
+ * PageHeatMap counts accesses per page id, sampling one in every sample_interval accesses of each thread so that it
+ * can stay on under load. Sampling is off (interval 0) until SetSampleInterval is called; a disabled heat map costs
+ * one relaxed load per access.
+ */
+class PageHeatMap {
+ public:
+  /**
+   * @brief Sample one access in every interval. 0 turns sampling off; the samples taken so far are kept.
+   */
+  void SetSampleInterval(size_t interval) { sample_interval_.store(interval, std::memory_order_relaxed); }
+
+  auto GetSampleInterval() const -> size_t { return sample_interval_.load(std::memory_order_relaxed); }
+
+  void RecordAccess(page_id_t page_id) {
+    const size_t interval = sample_interval_.load(std::memory_order_relaxed);
+    if (interval == 0) {
+      return;
+    }
+    thread_local size_t countdown = 0;
+    if (countdown > 0) {
+      countdown--;
+      return;
+    }
+    countdown = interval - 1;
+    Sample(page_id);
+  }
+
+  /**
+   * @param n the number of pages to return
+   * @return the n pages with the most sampled accesses and their sample counts, hottest first
+   */
+  auto GetHottest(size_t n) const -> std::vector<std::pair<page_id_t, size_t>>;
+
+  /** @brief Forget every sample. */
+  void Reset();
+
+ private:
+  void Sample(page_id_t page_id);
+
+  std::atomic<size_t> sample_interval_{0};
+  mutable std::mutex latch_;
+  std::unordered_map<page_id_t, size_t> samples_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_ring.h
+//
+// Identification: src/include/buffer/buffer_ring.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+class BufferPoolManagerInstance;
+
+/**
+ * BufferRing confines a large sequential operation, like a table scan, an index backfill or a bulk load, to a small
+ * set of frames that it recycles, so that the operation does not push everybody else's pages out of the buffer pool.
+ *
+ * Pages the operation fetches or creates with the ring take frames from the pool as usual until the ring holds
+ * num_frames of them. After that, every further miss reuses the oldest frame of the ring, provided nobody has it
+ * pinned and it still holds the page the ring put there; otherwise the ring takes a fresh frame in its place. Hits
+ * never touch the ring. In a parallel buffer pool every instance keeps its own share of the ring. A ring never gets
+ * more than 1/BUFFER_RING_MAX_POOL_FRACTION of the frames of an instance.
+ *
+ * A ring belongs to one operation and must not be shared between threads.
+ */
+class BufferRing {
+ public:
+  /** @param num_frames the number of frames the ring recycles */
+  explicit BufferRing(size_t num_frames) : num_frames_(num_frames) {}
+
+  /** @return a ring of num_bytes worth of frames, e.g. SCAN_RING_BYTES */
+  static auto OfBytes(size_t num_bytes) -> BufferRing { return BufferRing(num_bytes / BUSTUB_PAGE_SIZE); }
+
+  /** @return the number of frames the ring recycles */
+  auto GetNumFrames() const -> size_t { return num_frames_; }
+
+ private:
+  friend class BufferPoolManagerInstance;
+
+  /** A frame of the ring and the page the ring last put in it. */
+  struct Slot {
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+  };
+
+  /** The part of the ring in one buffer pool instance. */
+  struct InstanceRing {
+    std::vector<Slot> slots_;
+    /** The slot the next miss recycles once the ring is full. */
+    size_t next_{0};
+  };
+
+  size_t num_frames_;
+  std::unordered_map<const BufferPoolManagerInstance *, InstanceRing> rings_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.h
+//
+// Identification: src/include/buffer/clock_pro_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ClockProReplacer implements the CLOCK-Pro policy (Jiang, Chen and Zhang).
+ *
+ * Resident pages are hot or cold. A newly loaded cold page starts a test period; if it is accessed again before its
+ * test period ends it becomes hot. Cold pages evicted during their test period stay in the clock as non-resident
+ * entries, and a page loaded again while non-resident starts out hot. All pages share one clock with three hands:
+ *  - HAND_cold evicts cold pages without a reference, and promotes or re-tests referenced ones;
+ *  - HAND_hot demotes hot pages without a reference to cold, ending the test periods it passes;
+ *  - HAND_test ends test periods and forgets non-resident pages when there are more than capacity of them.
+ * The target number of cold pages adapts: it grows on every access to a non-resident page and shrinks whenever a
+ * test period ends without one.
+ *
+ * Scan accesses never set reference bits, and scanned pages do not start a test period, so a scan cannot make pages
+ * hot.
+ */
+class ClockProReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ClockProReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ClockProReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ClockProReplacer);
+
+  ~ClockProReplacer() override = default;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+ private:
+  struct Entry {
+    /** The page id, or the frame id if the page id is unknown. */
+    page_id_t key_;
+    /** The frame holding the page, -1 for a non-resident page. */
+    frame_id_t frame_id_;
+    bool hot_{false};
+    bool ref_{false};
+    bool in_test_{false};
+    bool is_evictable_{false};
+  };
+  using Iter = std::list<Entry>::iterator;
+
+  /** @return the entry after it, wrapping around the clock */
+  auto Next(Iter it) -> Iter;
+
+  /** @brief Insert a new entry at the head of the clock, which is just behind HAND_hot. */
+  auto InsertAtHead(Entry entry) -> Iter;
+
+  /** @brief Move an entry to the head of the clock. */
+  void MoveToHead(Iter it);
+
+  /** @brief Erase an entry, moving any hand that points at it to the next entry. */
+  void Erase(Iter it);
+
+  /** @brief Advance HAND_hot until it demotes one hot page. */
+  void RunHandHot();
+
+  /** @brief Advance HAND_test until it forgets one non-resident page. */
+  void RunHandTest();
+
+  /** @return the maximum number of hot pages */
+  auto HotLimit() const -> size_t { return capacity_ - cold_target_; }
+
+  std::list<Entry> clock_;
+  std::unordered_map<frame_id_t, Iter> resident_;
+  std::unordered_map<page_id_t, Iter> non_resident_;
+  Iter hand_hot_;
+  Iter hand_cold_;
+  Iter hand_test_;
+  size_t capacity_;
+  /** Target number of resident cold pages, between 1 and capacity_ - 1. */
+  size_t cold_target_;
+  size_t num_hot_{0};
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
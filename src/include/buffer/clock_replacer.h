@@ -12,26 +12,19 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
 #include <vector>
-#include <iostream>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
 
 namespace bustub {
 
-
-struct FrameInfo {
-  bool ref_;
-  bool in_clock_;
-  size_t frame_id_;
-};
-
-
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The clock has one slot per frame id. An access sets the frame's reference bit; the hand sweeps over the evictable
+ * frames, clearing reference bits, and evicts the first evictable frame whose bit is already clear.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -46,26 +39,30 @@ class ClockReplacer : public Replacer {
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Pin(frame_id_t frame_id) override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
-private:
+ private:
+  struct FrameInfo {
+    bool tracked_{false};
+    bool ref_{false};
+    bool is_evictable_{false};
+  };
 
-  void MoveFrameIndex(size_t from_index, size_t to_index); /* Moves frame in clock_. */
-  
-  int GetFrameIndex(frame_id_t frame_id); /* Get's index in clock_ of frame_id. */
-  
   std::vector<FrameInfo> clock_;
-  size_t num_pages_;
-  size_t size_; /* Num frames that can be victimised. */
-  uint32_t head_; /* Points to index that clock is currently
-                     considering. */
-
+  /** Num frames that can be victimised. */
+  size_t size_{0};
+  /** Points to index that clock is currently considering. */
+  size_t head_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageCodec is a byte-oriented LZ77 compressor in the style of the LZ4 block format: a stream of sequences, each a
+ * token with the lengths of a literal run and of the match that follows it, the literals, and a two-byte match offset.
+ * It compresses a 4 KiB page in a few microseconds, and does well on what database pages are mostly made of: zeroed
+ * free space, repeated key prefixes and small integers.
+ */
+class PageCodec {
+ public:
+  /**
+   * @brief Compress size bytes of src.
+   * @param[out] out the compressed bytes
+   * @param max_size give up once the output would reach this many bytes
+   * @return false if the output would not have been smaller than max_size
+   */
+  static auto Compress(const char *src, size_t size, std::string *out, size_t max_size) -> bool;
+
+  /**
+   * @brief Decompress what Compress produced.
+   * @param size the number of bytes Compress was given, which is the number of bytes written to dst
+   * @return false if src is not a valid compressed buffer of size bytes
+   */
+  static auto Decompress(const char *src, size_t src_size, char *dst, size_t size) -> bool;
+};
+
+/**
+ * CompressedPageCache is the second tier below the frames of a buffer pool: it keeps pages that were evicted, clean,
+ * compressed with PageCodec, so that a miss on a warm page costs a decompression instead of a disk read. The cache is
+ * exclusive of the buffer pool: taking a page out of the cache removes it, since the frame now holds the page and may
+ * change it. Pages are dropped least recently inserted first once the compressed bytes exceed the capacity, and pages
+ * that do not compress are not kept at all.
+ *
+ * Not thread-safe; the buffer pool calls it under its latch. The counters may be read concurrently.
+ */
+class CompressedPageCache {
+ public:
+  /** @param capacity the number of compressed bytes the cache may hold */
+  explicit CompressedPageCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * @brief Keep a copy of a clean page that is being evicted, dropping older pages if needed.
+   * @return true if the page was stored
+   */
+  auto Insert(page_id_t page_id, const char *data) -> bool;
+
+  /**
+   * @brief Move a page out of the cache into data.
+   * @return true if the page was in the cache
+   */
+  auto Take(page_id_t page_id, char *data) -> bool;
+
+  /** @brief Forget a page, e.g. because it was deleted or rewritten behind the cache. */
+  void Erase(page_id_t page_id);
+
+  auto GetCapacity() const -> size_t { return capacity_; }
+
+  /** @return the number of compressed bytes held */
+  auto GetSize() const -> size_t { return size_.load(std::memory_order_relaxed); }
+
+  /** @return the number of pages held */
+  auto GetPageCount() const -> size_t { return num_pages_.load(std::memory_order_relaxed); }
+
+  /** @return the number of Take calls that found their page */
+  auto GetHitCount() const -> size_t { return num_hits_.load(std::memory_order_relaxed); }
+
+  /** @return the number of Take calls that did not */
+  auto GetMissCount() const -> size_t { return num_misses_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Entry {
+    page_id_t page_id_;
+    std::string data_;
+  };
+
+  void Remove(std::list<Entry>::iterator it);
+
+  const size_t capacity_;
+  /** Newest first. */
+  std::list<Entry> entries_;
+  std::unordered_map<page_id_t, std::list<Entry>::iterator> index_;
+  std::atomic<size_t> size_{0};
+  std::atomic<size_t> num_pages_{0};
+  std::atomic<size_t> num_hits_{0};
+  std::atomic<size_t> num_misses_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.h
+//
+// Identification: src/include/buffer/epoch_manager.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace bustub {
+
+/**
+ * EpochManager lets readers find buffer pool frames without pinning them. A reader enters the current epoch before it
+ * looks a page up, and exits once something else keeps the frame on its page, like the page latch. A frame whose page
+ * is evicted is retired with the epoch in which it was dropped from the page table, and the buffer pool only reuses
+ * it once every reader that entered in that epoch or earlier has exited. Readers should stay inside an epoch for a few
+ * instructions only, and never while they wait for I/O or a latch, since they hold up the reuse of every evicted frame.
+ *
+ * Entering and exiting touch one of EPOCH_SLOTS cache-line-sized slots, picked once per thread, instead of the pin
+ * count of every page on the way. Threads beyond EPOCH_SLOTS share slots; a shared slot keeps the epoch of its oldest
+ * reader until all of them have exited, which only delays reuse.
+ */
+class EpochManager {
+ public:
+  /** Returned by GetOldestActiveEpoch when no reader is inside an epoch. */
+  static constexpr uint64_t NO_ACTIVE_EPOCH = std::numeric_limits<uint64_t>::max();
+  /** Number of slots readers are spread over; threads beyond it share slots. */
+  static constexpr size_t EPOCH_SLOTS = 64;
+
+  /**
+   * @brief Enter the current epoch. Frames found from now on stay allocated to their page or retired until Exit.
+   * Can be nested.
+   * @return the slot to pass to Exit
+   */
+  auto Enter() -> size_t {
+    const size_t slot = GetSlot();
+    auto &state = slots_[slot].state_;
+    uint64_t current = state.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+      next = (current & READERS_MASK) == 0 ? (epoch_.load(std::memory_order_seq_cst) << EPOCH_SHIFT) | 1 : current + 1;
+    } while (!state.compare_exchange_weak(current, next, std::memory_order_seq_cst, std::memory_order_relaxed));
+    // the lookups that follow must not move above the published epoch
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return slot;
+  }
+
+  /** @brief Leave the epoch entered by the matching Enter. */
+  void Exit(size_t slot) { slots_[slot].state_.fetch_sub(1, std::memory_order_release); }
+
+  /**
+   * @brief Start a new epoch. Call after the frame to retire has been dropped from the page table.
+   * @return the epoch that ended: the frame can be reused once it is older than GetOldestActiveEpoch()
+   */
+  auto Advance() -> uint64_t { return epoch_.fetch_add(1, std::memory_order_seq_cst); }
+
+  /** @return the epoch of the oldest reader that has not exited yet, NO_ACTIVE_EPOCH if there is none */
+  auto GetOldestActiveEpoch() const -> uint64_t;
+
+ private:
+  /** The low bits of a slot count its readers, the high bits hold the epoch the first of them entered. */
+  static constexpr int EPOCH_SHIFT = 16;
+  static constexpr uint64_t READERS_MASK = (1ULL << EPOCH_SHIFT) - 1;
+
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> state_{0};
+  };
+
+  /** @return the slot of the calling thread; threads are assigned slots round robin */
+  static auto GetSlot() -> size_t {
+    static std::atomic<size_t> next_slot{0};
+    thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % EPOCH_SLOTS;
+    return slot;
+  }
+
+  alignas(64) std::atomic<uint64_t> epoch_{1};
+  Slot slots_[EPOCH_SLOTS];
+};
+
+}  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** How the frames of a buffer pool are laid out in memory. */
+struct FrameArenaOptions {
+  /** Back the arena with 2 MB pages: MAP_HUGETLB if the system has huge pages reserved, transparent ones otherwise. */
+  bool huge_pages_{false};
+  /** Place the frames on the NUMA nodes of the machine instead of wherever the first touch lands. */
+  bool numa_aware_{false};
+};
+
+/**
+ * FrameArena holds the page buffers of every frame of a buffer pool in one anonymous mapping, aligned to
+ * FRAME_ARENA_ALIGNMENT, instead of one heap block per frame. Frame i starts at i * BUSTUB_PAGE_SIZE.
+ *
+ * When NUMA-aware, the arena of one instance of a parallel buffer pool is bound to node instance_index % nodes, so
+ * that each instance lives on one node. A stand-alone buffer pool is split into one contiguous partition per node
+ * instead. Placement is a preference: the kernel falls back to other nodes when one runs out of memory.
+ */
+class FrameArena {
+ public:
+  /**
+   * @brief Map an arena for num_frames frames. Pages are zeroed by the kernel.
+   * @param num_frames the number of frames
+   * @param options huge page and NUMA settings
+   * @param num_instances the number of instances in the parallel buffer pool the arena belongs to, or 1
+   * @param instance_index the index of that instance
+   */
+  FrameArena(size_t num_frames, const FrameArenaOptions &options, size_t num_instances = 1, size_t instance_index = 0);
+
+  ~FrameArena();
+
+  FrameArena(const FrameArena &) = delete;
+  auto operator=(const FrameArena &) -> FrameArena & = delete;
+
+  /** @return the page buffer of frame_id */
+  auto GetFrame(frame_id_t frame_id) -> char * {
+    return data_ + static_cast<size_t>(frame_id) * BUSTUB_PAGE_SIZE;
+  }
+
+  /** @return the NUMA node frame_id was placed on, or -1 if the arena is not NUMA-aware */
+  auto GetNode(frame_id_t frame_id) const -> int;
+
+  /** @return true if the arena is backed by MAP_HUGETLB pages or was advised to use transparent huge pages */
+  auto UsesHugePages() const -> bool { return huge_pages_; }
+
+  /** @return the number of NUMA nodes of the machine, 1 if it has no NUMA information */
+  static auto GetNumNodes() -> size_t;
+
+ private:
+  /** Bind the bytes [begin, end) of the arena to node with a preferred memory policy. */
+  void BindToNode(size_t begin, size_t end, int node);
+
+  char *data_{nullptr};
+  /** Size of the mapping, a whole number of FRAME_ARENA_ALIGNMENT blocks. */
+  size_t size_{0};
+  bool huge_pages_{false};
+  /** Byte offset of each node's partition, in order; empty if the arena is not NUMA-aware. */
+  std::vector<size_t> partition_begin_;
+  /** Node of each partition in partition_begin_. */
+  std::vector<int> partition_node_;
+};
+
+}  // namespace bustub
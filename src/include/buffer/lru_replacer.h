@@ -14,40 +14,13 @@
 
 #include <list>
 #include <mutex>  // NOLINT
-#include <vector>
+#include <unordered_map>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
-#include <deque>
-#include <vector>
 
 namespace bustub {
 
-
-class FrameInfo {
-  public:
-    
-    FrameInfo(frame_id_t id);
-
-    ~FrameInfo();
-    
-    void IncPins();
-    
-    void DecPins();
-
-    frame_id_t GetFrameID();
-
-    unsigned int GetNumPins();
-  
-  private:
-    unsigned int pins;
-
-    frame_id_t frame_id;
-};
-
-
-
-
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
  */
@@ -64,37 +37,30 @@ class LRUReplacer : public Replacer {
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
-
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  auto Size() -> size_t override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Delete(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
+  auto Size() -> size_t override;
 
  private:
-  std::mutex replacer_mutex;
-
-  std::deque<FrameInfo*> lru_queue;
-
-  std::vector<FrameInfo*> used_vec;
-
-  FrameInfo *GetFrameInfoUsed(frame_id_t frame_id);
-
-  FrameInfo *GetFrameInfoQueue(frame_id_t frame_id);
-
-  void AddUsed(FrameInfo *frame_info);
-
-  void RemoveUsed(frame_id_t frame_id);
-
-  void PushQueue(FrameInfo *frame_info);
-
-  FrameInfo *PopQueue();
-
-  void RemoveQueue(frame_id_t frame_id);
+  struct FrameInfo {
+    /** Position of the frame in lru_list_. */
+    std::list<frame_id_t>::iterator pos_;
+    bool is_evictable_{false};
+  };
+
+  /** Tracked frames, least recently used first. */
+  std::list<frame_id_t> lru_list_;
+  std::unordered_map<frame_id_t, FrameInfo> frames_;
+  size_t num_pages_;
+  size_t curr_size_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps page ids to frame ids for one buffer pool instance.
+ *
+ * It is a fixed-capacity, open-addressing hash table with linear probing. Every slot is a single 64-bit atomic word
+ * holding both the page id and the frame id, so Find() can run concurrently with writers without taking a latch.
+ * Writers (Insert, Erase) must be serialized by the caller, which the buffer pool does with its latch.
+ *
+ * A lock-free Find() may miss an entry that is being inserted, or any entry while the table is compacting its
+ * tombstones. Callers must treat a miss as "not known" and retry under the latch before concluding that the page is
+ * absent. A hit is never stale by more than the frame it names, which the buffer pool re-validates after pinning.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Create a page table able to hold num_frames entries.
+   * @param num_frames the number of frames in the buffer pool
+   */
+  explicit PageTable(size_t num_frames);
+
+  ~PageTable() = default;
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * @brief Look up the frame holding page_id. Safe to call without any latch.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page, if found
+   * @return true if the page was found
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id) const -> bool;
+
+  /**
+   * @brief Map page_id to frame_id. The page must not already be in the table. Caller must serialize writers.
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @brief Remove page_id from the table. Caller must serialize writers.
+   * @return true if the page was in the table
+   */
+  auto Erase(page_id_t page_id) -> bool;
+
+  /** @return the number of pages in the table */
+  auto Size() const -> size_t { return size_; }
+
+ private:
+  static constexpr uint64_t EMPTY_SLOT = ~static_cast<uint64_t>(0);
+  /** Page id stored in the key half of a deleted slot. It can never collide with a valid page id. */
+  static constexpr page_id_t TOMBSTONE_PAGE_ID = -2;
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto KeyOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the first slot to probe for page_id */
+  auto HomeSlot(page_id_t page_id) const -> size_t;
+
+  /** @brief Clear all tombstones by re-inserting the live entries. */
+  void Compact();
+
+  /** Number of slots, always a power of two and at least twice the number of frames. */
+  size_t capacity_;
+  /** Right shift that turns a 64-bit multiplicative hash into a slot index. */
+  int hash_shift_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  /** Number of live entries. Only written by the (serialized) writers. */
+  size_t size_{0};
+  /** Number of tombstone slots. Only written by the (serialized) writers. */
+  size_t tombstones_{0};
+};
+
+}  // namespace bustub
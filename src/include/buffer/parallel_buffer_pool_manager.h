@@ -0,0 +1,219 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager splits the buffer pool into several independent BufferPoolManagerInstances. Each
+ * instance has its own page table, free list, replacer and latch, so threads working on different pages rarely
+ * contend on the same latch. A page always lives in the instance given by page_id % num_instances.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @brief Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to create
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the replacement policy of every instance
+   * @param arena_options the memory layout of the frames of every instance; NUMA-aware instances are spread over the
+   * nodes round-robin
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRUK,
+                            const FrameArenaOptions &arena_options = {});
+
+  /**
+   * @brief Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @brief Return the total size (number of frames) of all the instances. */
+  auto GetPoolSize() -> size_t override;
+
+  /**
+   * @brief Get the page held by a frame, numbering the frames of the instances one instance after the other.
+   * @param frame_id the frame, in [0, GetPoolSize())
+   */
+  auto GetPage(frame_id_t frame_id) -> Page * override;
+
+  /** The counters below are summed over every instance. */
+  auto GetHitCount() const -> size_t override { return Sum(&BufferPoolManagerInstance::GetHitCount); }
+  auto GetMissCount() const -> size_t override { return Sum(&BufferPoolManagerInstance::GetMissCount); }
+  auto GetContentionCount() const -> size_t override { return Sum(&BufferPoolManagerInstance::GetContentionCount); }
+  auto GetBackgroundWriteCount() const -> size_t override {
+    return Sum(&BufferPoolManagerInstance::GetBackgroundWriteCount);
+  }
+  auto GetForegroundWriteCount() const -> size_t override {
+    return Sum(&BufferPoolManagerInstance::GetForegroundWriteCount);
+  }
+  auto GetChecksumFailureCount() const -> size_t override {
+    return Sum(&BufferPoolManagerInstance::GetChecksumFailureCount);
+  }
+  auto GetPrefetchCount() const -> size_t override { return Sum(&BufferPoolManagerInstance::GetPrefetchCount); }
+  auto GetMappedReadCount() const -> size_t override { return Sum(&BufferPoolManagerInstance::GetMappedReadCount); }
+
+  /** @return the number of BufferPoolManagerInstances */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+  /**
+   * @brief Get the instance at the given index, e.g. to read its hit and contention counters.
+   * @param index the index of the instance, in [0, GetNumInstances())
+   * @return the BufferPoolManagerInstance
+   */
+  auto GetInstance(size_t index) -> BufferPoolManagerInstance * { return instances_[index].get(); }
+
+  /**
+   * @brief Sum the counters of every instance.
+   * @return the counters of the whole buffer pool
+   */
+  auto GetStats() -> BufferPoolStats override;
+
+  /**
+   * @brief Set the heat map sampling interval of every instance.
+   * @param sample_interval the sampling interval, 0 to stop sampling
+   */
+  void SetHeatMapSampleInterval(size_t sample_interval) override;
+
+  /**
+   * @brief Give every instance an equal share of a compressed page cache of capacity bytes.
+   * @param capacity the total number of compressed bytes to keep, 0 to turn the caches off
+   */
+  void SetCompressedCacheCapacity(size_t capacity) override;
+
+  /** @brief Turn checksum verification on or off in every instance. */
+  void SetVerifyChecksums(bool verify) override;
+
+  /** @return true if the instances are read-only; they share one disk manager */
+  auto IsReadOnly() const -> bool override { return instances_.front()->IsReadOnly(); }
+
+  /**
+   * @param n the number of pages to return
+   * @return the n hottest pages across all instances, hottest first
+   */
+  auto GetHottestPages(size_t n) -> std::vector<std::pair<page_id_t, size_t>> override;
+
+  /**
+   * @brief Start the background writer of every instance.
+   * @param clean_target the number of reusable clean frames to keep in total, split evenly across the instances
+   */
+  void StartBackgroundWriter(size_t clean_target) override;
+
+  /**
+   * @brief Stop the background writer of every instance.
+   */
+  void StopBackgroundWriter() override;
+
+  /**
+   * @brief Hand each page to the prefetch thread of the instance responsible for it.
+   * @param page_ids the pages to load, in the order they will be read
+   */
+  void Prefetch(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * @brief Create a new page. Instances are tried round robin, starting one past the instance that served the
+   * previous call, until one of them has a free or evictable frame. With a hint, the instance that owns the hint is
+   * tried first, since only its page ids can be next to the hint.
+   * @param[out] page_id id of created page
+   * @param hint a page to place the new page close to, or INVALID_PAGE_ID
+   * @param ring the ring of a bulk operation, or nullptr
+   * @return nullptr if no instance could create a page, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id, page_id_t hint = INVALID_PAGE_ID, BufferRing *ring = nullptr) -> Page * override;
+
+  /**
+   * @brief Fetch the requested page from the instance responsible for it.
+   * @param page_id id of page to be fetched
+   * @param access_type type of access to the page
+   * @param ring the ring of a large sequential operation, or nullptr
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown, BufferRing *ring = nullptr)
+      -> Page * override;
+
+  /**
+   * @brief Read a page from the mapping of the database file, through the instance responsible for it.
+   * @param page_id id of page to be read
+   * @return a mapped guard, or an empty guard if the page has to be fetched into a frame
+   */
+  auto FetchPageMapped(page_id_t page_id) -> ReadPageGuard override;
+
+  /**
+   * @brief Fetch a page for an optimistic read from the instance responsible for it.
+   * @param page_id id of page to be read
+   * @return an OptimisticReadGuard for the page, empty if page_id cannot be fetched
+   */
+  auto FetchPageOptimistic(page_id_t page_id) -> OptimisticReadGuard override;
+
+  /**
+   * @brief Fetch a page for a pin-free read from the instance responsible for it.
+   * @param page_id id of page to be read
+   * @return an EpochReadGuard for the page, empty if page_id cannot be fetched
+   */
+  auto FetchPageEpoch(page_id_t page_id) -> EpochReadGuard override;
+
+  /**
+   * @brief Unpin the target page from the instance responsible for it.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @param access_type type of access to the page
+   * @return false if the page is not in the page table or its pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool override;
+
+  /**
+   * @brief Flush the target page to disk through the instance responsible for it.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPage(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Flush all the pages of every instance to disk.
+   */
+  void FlushAllPages() override;
+
+  /**
+   * @brief Delete a page from the instance responsible for it.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePage(page_id_t page_id) -> bool override;
+
+ private:
+  /** @return the instance that owns page_id */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /** @return the sum of counter over every instance */
+  auto Sum(size_t (BufferPoolManagerInstance::*counter)() const) const -> size_t;
+
+  /** The individual buffer pool instances. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** Index of the instance the next NewPage call starts from. */
+  std::atomic<size_t> next_instance_{0};
+};
+}  // namespace bustub
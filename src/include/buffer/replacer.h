@@ -12,12 +12,24 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+
 #include "common/config.h"
 
 namespace bustub {
 
+enum class AccessType { Unknown = 0, Get, Scan };
+
+/** The replacement policies a BufferPoolManager can be built with. */
+enum class ReplacerPolicy { LRU = 0, Clock, LRUK, ARC, TwoQ, ClockPro };
+
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks frame usage and picks frames to evict.
+ *
+ * The buffer pool calls RecordAccess whenever it pins a frame, marks a frame evictable when its pin count drops to
+ * zero, and asks for a victim with Evict when it needs a frame. Frames that are not evictable are never returned by
+ * Evict. Size() is the number of evictable frames.
  */
 class Replacer {
  public:
@@ -25,26 +37,52 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
-   * @return true if a victim frame was found, false otherwise
+   * @brief Record that frame_id was accessed. Starts tracking the frame, as non-evictable, if it is not tracked yet.
+   *
+   * @param frame_id id of frame that received a new access
+   * @param access_type type of the access. Policies use AccessType::Scan to keep sequential scans from pushing
+   * frequently used frames out.
+   * @param page_id the page held by the frame. Policies that remember evicted pages (ARC, 2Q, CLOCK-Pro) use it to
+   * recognize a page coming back; if it is INVALID_PAGE_ID the frame id stands in for it.
+   */
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                            page_id_t page_id = INVALID_PAGE_ID) = 0;
+
+  /**
+   * @brief Toggle whether a tracked frame may be evicted. Untracked frames are ignored.
+   * @param frame_id id of frame whose 'evictable' status will be modified
+   * @param set_evictable whether the given frame is evictable or not
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * @brief Evict a frame as defined by the replacement policy and stop tracking it.
+   * @param[out] frame_id id of frame that was evicted
+   * @return true if a victim frame was found, false otherwise
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * @brief Stop tracking an evictable frame, e.g. because its page was deleted. The page is not remembered as
+   * evicted. Does nothing if the frame is not tracked; throws if the frame is not evictable.
+   * @param frame_id id of frame to be removed
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
-  /** @return the number of elements in the replacer that can be victimized */
+  /** @return the number of frames in the replacer that can be evicted */
   virtual auto Size() -> size_t = 0;
 };
 
+/**
+ * @brief Create a replacer implementing the given policy.
+ * @param policy the replacement policy
+ * @param num_frames the number of frames the replacer will be required to track
+ * @param k the lookback constant for LRU-K; ignored by the other policies
+ * @return the replacer
+ */
+auto MakeReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer>;
+
+/** @return the short name of a policy, e.g. "lru-k" */
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string;
+
 }  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full 2Q policy (Johnson and Shasha).
+ *
+ * A newly loaded page goes to the FIFO queue A1in. Frames evicted from A1in are remembered in the ghost queue A1out;
+ * a page that is loaded again while it is in A1out has proven itself and goes to the LRU queue Am. Hits in A1in do
+ * not promote, since they are usually correlated with the first access. Evict takes from A1in while it holds more
+ * than Kin frames, and from Am otherwise.
+ *
+ * Frames that were only ever scanned are not remembered in A1out, so a repeated scan never reaches Am.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new TwoQueueReplacer with Kin = 25% and Kout = 50% of the frames, as suggested by the paper.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit TwoQueueReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+ private:
+  struct FrameInfo {
+    bool in_am_;
+    std::list<frame_id_t>::iterator pos_;
+    /** The page id, or the frame id if the page id is unknown. Moves to A1out on eviction from A1in. */
+    page_id_t key_;
+    bool scan_only_;
+    bool is_evictable_{false};
+  };
+
+  /** @brief Evict the first evictable frame of A1in or Am, if any. */
+  auto EvictFrom(bool from_am, frame_id_t *frame_id) -> bool;
+
+  /** FIFO of frames seen once, oldest first. */
+  std::list<frame_id_t> a1in_;
+  /** LRU of frames seen again after leaving A1in, least recently used first. */
+  std::list<frame_id_t> am_;
+  /** Ghost FIFO of pages evicted from A1in, oldest first. */
+  std::list<page_id_t> a1out_;
+  std::unordered_map<frame_id_t, FrameInfo> frames_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> ghosts_;
+  size_t capacity_;
+  size_t kin_;
+  size_t kout_;
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -211,12 +211,32 @@ class BustubInstance {
   auto MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext>;
 
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Create a BusTub instance backed by a database file.
+   * @param db_file_name the database file
+   * @param bpm_instances number of buffer pool instances; more than one creates a ParallelBufferPoolManager
+   * @param pool_size number of frames of each buffer pool instance
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t bpm_instances = 1,
+                          size_t pool_size = DEFAULT_INSTANCE_POOL_SIZE);
 
-  BustubInstance();
+  /**
+   * Create an in-memory BusTub instance.
+   * @param bpm_instances number of buffer pool instances; more than one creates a ParallelBufferPoolManager
+   * @param pool_size number of frames of each buffer pool instance
+   */
+  explicit BustubInstance(size_t bpm_instances = 1, size_t pool_size = DEFAULT_INSTANCE_POOL_SIZE);
 
   ~BustubInstance();
 
+  /**
+   * Parse the value of a --pool-size command line flag.
+   * @param arg the value, a positive decimal number of frames
+   * @return the number of frames
+   * @throws Exception with a usage message if arg is not a positive number
+   */
+  static auto ParsePoolSize(const std::string &arg) -> size_t;
+
   /**
    * Execute a SQL query in the BusTub instance.
    */
@@ -270,6 +290,8 @@ class BustubInstance {
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
+  void CmdDisplayBufferPoolStats(ResultWriter &writer);
+  void CmdSetHeatMap(const std::string &sql, ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
   std::unordered_map<std::string, std::string> session_variables_;
 };
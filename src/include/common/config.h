@@ -27,15 +27,42 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** A running background writer checks the clean frames of its buffer pool every BG_WRITER_INTERVAL. */
+extern std::chrono::milliseconds bg_writer_interval;
+
+// The page size is picked at build time with cmake -DBUSTUB_PAGE_SIZE=<bytes>, since every page layout derives its
+// capacity from it. A database file records the page size it was created with, see DiskManager.
+#ifndef BUSTUB_PAGE_SIZE_BYTES
+#define BUSTUB_PAGE_SIZE_BYTES 4096  // NOLINT
+#endif
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
-static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_PAGE_SIZE = BUSTUB_PAGE_SIZE_BYTES;                      // size of a data page in byte
+static constexpr int BUSTUB_PAGE_CHECKSUM_SIZE = 4;  // bytes at the end of every page that hold its checksum
+static constexpr int BUSTUB_PAGE_DATA_SIZE = BUSTUB_PAGE_SIZE - BUSTUB_PAGE_CHECKSUM_SIZE;  // bytes layouts may use
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int BG_WRITER_BATCH_SIZE = 64;  // max pages written back in one round of the background writer
+static constexpr int RETIRED_FRAME_WAIT_ROUNDS = 1024;  // times a fetch drops the latch for readers to free a frame
+static constexpr int FSM_HINT_DISTANCE = 64;     // max distance from an allocation hint for a page to count as near
+static constexpr size_t FRAME_ARENA_ALIGNMENT = 2 * 1024 * 1024;  // alignment of the frame arena, one huge page
+static constexpr size_t DEFAULT_INSTANCE_POOL_SIZE = 128;  // frames per buffer pool instance of a BustubInstance
+static constexpr size_t SCAN_RING_BYTES = 256 * 1024;              // frames a large scan or index backfill recycles
+static constexpr size_t BULK_WRITE_RING_BYTES = 16 * 1024 * 1024;  // frames a bulk load recycles
+static constexpr size_t BUFFER_RING_MAX_POOL_FRACTION = 8;         // a ring gets at most 1/8 of an instance's frames
+static constexpr int BPLUS_TREE_OPTIMISTIC_ATTEMPTS = 4;  // latch-free descents of a lookup before it crabs
+static constexpr double BPLUS_TREE_BULK_LOAD_FILL_FACTOR = 0.9;  // share of a page a bulk load fills
+static constexpr size_t BULK_LOAD_SORT_BYTES = 64 * 1024 * 1024;  // memory an index build sorts in before it spills
+static constexpr size_t INDEX_JOIN_BATCH_SIZE = 1024;  // outer tuples a nested index join probes the index with at once
+
+static_assert(BUSTUB_PAGE_SIZE == 4096 || BUSTUB_PAGE_SIZE == 8192 || BUSTUB_PAGE_SIZE == 16384 ||
+                  BUSTUB_PAGE_SIZE == 32768,
+              "BUSTUB_PAGE_SIZE must be 4K, 8K, 16K or 32K");
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
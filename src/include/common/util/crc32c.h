@@ -0,0 +1,41 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32c computes CRC-32C (Castagnoli), the checksum of iSCSI, ext4 and most storage engines. On x86-64 CPUs with
+ * SSE4.2 it uses the crc32 instruction, at several bytes per cycle; elsewhere it falls back to a lookup table.
+ */
+class Crc32c {
+ public:
+  /**
+   * @param data the bytes to checksum
+   * @param size the number of bytes
+   * @param crc the checksum of the bytes before data, to checksum a buffer in pieces; 0 to start a new checksum
+   * @return the checksum of the bytes so far
+   */
+  static auto Extend(uint32_t crc, const char *data, size_t size) -> uint32_t;
+
+  /** @return the checksum of size bytes of data */
+  static auto Value(const char *data, size_t size) -> uint32_t { return Extend(0, data, size); }
+
+  /** @return true if Extend uses the crc32 instruction */
+  static auto IsHardwareAccelerated() -> bool;
+};
+
+}  // namespace bustub
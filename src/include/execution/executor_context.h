@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -60,6 +61,18 @@ class ExecutorContext {
   /** @return the transaction manager */
   auto GetTransactionManager() -> TransactionManager * { return txn_mgr_; }
 
+  /**
+   * Create a buffer ring for a large sequential operation of one executor, e.g. SCAN_RING_BYTES for a sequential
+   * scan or BULK_WRITE_RING_BYTES for a bulk insert. The ring lives as long as the context; pass it to
+   * TableHeap::Begin or TableHeap::InsertTuple.
+   * @param num_bytes the size of the frames the operation may use
+   * @return the ring
+   */
+  auto MakeBufferRing(size_t num_bytes) -> BufferRing * {
+    buffer_rings_.push_back(std::make_unique<BufferRing>(num_bytes / BUSTUB_PAGE_SIZE));
+    return buffer_rings_.back().get();
+  }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -71,6 +84,8 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The buffer rings handed out by MakeBufferRing */
+  std::vector<std::unique_ptr<BufferRing>> buffer_rings_;
 };
 
 }  // namespace bustub
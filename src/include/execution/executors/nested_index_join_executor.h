@@ -29,6 +29,10 @@ namespace bustub {
 
 /**
  * IndexJoinExecutor executes index join operations.
+ *
+ * The outer tuples are taken from the child INDEX_JOIN_BATCH_SIZE at a time, and the keys of a batch are looked up in
+ * the index in key order with one Index::ScanKeys call, so that neighbouring keys share their way down the index. The
+ * joined tuples still come out in the order of the outer tuples.
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
  public:
@@ -48,7 +52,21 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /**
+   * Join the next batch of outer tuples into results_.
+   * @return false if the child has no more tuples
+   */
+  auto JoinBatch() -> bool;
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  /** The outer table */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The index probed with the join keys, and the inner table it points into */
+  IndexInfo *index_info_{nullptr};
+  TableInfo *inner_table_info_{nullptr};
+  /** The joined tuples of the current batch, and the next one to return */
+  std::vector<Tuple> results_;
+  size_t next_result_{0};
 };
 }  // namespace bustub
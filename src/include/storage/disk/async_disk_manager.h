@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.h
+//
+// Identification: src/include/storage/disk/async_disk_manager.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * AsyncDiskManager reads and writes pages of the database file with preadv/pwritev on a pool of I/O threads, so that
+ * many page requests can be outstanding at once and each one reports completion through a callback. The database file
+ * is opened with O_DIRECT where the file system supports it, which keeps pages out of the OS page cache (the buffer
+ * pool already caches them). The log file is still handled by DiskManager.
+ */
+class AsyncDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param num_workers the number of I/O threads, i.e. how many page requests run at the same time
+   */
+  explicit AsyncDiskManager(const std::string &db_file, size_t num_workers = 4);
+
+  /**
+   * Waits for every outstanding request, then stops the I/O threads and closes the database file.
+   */
+  ~AsyncDiskManager() override;
+
+  /**
+   * Write a page to the database file and wait for the write to finish.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page from the database file and wait for the read to finish. A page past the end of the file reads as
+   * zeros.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Write several pages in the calling thread, with one pwritev per run of adjacent page ids.
+   * @param pages the pages to write, as (page id, raw page data) pairs
+   */
+  void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) override;
+
+  /**
+   * Read several pages in the calling thread, with one preadv per run of adjacent page ids. Pages past the end of the
+   * file read as zeros.
+   * @param pages the pages to read, as (page id, output buffer) pairs
+   */
+  void ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) override;
+
+  /**
+   * Queue a page write. The callback runs on an I/O thread.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay valid until the callback runs
+   * @param callback called with true once the page is written, or with false if the write failed
+   */
+  void WritePageAsync(page_id_t page_id, const char *page_data, std::function<void(bool)> callback) override;
+
+  /**
+   * Queue a page read. The callback runs on an I/O thread.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must stay valid until the callback runs
+   * @param callback called with true once the page is read, or with false if the read failed
+   */
+  void ReadPageAsync(page_id_t page_id, char *page_data, std::function<void(bool)> callback) override;
+
+  /** @return true if the database file was opened with O_DIRECT */
+  auto IsDirectIO() const -> bool { return direct_io_; }
+
+ private:
+  /** One queued page read or write. */
+  struct Request {
+    bool is_write_;
+    page_id_t page_id_;
+    char *data_;
+    std::function<void(bool)> callback_;
+  };
+
+  /** Add a request to the queue and wake up an I/O thread. */
+  void Submit(Request request);
+
+  /** Body of the I/O threads: run queued requests until the disk manager is destroyed. */
+  void RunWorker();
+
+  /**
+   * Read or write count pages with adjacent ids, starting at first_page_id, with preadv/pwritev. With O_DIRECT,
+   * buffers that are not aligned to the page size go through an aligned bounce buffer.
+   * @param is_write true to write the buffers, false to read into them
+   * @param first_page_id the id of the first page
+   * @param buffers one page buffer per page
+   * @param count the number of pages
+   * @return true if every page was transferred (or zero-filled, for reads past the end of the file)
+   */
+  auto TransferRun(bool is_write, page_id_t first_page_id, char *const *buffers, size_t count) -> bool;
+
+  /** File descriptor of the database file used for page I/O, separate from DiskManager's stream. */
+  int fd_{-1};
+  /** True if fd_ was opened with O_DIRECT. */
+  bool direct_io_{false};
+  /** The I/O threads. */
+  std::vector<std::thread> workers_;
+  /** Requests that no I/O thread has picked up yet, oldest first. */
+  std::deque<Request> queue_;
+  /** Set by the destructor once the queue may no longer grow. */
+  bool stop_{false};
+  /** Protects queue_ and stop_. */
+  std::mutex queue_latch_;
+  std::condition_variable queue_cv_;
+};
+
+}  // namespace bustub
@@ -13,37 +13,72 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 
 namespace bustub {
 
+/**
+ * The header page at the start of a database file; page 0 follows it. Its fields sit at the start of the page, so that
+ * a build with any page size can read them.
+ */
+struct DbFileHeader {
+  /** Marks a BusTub database file */
+  static constexpr uint32_t MAGIC = 0x42534442;
+  uint32_t magic_;
+  /** BUSTUB_PAGE_SIZE of the build that created the database file */
+  uint32_t page_size_;
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Which pages are in use is tracked by a free-space map: a bitmap with one bit per page, stored as a chain of bitmap
+ * pages in a file next to the database file (foo.db -> foo.fsm), where bitmap page k covers page ids
+ * [k * BUSTUB_PAGE_SIZE * 8, (k + 1) * BUSTUB_PAGE_SIZE * 8). Pages freed by DeallocatePage are handed out again by
+ * AllocatePage before the database file grows. Allocations are written to the map file right away, before the page
+ * can be written; deallocations change the map in memory only, and the bitmap pages they changed are written by
+ * FlushFreeSpaceMap, which ShutDown and the destructor call. A map that lost deallocations in a crash only leaks pages.
+ *
+ * The database file starts with a DbFileHeader page recording the page size the database was created with. Opening a
+ * database created with a different BUSTUB_PAGE_SIZE throws, rather than reading its pages at the wrong offsets.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @throws Exception if the database file was created with a different page size, or is not a database file
    */
   explicit DiskManager(const std::string &db_file);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  /** Writes the free-space map if it changed since it was last written. */
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
   void ShutDown();
 
+  /**
+   * Write the bitmap pages of the free-space map that deallocations changed since they were last written. Like the
+   * pages of the database file, they are written without a sync.
+   */
+  void FlushFreeSpaceMap();
+
   /**
    * Write a page to the database file.
    * @param page_id id of the page
@@ -58,6 +93,87 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Write several pages to the database file. Pages with adjacent ids are written with a single call, in page id
+   * order, whatever the order of the input.
+   * @param pages the pages to write, as (page id, raw page data) pairs
+   */
+  virtual void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /**
+   * Read several pages from the database file. Pages with adjacent ids are read with a single call. Pages past the end
+   * of the file read as zeros.
+   * @param pages the pages to read, as (page id, output buffer) pairs
+   */
+  virtual void ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages);
+
+  /**
+   * Start writing a page to the database file. page_data must stay valid until the callback runs.
+   * The default implementation writes synchronously and runs the callback before returning.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @param callback called with true once the page is written, or with false if the write failed
+   */
+  virtual void WritePageAsync(page_id_t page_id, const char *page_data, std::function<void(bool)> callback);
+
+  /**
+   * Start reading a page from the database file. page_data must stay valid until the callback runs.
+   * The default implementation reads synchronously and runs the callback before returning.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @param callback called with true once the page is read, or with false if the read failed
+   */
+  virtual void ReadPageAsync(page_id_t page_id, char *page_data, std::function<void(bool)> callback);
+
+  /**
+   * Pin a page for reading it in place, without copying it into a buffer pool frame. Only a read-only disk manager,
+   * see IsReadOnly, may do this, since nothing stops a writer from changing the page in a frame meanwhile. The default
+   * implementation cannot read pages in place and always returns nullptr.
+   * @param page_id id of the page
+   * @return the page data, valid until UnpinMappedPage, or nullptr if the page must be read with ReadPage
+   */
+  virtual auto PinMappedPage(page_id_t page_id) -> const char * { return nullptr; }
+
+  /**
+   * Release a page pinned by PinMappedPage.
+   * @param page_id id of the page
+   */
+  virtual void UnpinMappedPage(page_id_t page_id) {}
+
+  /** @return true if the database file is opened read-only, in which case the buffer pool hands out no page to write */
+  virtual auto IsReadOnly() const -> bool { return false; }
+
+  /**
+   * Allocate a page in the database file. A page freed by DeallocatePage is reused before the file grows.
+   * With a hint, the free page closest to the hint (within FSM_HINT_DISTANCE, preferring pages after it) is picked, so
+   * that pages read together, e.g. the two halves of a split leaf or a table heap and its next page, stay close on
+   * disk.
+   * @param hint a page the new page will be read together with, or INVALID_PAGE_ID
+   * @param stride only page ids with page_id % stride == offset are returned; a buffer pool instance of a parallel
+   * buffer pool passes its number of siblings and its index
+   * @param offset see stride
+   * @return the id of the allocated page
+   */
+  auto AllocatePage(page_id_t hint = INVALID_PAGE_ID, size_t stride = 1, size_t offset = 0) -> page_id_t;
+
+  /**
+   * Return a page to the free-space map so that AllocatePage can reuse it. Deallocating a page that is not allocated
+   * does nothing.
+   * @param page_id id of the page
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /** @return true if page_id was returned by AllocatePage and has not been deallocated since */
+  auto IsPageAllocated(page_id_t page_id) -> bool;
+
+  /** @return the number of free pages below the highest allocated page, i.e. holes AllocatePage can reuse */
+  auto GetNumFreePages() -> size_t;
+
+  /** @return the offset of a page in the database file, past the header page */
+  static auto PageOffset(page_id_t page_id) -> size_t {
+    return static_cast<size_t>(page_id + 1) * static_cast<size_t>(BUSTUB_PAGE_SIZE);
+  }
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -83,6 +199,12 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of pages read from disk */
+  auto GetNumReads() const -> int { return num_reads_.load(std::memory_order_relaxed); }
+
+  /** @return the number of read and write calls made for pages; a run of adjacent pages counts once */
+  auto GetNumIOs() const -> int { return num_ios_.load(std::memory_order_relaxed); }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -94,6 +216,41 @@ class DiskManager {
 
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
+
+  /**
+   * Write the header page of a new database file, or check the header of an existing one. Caller holds db_io_latch_.
+   * @throws Exception if the header is missing or records a different page size
+   */
+  void CheckFileHeader();
+
+  /**
+   * Open the free-space map file and rebuild free_pages_ and fsm_end_ from it. The map is only trusted if the database
+   * file existed before; a database file without a map is assumed to use every page it holds, and so are the pages
+   * of the database file past the end of the map.
+   * @param db_existed true if the database file existed before the disk manager opened it
+   * @throws Exception if the map file does not start with a header page
+   */
+  void LoadFreeSpaceMap(bool db_existed);
+
+  /**
+   * Set the bit of page_id in the free-space map and write its bitmap page, or clear it and mark the bitmap page
+   * dirty. Caller holds fsm_latch_.
+   */
+  void SetPageAllocated(page_id_t page_id, bool allocated);
+
+  /**
+   * The free pages AllocatePage may hand to callers with the given stride and offset. The free pages are kept
+   * partitioned by page id modulo the stride of the last caller, which is the same for every caller in practice: the
+   * number of instances of the buffer pool. Caller holds fsm_latch_.
+   */
+  auto FreePagesOf(size_t stride, size_t offset) -> std::set<page_id_t> &;
+
+  /** The set a free page belongs in. Caller holds fsm_latch_. */
+  auto FreePagesOf(page_id_t page_id) -> std::set<page_id_t> & { return free_pages_[page_id % free_pages_.size()]; }
+
+  /** Write bitmap page index of the free-space map to the map file, if there is one. Caller holds fsm_latch_. */
+  void WriteFreeSpaceMapPage(size_t index);
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
@@ -102,10 +259,27 @@ class DiskManager {
   std::string file_name_;
   int num_flushes_{0};
   int num_writes_{0};
+  std::atomic<int> num_reads_{0};
+  std::atomic<int> num_ios_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
   // With multiple buffer pool instances, need to protect file access
   std::mutex db_io_latch_;
+
+  // stream to write the free-space map; not open for the in-memory disk managers, which keep the map in memory only
+  std::fstream fsm_io_;
+  std::string fsm_name_;
+  // one bit per page, set if the page is allocated; always a whole number of bitmap pages
+  std::vector<uint8_t> fsm_bitmap_;
+  // the bitmap pages changed since they were last written
+  std::set<size_t> fsm_dirty_pages_;
+  // unallocated pages below fsm_end_, page id p in free_pages_[p % free_pages_.size()], see FreePagesOf
+  std::vector<std::set<page_id_t>> free_pages_{1};
+  size_t num_free_pages_{0};
+  // one past the highest page id ever allocated
+  page_id_t fsm_end_{0};
+  // protects fsm_io_, fsm_bitmap_, fsm_dirty_pages_, free_pages_, num_free_pages_ and fsm_end_
+  std::mutex fsm_latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager.h
+//
+// Identification: src/include/storage/disk/mmap_disk_manager.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * MmapDiskManager opens an existing database file read-only and maps it into memory, so that
+ * BufferPoolManager::FetchPageRead can hand out pages that are not in the buffer pool straight from the mapping,
+ * without a copy and without taking a frame. It is meant for read-only nodes such as analytic replicas, where large
+ * scans would otherwise cycle every page through the pool.
+ *
+ * Nothing is ever written through it: writes and allocations throw, and the buffer pool refuses to hand out pages for
+ * writing, see IsReadOnly. That is what makes the mapping safe to read without latches: a page in the mapping cannot
+ * change under a reader, and no writer can change a page in a frame while readers of an older version of it, or of
+ * the pages pointing to it, read the mapping. Pages read with ReadPage are copied into frames as usual.
+ */
+class MmapDiskManager : public DiskManager {
+ public:
+  /**
+   * Opens and maps an existing database file.
+   * @param db_file the file name of the database file
+   * @throws Exception if the database file does not exist, or cannot be opened as one
+   */
+  explicit MmapDiskManager(const std::string &db_file);
+
+  /** Unmaps the database file. No page handed out by PinMappedPage may be used afterwards. */
+  ~MmapDiskManager() override;
+
+  /** @throws Exception always: the database file is opened read-only */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /** @throws Exception always: the database file is opened read-only */
+  void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) override;
+
+  /**
+   * @param page_id id of the page
+   * @return the page in the mapping, or nullptr if the page lies past the end of the file
+   */
+  auto PinMappedPage(page_id_t page_id) -> const char * override;
+
+  auto IsReadOnly() const -> bool override { return true; }
+
+ private:
+  /** Throws, if the database file does not exist, before the base constructor would create it */
+  static auto CheckExists(const std::string &db_file) -> const std::string &;
+
+  /** Read-only file descriptor of the database file, used for the mapping. */
+  int fd_{-1};
+  /** The whole pages of the database file, or nullptr if it holds none. */
+  char *mapping_{nullptr};
+  size_t mapping_size_{0};
+};
+
+}  // namespace bustub
@@ -11,7 +11,9 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <iostream>
 #include <optional>
 #include <queue>
@@ -82,9 +84,11 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
+  // Creates an empty tree under the header page, or, if open_existing, uses the tree already there, which a
+  // read-only buffer pool requires.
   explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
                      const KeyComparator &comparator, int leaf_max_size = LEAF_PAGE_SIZE,
-                     int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int internal_max_size = INTERNAL_PAGE_SIZE, bool open_existing = false);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() -> bool;
@@ -98,6 +102,31 @@ class BPlusTree {
   // Return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn = nullptr) -> bool;
 
+  /**
+   * @brief Look up many keys at once. Consecutive keys that fall into the same leaf are found there without descending
+   * from the root again, and a key past the leaf only climbs as far up as it has to. The keys may come in any order,
+   * but only sorted keys share most of the path.
+   * @param[out] result for every key its value, or std::nullopt if the key is not in the tree
+   * @return the number of keys found
+   */
+  auto GetValues(const std::vector<KeyType> &keys, std::vector<std::optional<ValueType>> *result,
+                 Transaction *txn = nullptr) -> size_t;
+
+  // Return how many lookups gave up on the optimistic descent and crabbed down with read latches
+  auto GetLatchedLookupCount() const -> size_t { return num_latched_lookups_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Build the tree bottom-up out of entries that come in ascending key order, e.g. from an ExternalSorter.
+   * Every page is filled to fill_factor of its maximum size, except where the last page of a level takes entries from
+   * the one before to reach its minimum size. Of entries with equal keys the first is kept, as Insert would. The tree
+   * must be empty; throws if it is not, or if the entries are out of order.
+   * @param next produces the next entry, returns false after the last
+   * @param ring if not null, the new pages recycle the frames of this ring instead of filling the buffer pool
+   * @return the number of entries loaded
+   */
+  auto BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next,
+                double fill_factor = BPLUS_TREE_BULK_LOAD_FILL_FACTOR, BufferRing *ring = nullptr) -> size_t;
+
   // Return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
@@ -134,28 +163,78 @@ class BPlusTree {
 
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *txn = nullptr);
-  
 
-  auto GetLeafPageId(KeyType key) -> page_id_t;
+ private:
+  /* Crabs down to a leaf with read latches: a page is released as soon as its child is latched. Descends towards key,
+     or to the leftmost leaf if key is null. */
+  auto FindLeafRead(const KeyType *key) -> ReadPageGuard;
+
+  /* Descends to the leaf for key with optimistic read guards. Returns an empty guard if a writer changed a page on the
+     way; the caller starts over. */
+  auto FindLeafOptimistic(const KeyType &key) -> OptimisticReadGuard;
+
+  /* The most entries a leaf or an internal page can hold: sizes read through an optimistic guard are checked against
+     them before they index the page. */
+  static constexpr int MAX_LEAF_ENTRIES =
+      (BUSTUB_PAGE_DATA_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, ValueType>);
+  static constexpr int MAX_INTERNAL_ENTRIES =
+      (BUSTUB_PAGE_DATA_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, page_id_t>);
+
+  /* The path GetValues keeps from one key to the next: optimistic guards from the root down to a leaf, each with the
+     range of keys its page covers, from the key at lower_ on up to the key at upper_. No lower or upper key means the
+     page is the leftmost or rightmost of its level. */
+  struct LookupPath {
+    std::vector<OptimisticReadGuard> guards_;
+    std::vector<std::optional<KeyType>> lower_;
+    std::vector<std::optional<KeyType>> upper_;
+
+    void Push(OptimisticReadGuard &&guard, std::optional<KeyType> lower, std::optional<KeyType> upper) {
+      guards_.push_back(std::move(guard));
+      lower_.push_back(std::move(lower));
+      upper_.push_back(std::move(upper));
+    }
+
+    void Pop() {
+      guards_.pop_back();
+      lower_.pop_back();
+      upper_.pop_back();
+    }
+  };
 
-  auto GetMaxLeafPageId() -> page_id_t;
+  /* One lookup of GetValues: climbs path until its page covers key, then descends to the leaf for key. Returns false,
+     and clears path, if a page changed under it; the lookup then has to start over. */
+  auto GetValueOnPath(const KeyType &key, LookupPath *path, std::optional<ValueType> *value) -> bool;
 
-  
-  /**
-   * @brief Navigate down the B+ tree to the corresponding leaf page.
-   * 
-   * @param key 
-   * @return BPlusTreeInternalPage* 
-   */
-  auto GetLeafPage(KeyType key, std::vector<page_id_t> &page_path) -> page_id_t;
+  /* Crabs down to the leaf for key with read latches and returns it write-latched. Sets is_root if the leaf is the
+     root. */
+  auto FindLeafWrite(const KeyType &key, Context *ctx, bool *is_root) -> WritePageGuard;
 
- private:
+  /* The common insert: write-latches the leaf only, see FindLeafWrite. Returns std::nullopt without changing anything
+     if the leaf is full; the insert then has to split, see InsertPessimistic. */
+  auto InsertOptimistic(const KeyType &key, const ValueType &value, Context *ctx) -> std::optional<bool>;
+
+  /* The insert that may split: crabs down with write latches, and keeps the latches of every page from the highest
+     one that may have to split, and of the header page if that is the root, in ctx. */
+  auto InsertPessimistic(const KeyType &key, const ValueType &value, Context *ctx) -> bool;
+
+  /* Links right_page_id in after left_page_id, separated by key, into the parent at the back of ctx->write_set_. Splits
+     the parent in turn if it is full, and grows a new root if left_page_id was the root. */
+  void InsertIntoParent(Context *ctx, page_id_t left_page_id, const KeyType &key, page_id_t right_page_id);
+
+  /* The common remove: write-latches the leaf only. Returns std::nullopt without changing anything if the leaf would
+     fall below its minimum size; the remove then has to rebalance, see RemovePessimistic. */
+  auto RemoveOptimistic(const KeyType &key, Context *ctx) -> std::optional<bool>;
+
+  /* The remove that may merge: crabs down with write latches like InsertPessimistic, keeping the chain of pages that
+     may fall below their minimum size in ctx. */
+  auto RemovePessimistic(const KeyType &key, Context *ctx) -> bool;
 
-  /* Splits, returning the two resuling pages from split and middle key element. */
-  auto SplitLeafNode(page_id_t leaf_page) -> std::tuple<page_id_t,page_id_t,KeyType>;
+  /* Brings the page at the back of ctx->write_set_, which just lost an entry, back to its minimum size by borrowing
+     from or merging with a sibling, up the tree as far as needed. Collapses a root that is left with one child. */
+  void RebalanceAfterRemove(Context *ctx);
 
-  auto UpdateParent(page_id_t left_page_id, page_id_t right_page_id, 
-                  KeyType key_middle, std::vector<page_id_t> page_path) -> void;
+  /* Allocates a page next to hint, in a frame of ring if given, and returns it write-latched. */
+  auto NewPageWrite(page_id_t *page_id, page_id_t hint, BufferRing *ring = nullptr) -> WritePageGuard;
 
   /* Debug Routines for FREE!! */
   void ToGraph(page_id_t page_id, const BPlusTreePage *page, std::ofstream &out);
@@ -179,7 +258,8 @@ class BPlusTree {
   int internal_max_size_;
   page_id_t header_page_id_;
   GenericKey<8> INVALID_KEY;
-  size_t size_;
+  std::atomic<size_t> size_{0};
+  std::atomic<size_t> num_latched_lookups_{0};
 };
 
 /**
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -35,6 +36,20 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  /**
+   * Fill the empty index with the entries next produces, in any order, much faster than one InsertEntry each: the
+   * entries are sorted with an ExternalSorter, which spills to disk once they outgrow sort_memory_bytes, and the tree
+   * is built bottom-up from them, see BPlusTree::BulkLoad.
+   * @param next produces the key and RID of the next entry, returns false after the last
+   * @return the number of entries in the index
+   */
+  auto BulkLoad(const std::function<bool(Tuple *, RID *)> &next, Transaction *transaction,
+                double fill_factor = BPLUS_TREE_BULK_LOAD_FILL_FACTOR, size_t sort_memory_bytes = BULK_LOAD_SORT_BYTES)
+      -> size_t;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
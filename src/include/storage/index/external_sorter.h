@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.h
+//
+// Identification: src/include/storage/index/external_sorter.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdio>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+/**
+ * ExternalSorter sorts the (key, value) pairs of an index build by key, in a bounded amount of memory. Pairs are
+ * collected in memory until they fill the budget, then sorted and spilled to a temporary file as a run. Reading the
+ * pairs back merges the runs, and whatever is still in memory, in one pass.
+ *
+ * The sort is stable: pairs with equal keys come out in the order they were added.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSorter {
+ public:
+  /**
+   * @param memory_bytes the memory the pairs may take while they are added; the merge reads the runs through buffers
+   * that take as much again
+   */
+  explicit ExternalSorter(const KeyComparator &comparator, size_t memory_bytes = BULK_LOAD_SORT_BYTES);
+
+  ~ExternalSorter();
+
+  DISALLOW_COPY_AND_MOVE(ExternalSorter);
+
+  /** @brief Add a pair. Spills a run to disk if the memory budget is full. Must not be called after Next. */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /**
+   * @brief Get the next pair in key order. The first call sorts what is still in memory and starts the merge.
+   * @return false once all pairs have been returned
+   */
+  auto Next(KeyType *key, ValueType *value) -> bool;
+
+  /** @return the number of pairs added */
+  auto GetSize() const -> size_t { return num_pairs_; }
+
+  /** @return the number of runs spilled to disk */
+  auto GetNumRuns() const -> size_t { return runs_.size(); }
+
+ private:
+  /** A sorted run in a temporary file, read back through a buffer. */
+  struct Run {
+    std::FILE *file_;
+    size_t num_unread_;
+    std::vector<MappingType> buffer_;
+    size_t next_{0};
+  };
+
+  /** The source of the next pair of the merge: a run, or the pairs in memory if it is runs_.size(). */
+  auto Current(size_t source) const -> const MappingType &;
+
+  /** @return false if the source is exhausted */
+  auto Advance(size_t source) -> bool;
+
+  void SortMemory();
+  void Spill();
+  void Refill(Run *run);
+
+  KeyComparator comparator_;
+  size_t memory_pairs_;
+  size_t num_pairs_{0};
+  std::vector<MappingType> memory_;
+  size_t memory_next_{0};
+  std::vector<Run> runs_;
+  bool merging_{false};
+
+  /** Orders the sources by their current pair, and equal pairs by source, since earlier runs hold earlier pairs. */
+  struct SourceGreater {
+    auto operator()(size_t a, size_t b) const -> bool {
+      const int cmp = sorter_->comparator_(sorter_->Current(a).first, sorter_->Current(b).first);
+      return cmp != 0 ? cmp > 0 : a > b;
+    }
+    const ExternalSorter *sorter_;
+  };
+  std::priority_queue<size_t, std::vector<size_t>, SourceGreater> heap_{SourceGreater{this}};
+};
+
+}  // namespace bustub
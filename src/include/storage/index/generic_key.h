@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <cstring>
 
+#include "common/macros.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -72,11 +75,30 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Keys whose columns are all of fixed size, i.e. all but VARCHAR, are compared in a normalized form: every column
+ * big-endian, with the sign bit of integers flipped and decimals mapped to integers of the same order, one after the
+ * other. Two normalized keys compare like their bytes do, with memcmp, and their first eight bytes, their head, order
+ * them unless the heads are equal, which is what the B+ tree pages search on. A null column sorts before every value
+ * of its type but -inf for decimals, whereas Value compares a null equal to everything. Other keys are compared one
+ * Value at a time.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
+  /** Room for a normalized key, and for the eight bytes Head reads past the end of it, which are zero. */
+  using NormalizedKey = std::array<uint8_t, KeySize + sizeof(uint64_t)>;
+
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    if (normalized_size_ != 0) {
+      NormalizedKey lhs_bytes;
+      NormalizedKey rhs_bytes;
+      Normalize(lhs, &lhs_bytes);
+      Normalize(rhs, &rhs_bytes);
+      const int cmp = memcmp(lhs_bytes.data(), rhs_bytes.data(), normalized_size_);
+      return static_cast<int>(cmp > 0) - static_cast<int>(cmp < 0);
+    }
+
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
@@ -94,13 +116,117 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  /** @return the number of bytes of a normalized key, or 0 if the keys of this schema are not normalized */
+  inline auto GetNormalizedSize() const -> size_t { return normalized_size_; }
+
+  /** Writes the GetNormalizedSize() bytes of the normalized key; the rest of out is left as it is. */
+  inline void Normalize(const GenericKey<KeySize> &key, NormalizedKey *out) const {
+    uint8_t *dst = out->data();
+    for (size_t i = 0; i < num_columns_; i++) {
+      dst = NormalizeColumn(key, i, dst);
+    }
+  }
+
+  /** @return Head(out, 0) of what Normalize(key, &out) writes, from the columns that make up those bytes only */
+  inline auto NormalizeHead(const GenericKey<KeySize> &key) const -> uint64_t {
+    // a column takes at most eight bytes, so the head columns end before twice the head does
+    std::array<uint8_t, 2 * sizeof(uint64_t)> head_bytes{};
+    uint8_t *dst = head_bytes.data();
+    for (size_t i = 0; i < num_head_columns_; i++) {
+      dst = NormalizeColumn(key, i, dst);
+    }
+    uint64_t head = 0;
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+      head = head << 8 | head_bytes[i];
+    }
+    return head;
+  }
+
+  /** @return the eight bytes of a normalized key from offset on, as an integer that orders like the bytes */
+  static inline auto Head(const NormalizedKey &key, size_t offset) -> uint64_t {
+    uint64_t head = 0;
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+      head = head << 8 | key[offset + i];
+    }
+    return head;
+  }
+
+  GenericComparator(const GenericComparator &other) = default;
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {
+    size_t normalized_size = 0;
+    for (const auto &column : key_schema->GetColumns()) {
+      const size_t size = column.GetFixedLength();
+      if (!column.IsInlined() || column.GetOffset() + size > KeySize) {
+        num_columns_ = 0;
+        return;
+      }
+      columns_[num_columns_++] = {static_cast<uint8_t>(column.GetOffset()), static_cast<uint8_t>(column.GetType())};
+      if (normalized_size < sizeof(uint64_t)) {
+        num_head_columns_ = num_columns_;
+      }
+      normalized_size += size;
+    }
+    normalized_size_ = normalized_size;
+  }
 
  private:
+  static constexpr uint64_t SIGN_BIT = uint64_t{1} << 63;
+
+  template <typename T>
+  static inline auto Load(const char *src) -> T {
+    T value;
+    memcpy(&value, src, sizeof(T));
+    return value;
+  }
+
+  /** Writes column i of key normalized at dst, and returns where the next column goes */
+  inline auto NormalizeColumn(const GenericKey<KeySize> &key, size_t i, uint8_t *dst) const -> uint8_t * {
+    const char *src = key.data_ + columns_[i].offset_;
+    switch (static_cast<TypeId>(columns_[i].type_)) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return StoreBigEndian<uint8_t>(Load<uint8_t>(src) ^ 0x80U, dst);
+      case TypeId::SMALLINT:
+        return StoreBigEndian<uint16_t>(Load<uint16_t>(src) ^ 0x8000U, dst);
+      case TypeId::INTEGER:
+        return StoreBigEndian<uint32_t>(Load<uint32_t>(src) ^ 0x80000000U, dst);
+      case TypeId::BIGINT:
+        return StoreBigEndian<uint64_t>(Load<uint64_t>(src) ^ SIGN_BIT, dst);
+      case TypeId::TIMESTAMP:
+        // the null timestamp is the largest value; adding one wraps it around to zero and keeps the order of the rest
+        return StoreBigEndian<uint64_t>(Load<uint64_t>(src) + 1, dst);
+      case TypeId::DECIMAL: {
+        // -0.0 equals 0.0; otherwise negative numbers order the other way round than their bits do
+        uint64_t bits = Load<double>(src) == 0 ? 0 : Load<uint64_t>(src);
+        return StoreBigEndian<uint64_t>((bits & SIGN_BIT) != 0 ? ~bits : bits ^ SIGN_BIT, dst);
+      }
+      default:
+        UNREACHABLE("not a fixed-size type");
+    }
+  }
+
+  template <typename T>
+  static inline auto StoreBigEndian(T value, uint8_t *dst) -> uint8_t * {
+    for (size_t i = 0; i < sizeof(T); i++) {
+      dst[i] = static_cast<uint8_t>(value >> (8 * (sizeof(T) - 1 - i)));
+    }
+    return dst + sizeof(T);
+  }
+
+  /** Where a column of a normalized key is in the key, and its TypeId. A column takes at least a byte of it. */
+  struct NormalizedColumn {
+    uint8_t offset_;
+    uint8_t type_;
+  };
+
   Schema *key_schema_;
+  size_t normalized_size_{0};
+  size_t num_columns_{0};
+  /** How many columns the first eight bytes of a normalized key come from */
+  size_t num_head_columns_{0};
+  std::array<NormalizedColumn, KeySize> columns_{};
 };
 
 }  // namespace bustub
@@ -16,6 +16,7 @@
 
 // #include "storage/index/b_plus_tree.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
@@ -34,7 +35,10 @@ class IndexIterator {
  public:
   // you may define your own constructor based on your member variables
   IndexIterator();
+  /** An iterator that only marks a position, like End() at {INVALID_PAGE_ID, 0}. It cannot be dereferenced. */
   IndexIterator(BufferPoolManager* bpm, std::pair<page_id_t,size_t> pos);
+  /** An iterator at offset of the leaf guard holds. It keeps the leaf read-latched until it moves on to the next. */
+  IndexIterator(BufferPoolManager* bpm, ReadPageGuard &&guard, size_t offset);
   ~IndexIterator();  // NOLINT
 
   auto IsEnd() -> bool;
@@ -51,7 +55,13 @@ class IndexIterator {
 
 
  private:
-  
+  /** Ask the buffer pool to read the leaf after the current one while this one is being scanned. */
+  void PrefetchNextLeaf();
+
+  /** Move on to the first key of the following leaves while the current leaf has no key at pos_. */
+  void MoveToNextLeaf();
+
+
   // size_t pos_;
 
   size_t start_;
@@ -60,7 +70,10 @@ class IndexIterator {
 
   std::pair<page_id_t,size_t> pos_;
 
-  BufferPoolManager* bpm_;
+  BufferPoolManager* bpm_{nullptr};
+
+  /** The current leaf. */
+  ReadPageGuard guard_;
 
 
 };
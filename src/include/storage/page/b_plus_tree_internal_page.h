@@ -19,7 +19,7 @@ namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
 #define INTERNAL_PAGE_HEADER_SIZE 12
-#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_DATA_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -59,6 +59,14 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    */
   void Insert(KeyType key, const ValueType &value, size_t index);
 
+  /**
+   * @brief Removes the key value pair at 'index' and moves the pairs after
+   * it back. Also decrements page's size_.
+   *
+   * @param index
+   */
+  void Remove(size_t index);
+
   void Replace(const KeyType &key, const ValueType &value, size_t index);
 
   /**
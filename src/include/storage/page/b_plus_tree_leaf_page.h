@@ -20,7 +20,7 @@ namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
 #define LEAF_PAGE_HEADER_SIZE 16
-#define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_SIZE ((BUSTUB_PAGE_DATA_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -58,8 +58,8 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
   auto KeyAt(int index) const -> KeyType;
-  auto ValueAt(int index) -> ValueType;
-  auto KeyValueAt(int index) -> const MappingType&;
+  auto ValueAt(int index) const -> ValueType;
+  auto KeyValueAt(int index) const -> const MappingType &;
 
   /**
    * @brief for test only return a string representing all keys in
@@ -97,6 +97,14 @@ class BPlusTreeLeafPage : public BPlusTreePage {
    */
   void Insert(const KeyType &key, const ValueType &value, size_t index);
 
+  /**
+   * @brief Removes the key value pair at 'index' and moves the pairs after
+   * it back. Also decrements page's size_.
+   *
+   * @param index
+   */
+  void Remove(size_t index);
+
   void PrintArray();
 
  private:
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -27,7 +28,7 @@ namespace bustub {
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
-  friend class BufferPoolManager;
+  friend class BufferPoolManagerInstance;
 
  public:
   /** Constructor. Zeros out the page data. */
@@ -36,8 +37,19 @@ class Page {
     ResetMemory();
   }
 
+  /**
+   * Constructor for a page whose data lives in a buffer owned by someone else, e.g. the frame arena of a buffer pool.
+   * The data is not touched, so that a freshly mapped arena is only faulted in as frames are used.
+   * @param data a zeroed buffer of BUSTUB_PAGE_SIZE bytes that outlives the page
+   */
+  explicit Page(char *data) : data_(data), owns_data_(false) {}
+
   /** Default destructor. */
-  ~Page() { delete[] data_; }
+  ~Page() {
+    if (owns_data_) {
+      delete[] data_;
+    }
+  }
 
   void Reset() {
     ResetMemory();
@@ -66,11 +78,31 @@ class Page {
   /** @brief Kobi added function to set dirty bit. */
   void SetDirty(bool dirty) { is_dirty_ = dirty; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The version becomes odd until WUnlatch. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    // keep the writes to the page from moving above the version bump
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /** Release the page write latch. The version becomes even again, and differs from before WLatch. */
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
-  /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  /**
+   * @return the version of the page, bumped by every WLatch and WUnlatch. It is odd while a writer holds the latch, so
+   * an optimistic reader that saw the same even version before and after reading the page read a consistent page.
+   */
+  inline auto GetVersion() const -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /** @return how often the page latch was acquired, 0 unless built with BUSTUB_LATCH_STATS */
+  inline auto GetLatchAcquireCount() const -> uint64_t { return rwlatch_.GetAcquireCount(); }
+
+  /** @return how often a thread had to wait for the page latch, 0 unless built with BUSTUB_LATCH_STATS */
+  inline auto GetLatchWaitCount() const -> uint64_t { return rwlatch_.GetWaitCount(); }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -78,6 +110,12 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /** Acquire the page read latch unless a writer holds or waits for it. @return true if the latch was acquired */
+  inline auto TryRLatch() -> bool { return rwlatch_.TryRLock(); }
+
+  /** @return true if somebody holds the page latch */
+  inline auto IsLatched() const -> bool { return rwlatch_.IsLocked(); }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -100,14 +138,18 @@ class Page {
   // Usually this should be stored as `char data_[BUSTUB_PAGE_SIZE]{};`. But to enable ASAN to detect page overflow,
   // we store it as a ptr.
   char *data_;
+  /** False if data_ belongs to a frame arena rather than to this page. */
+  bool owns_data_{true};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Version for optimistic readers, see GetVersion. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksum.h
+//
+// Identification: src/include/storage/page/page_checksum.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageChecksum stamps pages with a CRC-32C before they are written to disk and verifies it when they are read back.
+ * The checksum is stored in the last BUSTUB_PAGE_CHECKSUM_SIZE bytes of the page, which no page layout uses: they all
+ * size themselves to BUSTUB_PAGE_DATA_SIZE. It covers the page id as well as the data, so that a page written to the
+ * wrong place is caught along with torn writes, where only part of a page reached the disk, and bit rot.
+ *
+ * A page of zeros, checksum included, verifies: it has never been written, e.g. it lies past the end of the file.
+ */
+class PageChecksum {
+ public:
+  static constexpr size_t OFFSET_CHECKSUM = BUSTUB_PAGE_DATA_SIZE;
+
+  /** @return the checksum of page page_id with contents page_data */
+  static auto Compute(page_id_t page_id, const char *page_data) -> uint32_t;
+
+  /** @brief Store the checksum of the page in its last bytes. */
+  static void Stamp(page_id_t page_id, char *page_data);
+
+  /** @return true if the stored checksum matches the page, or the page has never been written */
+  static auto Verify(page_id_t page_id, const char *page_data) -> bool;
+
+  /** @return the checksum stored in the page */
+  static auto GetStored(const char *page_data) -> uint32_t;
+};
+
+}  // namespace bustub
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <cstdint>
+#include <utility>
+
 #include "storage/page/page.h"
 
 namespace bustub {
 
 class BufferPoolManager;
+class DiskManager;
 
 class BasicPageGuard {
  public:
@@ -15,8 +19,7 @@ class BasicPageGuard {
   BasicPageGuard(const BasicPageGuard &) = delete;
   auto operator=(const BasicPageGuard &) -> BasicPageGuard & = delete;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move constructor for BasicPageGuard
    *
    * When you call BasicPageGuard(std::move(other_guard)), you
@@ -27,8 +30,7 @@ class BasicPageGuard {
    */
   BasicPageGuard(BasicPageGuard &&that) noexcept;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Drop a page guard
    *
    * Dropping a page guard should clear all contents
@@ -38,8 +40,7 @@ class BasicPageGuard {
    */
   void Drop();
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move assignment for BasicPageGuard
    *
    * Similar to a move constructor, except that the move
@@ -50,8 +51,7 @@ class BasicPageGuard {
    */
   auto operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard &;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Destructor for BasicPageGuard
    *
    * When a page guard goes out of scope, it should behave as if
@@ -91,11 +91,21 @@ class ReadPageGuard {
  public:
   ReadPageGuard() = default;
   ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  /**
+   * @brief Guard a page read straight from a memory-mapped database file instead of a buffer pool frame. No frame is
+   * pinned and no page latch is held; dropping the guard unpins the page in the disk manager.
+   * @param disk_manager the disk manager that pinned the page with PinMappedPage
+   * @param page_id the id of the page
+   * @param data the page in the mapping
+   */
+  ReadPageGuard(DiskManager *disk_manager, page_id_t page_id, const char *data)
+      : mapped_disk_manager_(disk_manager), mapped_page_id_(page_id), mapped_data_(data) {}
+
   ReadPageGuard(const ReadPageGuard &) = delete;
   auto operator=(const ReadPageGuard &) -> ReadPageGuard & = delete;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move constructor for ReadPageGuard
    *
    * Very similar to BasicPageGuard. You want to create
@@ -104,8 +114,7 @@ class ReadPageGuard {
    */
   ReadPageGuard(ReadPageGuard &&that) noexcept;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move assignment for ReadPageGuard
    *
    * Very similar to BasicPageGuard. Given another ReadPageGuard,
@@ -113,8 +122,7 @@ class ReadPageGuard {
    */
   auto operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard &;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Drop a ReadPageGuard
    *
    * ReadPageGuard's Drop should behave similarly to BasicPageGuard,
@@ -124,8 +132,7 @@ class ReadPageGuard {
    */
   void Drop();
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Destructor for ReadPageGuard
    *
    * Just like with BasicPageGuard, this should behave
@@ -133,18 +140,24 @@ class ReadPageGuard {
    */
   ~ReadPageGuard();
 
-  auto PageId() -> page_id_t { return guard_.PageId(); }
+  auto PageId() -> page_id_t { return mapped_data_ != nullptr ? mapped_page_id_ : guard_.PageId(); }
 
-  auto GetData() -> const char * { return guard_.GetData(); }
+  auto GetData() -> const char * { return mapped_data_ != nullptr ? mapped_data_ : guard_.GetData(); }
 
   template <class T>
   auto As() -> const T * {
-    return guard_.As<T>();
+    return reinterpret_cast<const T *>(GetData());
   }
 
+  /** @return true if the guard reads the page from a memory-mapped file rather than a buffer pool frame */
+  auto IsMapped() const -> bool { return mapped_data_ != nullptr; }
+
  private:
-  // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
+  /** Set instead of guard_ for a page read from the mapping of an MmapDiskManager. */
+  DiskManager *mapped_disk_manager_{nullptr};
+  page_id_t mapped_page_id_{INVALID_PAGE_ID};
+  const char *mapped_data_{nullptr};
 };
 
 class WritePageGuard {
@@ -154,8 +167,7 @@ class WritePageGuard {
   WritePageGuard(const WritePageGuard &) = delete;
   auto operator=(const WritePageGuard &) -> WritePageGuard & = delete;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move constructor for WritePageGuard
    *
    * Very similar to BasicPageGuard. You want to create
@@ -164,8 +176,7 @@ class WritePageGuard {
    */
   WritePageGuard(WritePageGuard &&that) noexcept;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Move assignment for WritePageGuard
    *
    * Very similar to BasicPageGuard. Given another WritePageGuard,
@@ -173,8 +184,7 @@ class WritePageGuard {
    */
   auto operator=(WritePageGuard &&that) noexcept -> WritePageGuard &;
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Drop a WritePageGuard
    *
    * WritePageGuard's Drop should behave similarly to BasicPageGuard,
@@ -184,8 +194,7 @@ class WritePageGuard {
    */
   void Drop();
 
-  /** TODO(P1): Add implementation
-   *
+  /**
    * @brief Destructor for WritePageGuard
    *
    * Just like with BasicPageGuard, this should behave
@@ -210,8 +219,107 @@ class WritePageGuard {
   }
 
  private:
-  // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
 
+/**
+ * EpochReadGuard holds the read latch of a page like a ReadPageGuard, but without a pin. The buffer pool never evicts
+ * a frame whose latch is held, so the latch alone keeps the page in its frame; the frame was found inside an epoch,
+ * see BufferPoolManager::FetchPageEpoch. Taking and dropping the guard thus costs no pin count or replacer update,
+ * which pays off for pages that are read all the time and hardly ever evicted, like inner B+ tree pages.
+ */
+class EpochReadGuard {
+ public:
+  EpochReadGuard() = default;
+
+  /** @brief Guard a page the caller has read-latched. */
+  explicit EpochReadGuard(Page *page) : page_(page) {}
+
+  EpochReadGuard(const EpochReadGuard &) = delete;
+  auto operator=(const EpochReadGuard &) -> EpochReadGuard & = delete;
+
+  EpochReadGuard(EpochReadGuard &&that) noexcept;
+
+  auto operator=(EpochReadGuard &&that) noexcept -> EpochReadGuard &;
+
+  /** @brief Release the latch. The guard is empty afterwards. */
+  void Drop();
+
+  ~EpochReadGuard();
+
+  /** @return true if the guard holds a page */
+  auto IsValid() const -> bool { return page_ != nullptr; }
+
+  auto PageId() -> page_id_t { return page_->GetPageId(); }
+
+  auto GetData() -> const char * { return page_->GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+ private:
+  Page *page_{nullptr};
+};
+
+/**
+ * OptimisticReadGuard reads a page without its latch and without a pin, and remembers the page version it started
+ * from. Writers and evictions both bump the version. Everything read through the guard may be torn by a concurrent
+ * writer or come from a frame that is being reused for another page, and must only be trusted once Validate() returns
+ * true; bounds read from the page have to be checked before they are used to index it.
+ *
+ * A page that FetchPageOptimistic served from the mapping of an MmapDiskManager is never written in place, so such a
+ * guard always validates.
+ */
+class OptimisticReadGuard {
+ public:
+  OptimisticReadGuard() = default;
+
+  /**
+   * @brief Guard a page of a buffer pool frame.
+   * @param page the page
+   * @param version the even version of the page, read before the frame was checked to still hold the page
+   */
+  OptimisticReadGuard(Page *page, uint64_t version) : page_(page), version_(version) {}
+
+  /** @brief Guard a page read from the mapping of the database file. */
+  explicit OptimisticReadGuard(ReadPageGuard &&mapped) : mapped_(std::move(mapped)) {}
+
+  OptimisticReadGuard(const OptimisticReadGuard &) = delete;
+  auto operator=(const OptimisticReadGuard &) -> OptimisticReadGuard & = delete;
+
+  OptimisticReadGuard(OptimisticReadGuard &&that) noexcept;
+
+  auto operator=(OptimisticReadGuard &&that) noexcept -> OptimisticReadGuard &;
+
+  /** @brief Forget the page, and unpin it if it is mapped. The guard is empty afterwards. */
+  void Drop();
+
+  ~OptimisticReadGuard();
+
+  /** @return true if the guard holds a page */
+  auto IsValid() const -> bool { return page_ != nullptr || mapped_.IsMapped(); }
+
+  auto PageId() -> page_id_t { return mapped_.IsMapped() ? mapped_.PageId() : page_->GetPageId(); }
+
+  auto GetData() -> const char * { return mapped_.IsMapped() ? mapped_.GetData() : page_->GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /**
+   * @return true if no writer has latched the page and the page was not evicted since the guard was taken, i.e.
+   * everything read so far is consistent
+   */
+  auto Validate() const -> bool;
+
+ private:
+  Page *page_{nullptr};
+  uint64_t version_{0};
+  ReadPageGuard mapped_;
+};
+
 }  // namespace bustub
@@ -0,0 +1,210 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.cpp
+//
+// Identification: src/storage/disk/async_disk_manager.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+AsyncDiskManager::AsyncDiskManager(const std::string &db_file, size_t num_workers) : DiskManager(db_file) {
+  fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+  if (fd_ >= 0) {
+    direct_io_ = true;
+  } else if (errno == EINVAL) {
+    // e.g. tmpfs does not support O_DIRECT; fall back to buffered I/O
+    fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  for (size_t i = 0; i < std::max<size_t>(1, num_workers); i++) {
+    workers_.emplace_back(&AsyncDiskManager::RunWorker, this);
+  }
+}
+
+AsyncDiskManager::~AsyncDiskManager() {
+  {
+    std::scoped_lock lock{queue_latch_};
+    stop_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  close(fd_);
+}
+
+void AsyncDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  std::promise<void> done;
+  WritePageAsync(page_id, page_data, [&done](bool) { done.set_value(); });
+  done.get_future().wait();
+}
+
+void AsyncDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  std::promise<void> done;
+  ReadPageAsync(page_id, page_data, [&done](bool) { done.set_value(); });
+  done.get_future().wait();
+}
+
+void AsyncDiskManager::WritePageAsync(page_id_t page_id, const char *page_data, std::function<void(bool)> callback) {
+  // The data is only read for a write; the request type keeps one mutable pointer for both directions.
+  Submit({true, page_id, const_cast<char *>(page_data), std::move(callback)});  // NOLINT
+}
+
+void AsyncDiskManager::ReadPageAsync(page_id_t page_id, char *page_data, std::function<void(bool)> callback) {
+  Submit({false, page_id, page_data, std::move(callback)});
+}
+
+void AsyncDiskManager::Submit(Request request) {
+  {
+    std::scoped_lock lock{queue_latch_};
+    BUSTUB_ASSERT(!stop_, "request submitted to a disk manager that is being destroyed");
+    if (request.is_write_) {
+      num_writes_ += 1;
+    }
+    queue_.push_back(std::move(request));
+  }
+  queue_cv_.notify_one();
+}
+
+void AsyncDiskManager::RunWorker() {
+  while (true) {
+    Request request;
+    {
+      std::unique_lock lock{queue_latch_};
+      queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      // drain the queue before stopping, so that every callback runs
+      if (queue_.empty()) {
+        return;
+      }
+      request = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    request.callback_(TransferRun(request.is_write_, request.page_id_, &request.data_, 1));
+  }
+}
+
+void AsyncDiskManager::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  auto sorted = pages;
+  std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  {
+    std::scoped_lock lock{queue_latch_};
+    num_writes_ += static_cast<int>(pages.size());
+  }
+  std::vector<char *> buffers;
+  for (size_t begin = 0; begin < sorted.size();) {
+    buffers.clear();
+    size_t end = begin;
+    do {
+      buffers.push_back(const_cast<char *>(sorted[end].second));  // NOLINT
+      end++;
+    } while (end < sorted.size() && sorted[end].first == sorted[end - 1].first + 1);
+    TransferRun(true, sorted[begin].first, buffers.data(), buffers.size());
+    begin = end;
+  }
+}
+
+void AsyncDiskManager::ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  auto sorted = pages;
+  std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  std::vector<char *> buffers;
+  for (size_t begin = 0; begin < sorted.size();) {
+    buffers.clear();
+    size_t end = begin;
+    do {
+      buffers.push_back(sorted[end].second);
+      end++;
+    } while (end < sorted.size() && sorted[end].first == sorted[end - 1].first + 1);
+    TransferRun(false, sorted[begin].first, buffers.data(), buffers.size());
+    begin = end;
+  }
+}
+
+auto AsyncDiskManager::TransferRun(bool is_write, page_id_t first_page_id, char *const *buffers, size_t count)
+    -> bool {
+  auto offset = static_cast<off_t>(PageOffset(first_page_id));
+  std::vector<iovec> iov;
+  std::unique_ptr<char, decltype(&std::free)> bounce(nullptr, &std::free);
+  bool aligned = std::all_of(buffers, buffers + count, [](const char *buffer) {
+    return reinterpret_cast<uintptr_t>(buffer) % BUSTUB_PAGE_SIZE == 0;
+  });
+  if (direct_io_ && !aligned) {
+    bounce.reset(static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, count * BUSTUB_PAGE_SIZE)));
+    if (is_write) {
+      for (size_t i = 0; i < count; i++) {
+        memcpy(bounce.get() + i * BUSTUB_PAGE_SIZE, buffers[i], BUSTUB_PAGE_SIZE);
+      }
+    }
+    iov.push_back({bounce.get(), count * BUSTUB_PAGE_SIZE});
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      iov.push_back({buffers[i], BUSTUB_PAGE_SIZE});
+    }
+  }
+  if (!is_write) {
+    num_reads_ += static_cast<int>(count);
+  }
+
+  for (size_t idx = 0; idx < iov.size();) {
+    auto iov_count = static_cast<int>(std::min<size_t>(iov.size() - idx, IOV_MAX));
+    ssize_t n = is_write ? pwritev(fd_, &iov[idx], iov_count, offset) : preadv(fd_, &iov[idx], iov_count, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      LOG_DEBUG("I/O error while %s page %d: %s", is_write ? "writing" : "reading", first_page_id, strerror(errno));
+      return false;
+    }
+    num_ios_ += 1;
+    if (n == 0) {
+      // reading past the end of the file: the rest of the run has never been written
+      for (; idx < iov.size(); idx++) {
+        memset(iov[idx].iov_base, 0, iov[idx].iov_len);
+      }
+      break;
+    }
+    offset += n;
+    // skip what was transferred; a short transfer can end in the middle of a buffer
+    for (auto left = static_cast<size_t>(n); left > 0;) {
+      if (left >= iov[idx].iov_len) {
+        left -= iov[idx].iov_len;
+        idx++;
+      } else {
+        iov[idx].iov_base = static_cast<char *>(iov[idx].iov_base) + left;
+        iov[idx].iov_len -= left;
+        left = 0;
+      }
+    }
+  }
+  if (bounce != nullptr && !is_write) {
+    for (size_t i = 0; i < count; i++) {
+      memcpy(buffers[i], bounce.get() + i * BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE);
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
@@ -49,6 +50,7 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
 
+  const bool db_existed = GetFileSize(db_file) >= 0;
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
   // directory or file does not exist
@@ -61,6 +63,38 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
   buffer_used = nullptr;
+  CheckFileHeader();
+
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
+  LoadFreeSpaceMap(db_existed);
+}
+
+DiskManager::~DiskManager() { FlushFreeSpaceMap(); }
+
+/**
+ * An empty file is new: it gets a header. A file that has bytes but no header was not written by the disk manager.
+ */
+void DiskManager::CheckFileHeader() {
+  DbFileHeader header{0, 0};
+  if (GetFileSize(file_name_) <= 0) {
+    std::vector<char> header_page(BUSTUB_PAGE_SIZE, 0);
+    header = {DbFileHeader::MAGIC, static_cast<uint32_t>(BUSTUB_PAGE_SIZE)};
+    memcpy(header_page.data(), &header, sizeof(header));
+    db_io_.write(header_page.data(), BUSTUB_PAGE_SIZE);
+    db_io_.flush();
+    return;
+  }
+  db_io_.read(reinterpret_cast<char *>(&header), sizeof(header));
+  db_io_.clear();
+  if (header.magic_ != DbFileHeader::MAGIC) {
+    db_io_.close();
+    throw Exception("db file " + file_name_ + " has no header page");
+  }
+  if (header.page_size_ != static_cast<uint32_t>(BUSTUB_PAGE_SIZE)) {
+    db_io_.close();
+    throw Exception("db file was created with a page size of " + std::to_string(header.page_size_) +
+                    " bytes, but this build uses " + std::to_string(BUSTUB_PAGE_SIZE));
+  }
 }
 
 /**
@@ -71,6 +105,11 @@ void DiskManager::ShutDown() {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
     db_io_.close();
   }
+  FlushFreeSpaceMap();
+  {
+    std::scoped_lock scoped_fsm_latch(fsm_latch_);
+    fsm_io_.close();
+  }
   log_io_.close();
 }
 
@@ -79,9 +118,10 @@ void DiskManager::ShutDown() {
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  size_t offset = PageOffset(page_id);
   // set write cursor to offset
   num_writes_ += 1;
+  num_ios_ += 1;
   db_io_.seekp(offset);
   db_io_.write(page_data, BUSTUB_PAGE_SIZE);
   // check for I/O error
@@ -98,12 +138,14 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
+  size_t offset = PageOffset(page_id);
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (static_cast<int64_t>(offset) > GetFileSize(file_name_)) {
     LOG_DEBUG("I/O error reading past end of file");
     // std::cerr << "I/O error while reading" << std::endl;
   } else {
+    num_reads_ += 1;
+    num_ios_ += 1;
     // set read cursor to offset
     db_io_.seekp(offset);
     db_io_.read(page_data, BUSTUB_PAGE_SIZE);
@@ -122,6 +164,311 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   }
 }
 
+/**
+ * Split pages, sorted by page id, into runs of adjacent page ids and call run(begin, end) for each run
+ */
+template <typename PageRef, typename RunFn>
+static void ForEachRun(const std::vector<PageRef> &pages, RunFn &&run) {
+  for (size_t begin = 0; begin < pages.size();) {
+    size_t end = begin + 1;
+    while (end < pages.size() && pages[end].first == pages[end - 1].first + 1) {
+      end++;
+    }
+    run(begin, end);
+    begin = end;
+  }
+}
+
+/**
+ * Write the pages in page id order, with one seek per run of adjacent pages and one flush at the end
+ */
+void DiskManager::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  if (!db_io_.is_open()) {
+    // no database file, e.g. the in-memory disk managers: fall back to single page writes
+    for (const auto &[page_id, page_data] : pages) {
+      WritePage(page_id, page_data);
+    }
+    return;
+  }
+  auto sorted = pages;
+  std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  bool failed = false;
+  ForEachRun(sorted, [&](size_t begin, size_t end) {
+    if (failed) {
+      return;
+    }
+    num_writes_ += static_cast<int>(end - begin);
+    num_ios_ += 1;
+    db_io_.seekp(PageOffset(sorted[begin].first));
+    for (size_t i = begin; i < end; i++) {
+      db_io_.write(sorted[i].second, BUSTUB_PAGE_SIZE);
+    }
+    if (db_io_.bad()) {
+      LOG_DEBUG("I/O error while writing");
+      failed = true;
+    }
+  });
+  if (!failed) {
+    db_io_.flush();
+  }
+}
+
+/**
+ * Read the pages with one seek per run of adjacent pages, zero-filling whatever lies past the end of the file
+ */
+void DiskManager::ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  if (!db_io_.is_open()) {
+    for (const auto &[page_id, page_data] : pages) {
+      ReadPage(page_id, page_data);
+    }
+    return;
+  }
+  auto sorted = pages;
+  std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  ForEachRun(sorted, [&](size_t begin, size_t end) {
+    num_reads_ += static_cast<int>(end - begin);
+    num_ios_ += 1;
+    db_io_.seekp(PageOffset(sorted[begin].first));
+    for (size_t i = begin; i < end; i++) {
+      db_io_.read(sorted[i].second, BUSTUB_PAGE_SIZE);
+      int read_count = db_io_.gcount();
+      if (read_count < BUSTUB_PAGE_SIZE) {
+        db_io_.clear();
+        memset(sorted[i].second + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+      }
+    }
+  });
+}
+
+void DiskManager::WritePageAsync(page_id_t page_id, const char *page_data, std::function<void(bool)> callback) {
+  WritePage(page_id, page_data);
+  callback(true);
+}
+
+void DiskManager::ReadPageAsync(page_id_t page_id, char *page_data, std::function<void(bool)> callback) {
+  ReadPage(page_id, page_data);
+  callback(true);
+}
+
+/** Number of pages covered by one bitmap page of the free-space map */
+static constexpr size_t FSM_PAGES_PER_BITMAP_PAGE = static_cast<size_t>(BUSTUB_PAGE_SIZE) * 8;
+
+/** Starts the header page of a free-space map file, which the bitmap pages follow */
+static constexpr uint32_t FSM_MAGIC = 0x42534d46;
+
+/**
+ * Pick a page for a new allocation: the free page or end of file closest to the hint if one is near it, otherwise the
+ * lowest free page, otherwise the end of the file
+ */
+auto DiskManager::AllocatePage(page_id_t hint, size_t stride, size_t offset) -> page_id_t {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  auto &free_pages = FreePagesOf(stride, offset);
+  // the first page at or past the end of the file this caller may use
+  const auto end_page_id = static_cast<page_id_t>(fsm_end_ + (offset + stride - fsm_end_ % stride) % stride);
+
+  page_id_t page_id = INVALID_PAGE_ID;
+  if (hint != INVALID_PAGE_ID) {
+    // the closest candidate on each side of the hint, within FSM_HINT_DISTANCE
+    page_id_t after = INVALID_PAGE_ID;
+    page_id_t before = INVALID_PAGE_ID;
+    auto next = free_pages.lower_bound(hint);
+    if (next != free_pages.end() && *next - hint <= FSM_HINT_DISTANCE) {
+      after = *next;
+    } else if (end_page_id >= hint && end_page_id - hint <= FSM_HINT_DISTANCE) {
+      after = end_page_id;
+    }
+    if (next != free_pages.begin() && hint - *std::prev(next) <= FSM_HINT_DISTANCE) {
+      before = *std::prev(next);
+    }
+    if (after != INVALID_PAGE_ID && (before == INVALID_PAGE_ID || after - hint <= hint - before)) {
+      page_id = after;
+    } else {
+      page_id = before;
+    }
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    page_id = free_pages.empty() ? end_page_id : *free_pages.begin();
+  }
+
+  if (page_id >= fsm_end_) {
+    // pages skipped to reach an id of the right stride are left for the other buffer pool instances
+    for (auto skipped = fsm_end_; skipped < page_id; skipped++) {
+      FreePagesOf(skipped).insert(skipped);
+      num_free_pages_++;
+    }
+    fsm_end_ = page_id + 1;
+  } else {
+    free_pages.erase(page_id);
+    num_free_pages_--;
+  }
+  SetPageAllocated(page_id, true);
+  return page_id;
+}
+
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  if (page_id < 0 || page_id >= fsm_end_ || !FreePagesOf(page_id).insert(page_id).second) {
+    return;
+  }
+  num_free_pages_++;
+  SetPageAllocated(page_id, false);
+}
+
+auto DiskManager::IsPageAllocated(page_id_t page_id) -> bool {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  return page_id >= 0 && page_id < fsm_end_ && FreePagesOf(page_id).count(page_id) == 0;
+}
+
+auto DiskManager::GetNumFreePages() -> size_t {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  return num_free_pages_;
+}
+
+auto DiskManager::FreePagesOf(size_t stride, size_t offset) -> std::set<page_id_t> & {
+  if (free_pages_.size() != stride) {
+    std::vector<std::set<page_id_t>> free_pages(stride);
+    for (const auto &pages : free_pages_) {
+      for (auto page_id : pages) {
+        free_pages[page_id % stride].insert(page_id);
+      }
+    }
+    free_pages_ = std::move(free_pages);
+  }
+  return free_pages_[offset];
+}
+
+/**
+ * Read the free-space map, or create it: empty for a new database, with every existing page in use for a database
+ * file that has no map yet
+ */
+void DiskManager::LoadFreeSpaceMap(bool db_existed) {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  if (db_existed) {
+    fsm_io_.open(fsm_name_, std::ios::binary | std::ios::in | std::ios::out);
+  }
+  if (fsm_io_.is_open()) {
+    uint32_t magic = 0;
+    fsm_io_.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+    fsm_io_.clear();
+    if (magic != FSM_MAGIC) {
+      fsm_io_.close();
+      throw Exception("free-space map file " + fsm_name_ + " has no header page");
+    }
+    auto size = std::max(GetFileSize(fsm_name_) - BUSTUB_PAGE_SIZE, 0);
+    fsm_bitmap_.resize((size + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE * BUSTUB_PAGE_SIZE);
+    fsm_io_.seekg(BUSTUB_PAGE_SIZE);
+    fsm_io_.read(reinterpret_cast<char *>(fsm_bitmap_.data()), size);
+    fsm_io_.clear();
+  } else {
+    fsm_io_.clear();
+    fsm_io_.open(fsm_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
+    if (!fsm_io_.is_open()) {
+      throw Exception("can't open free-space map file");
+    }
+    std::vector<char> header_page(BUSTUB_PAGE_SIZE, 0);
+    memcpy(header_page.data(), &FSM_MAGIC, sizeof(FSM_MAGIC));
+    fsm_io_.write(header_page.data(), BUSTUB_PAGE_SIZE);
+    fsm_io_.flush();
+    if (db_existed) {
+      auto num_pages = static_cast<size_t>(std::max(GetFileSize(file_name_) - BUSTUB_PAGE_SIZE, 0) / BUSTUB_PAGE_SIZE);
+      auto num_bitmap_pages = (num_pages + FSM_PAGES_PER_BITMAP_PAGE - 1) / FSM_PAGES_PER_BITMAP_PAGE;
+      fsm_bitmap_.resize(num_bitmap_pages * BUSTUB_PAGE_SIZE, 0);
+      for (size_t page_id = 0; page_id < num_pages; page_id++) {
+        fsm_bitmap_[page_id / 8] |= static_cast<uint8_t>(1U << (page_id % 8));
+      }
+      for (size_t index = 0; index < num_bitmap_pages; index++) {
+        WriteFreeSpaceMapPage(index);
+      }
+    }
+  }
+
+  fsm_end_ = 0;
+  for (size_t i = fsm_bitmap_.size(); i > 0; i--) {
+    if (fsm_bitmap_[i - 1] != 0) {
+      auto byte = fsm_bitmap_[i - 1];
+      int bit = 7;
+      while ((byte & (1U << bit)) == 0) {
+        bit--;
+      }
+      fsm_end_ = static_cast<page_id_t>((i - 1) * 8 + bit + 1);
+      break;
+    }
+  }
+  // A map older than the database file, e.g. after a crash, may not know of the last pages: they are in use.
+  const auto num_file_pages =
+      static_cast<page_id_t>(std::max(GetFileSize(file_name_) - BUSTUB_PAGE_SIZE, 0) / BUSTUB_PAGE_SIZE);
+  if (fsm_end_ < num_file_pages) {
+    const auto num_bitmap_pages = (num_file_pages + FSM_PAGES_PER_BITMAP_PAGE - 1) / FSM_PAGES_PER_BITMAP_PAGE;
+    fsm_bitmap_.resize(std::max(fsm_bitmap_.size(), num_bitmap_pages * BUSTUB_PAGE_SIZE), 0);
+    for (page_id_t page_id = fsm_end_; page_id < num_file_pages; page_id++) {
+      fsm_bitmap_[page_id / 8] |= static_cast<uint8_t>(1U << (page_id % 8));
+    }
+    for (auto index = fsm_end_ / FSM_PAGES_PER_BITMAP_PAGE; index < num_bitmap_pages; index++) {
+      WriteFreeSpaceMapPage(index);
+    }
+    fsm_end_ = num_file_pages;
+  }
+  free_pages_.assign(1, {});
+  num_free_pages_ = 0;
+  for (page_id_t page_id = 0; page_id < fsm_end_; page_id++) {
+    if ((fsm_bitmap_[page_id / 8] & (1U << (page_id % 8))) == 0) {
+      free_pages_[0].insert(free_pages_[0].end(), page_id);
+      num_free_pages_++;
+    }
+  }
+}
+
+/**
+ * An allocation is written through before the caller can write the page: a map that lost it would hand the page out
+ * again over live data after a crash. A lost deallocation only leaks the page, so those wait for FlushFreeSpaceMap.
+ */
+void DiskManager::SetPageAllocated(page_id_t page_id, bool allocated) {
+  const auto index = static_cast<size_t>(page_id) / FSM_PAGES_PER_BITMAP_PAGE;
+  if (fsm_bitmap_.size() < (index + 1) * BUSTUB_PAGE_SIZE) {
+    fsm_bitmap_.resize((index + 1) * BUSTUB_PAGE_SIZE, 0);
+  }
+  auto mask = static_cast<uint8_t>(1U << (page_id % 8));
+  if (!allocated) {
+    fsm_bitmap_[page_id / 8] &= static_cast<uint8_t>(~mask);
+    fsm_dirty_pages_.insert(index);
+    return;
+  }
+  if ((fsm_bitmap_[page_id / 8] & mask) == 0) {
+    fsm_bitmap_[page_id / 8] |= mask;
+    WriteFreeSpaceMapPage(index);
+    fsm_dirty_pages_.erase(index);
+  }
+}
+
+void DiskManager::FlushFreeSpaceMap() {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  for (auto index : fsm_dirty_pages_) {
+    WriteFreeSpaceMapPage(index);
+  }
+  fsm_dirty_pages_.clear();
+}
+
+/**
+ * Write one bitmap page through to the free-space map file
+ */
+void DiskManager::WriteFreeSpaceMapPage(size_t index) {
+  if (!fsm_io_.is_open()) {
+    return;
+  }
+  // bitmap pages follow the header page
+  fsm_io_.seekp((index + 1) * BUSTUB_PAGE_SIZE);
+  fsm_io_.write(reinterpret_cast<const char *>(&fsm_bitmap_[index * BUSTUB_PAGE_SIZE]), BUSTUB_PAGE_SIZE);
+  if (fsm_io_.bad()) {
+    LOG_DEBUG("I/O error while writing free-space map");
+    return;
+  }
+  fsm_io_.flush();
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager.cpp
+//
+// Identification: src/storage/disk/mmap_disk_manager.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/mmap_disk_manager.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+MmapDiskManager::MmapDiskManager(const std::string &db_file) : DiskManager(CheckExists(db_file)) {
+  fd_ = open(db_file.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    throw Exception("can't open db file for mapping");
+  }
+  struct stat stat_buf;
+  if (fstat(fd_, &stat_buf) != 0) {
+    close(fd_);
+    throw Exception("can't read the size of the db file");
+  }
+  // only whole pages are mapped: touching the mapping past the end of the file raises SIGBUS
+  const auto size = static_cast<size_t>(stat_buf.st_size) / BUSTUB_PAGE_SIZE * BUSTUB_PAGE_SIZE;
+  if (size == 0) {
+    return;
+  }
+  void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+  if (data == MAP_FAILED) {
+    close(fd_);
+    throw Exception("can't map the db file");
+  }
+  mapping_ = static_cast<char *>(data);
+  mapping_size_ = size;
+}
+
+MmapDiskManager::~MmapDiskManager() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+  close(fd_);
+}
+
+auto MmapDiskManager::CheckExists(const std::string &db_file) -> const std::string & {
+  struct stat stat_buf;
+  if (stat(db_file.c_str(), &stat_buf) != 0) {
+    throw Exception("db file " + db_file + " does not exist");
+  }
+  return db_file;
+}
+
+void MmapDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  throw Exception(fmt::format("can't write page {}: the db file is opened read-only", page_id));
+}
+
+void MmapDiskManager::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  if (!pages.empty()) {
+    WritePage(pages.front().first, pages.front().second);
+  }
+}
+
+auto MmapDiskManager::PinMappedPage(page_id_t page_id) -> const char * {
+  if (page_id < 0 || PageOffset(page_id + 1) > mapping_size_) {
+    return nullptr;
+  }
+  return mapping_ + PageOffset(page_id);
+}
+
+}  // namespace bustub
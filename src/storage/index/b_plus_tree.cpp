@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -11,61 +16,76 @@
 namespace bustub {
 
 
-/* Returns first index of key where next index is greater than param key.
-   Returns index after size_ if param key is bigger than all in page. */
+/* In-page search: returns the first index from begin on whose key is greater than key if upper, or not less than it
+   otherwise. Keys are compared in their normalized form, see GenericComparator: the search key is normalized once,
+   and every probe normalizes no more than the columns of the first eight bytes of its key, its head, and compares the
+   heads as integers. Only keys whose head is that of the search key are normalized in full and compared on the rest
+   of their bytes. Keys that are not normalized are compared with the comparator. Pages read optimistically may be
+   torn: the result is then some index in [begin, size]. */
 template <typename BPlusTreePageType, typename KeyType, typename KeyComparator>
-int FindKeyIndexBefore(BPlusTreePageType *page, KeyType key, KeyComparator comparator) {
-  int i = 0;
-  for (; i < page->GetSize()-1; i++) {
-    if (comparator(page->KeyAt(i + 1), key) == 1) 
-      return i;
+int SearchPage(BPlusTreePageType *page, int begin, const KeyType &key, const KeyComparator &comparator, bool upper) {
+  const size_t normalized_size = comparator.GetNormalizedSize();
+  typename KeyComparator::NormalizedKey search_key{};
+  typename KeyComparator::NormalizedKey page_key{};
+  uint64_t search_head = 0;
+  if (normalized_size != 0) {
+    comparator.Normalize(key, &search_key);
+    search_head = KeyComparator::Head(search_key, 0);
   }
-  return i + 1;
+  auto compare = [&](int index) {
+    if (normalized_size == 0) {
+      return comparator(page->KeyAt(index), key);
+    }
+    const uint64_t head = comparator.NormalizeHead(page->KeyAt(index));
+    if (head != search_head) {
+      return head < search_head ? -1 : 1;
+    }
+    if (normalized_size <= sizeof(uint64_t)) {
+      return 0;
+    }
+    comparator.Normalize(page->KeyAt(index), &page_key);
+    return memcmp(page_key.data() + sizeof(uint64_t), search_key.data() + sizeof(uint64_t),
+                  normalized_size - sizeof(uint64_t));
+  };
+
+  int low = begin;
+  int high = std::max(page->GetSize(), begin);
+  while (low < high) {
+    const int mid = low + (high - low) / 2;
+    const int cmp = compare(mid);
+    if (cmp < 0 || (upper && cmp == 0)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
 }
 
 
-/* Returns index to insert key so it's inserted in sorted way */
+/* Returns the first index whose key is not less than key, i.e. where key is or would be inserted in sorted order.
+   Returns size_ if key is bigger than all in page. */
 template <typename BPlusTreePageType, typename KeyType, typename KeyComparator>
-int FindKeyIndexBeforeLeaf(BPlusTreePageType *page, KeyType key, KeyComparator comparator) {
-  if (page->GetSize() == 0)
-    return 0;
-  int i = 0;
-  for (; i < page->GetSize(); i++) {
-    /* If KeyAt(i) >= key ... */
-    if (comparator(page->KeyAt(i), key) == 1 || 
-        comparator(page->KeyAt(i), key) == 1) {
-        return i;  
-      }
-  }
-  return i;
+int FindKeyIndexBeforeLeaf(BPlusTreePageType *page, const KeyType &key, const KeyComparator &comparator) {
+  return SearchPage(page, 0, key, comparator, false);
 }
 
 
+/* Returns the last guidepost index whose key is not greater than key, or the first index (invalid key) if there is
+   none. */
 template <typename BPlusTreePageType, typename KeyType, typename KeyComparator>
-int FindGuidepostIndexInternal(BPlusTreePageType *page, KeyType key, KeyComparator comparator) {
-  /* If first guidepost is greater than key looking for, return first key (invalid key) */
-  if (comparator(page->KeyAt(1), key) == 1) {
-    return 0;
-  }
-  /* Return first guidepost index where next guidepost is greater than key. 
-     Return last index if no others satisfy. */
-  int i = 1;
-  for (; i < page->GetSize()-1; i++) {
-    if (comparator(page->KeyAt(i + 1), key) == 1) 
-      return i;
-  }
-  return i;
+int FindGuidepostIndexInternal(BPlusTreePageType *page, const KeyType &key, const KeyComparator &comparator) {
+  return std::max(SearchPage(page, 1, key, comparator, true), 1) - 1;
 }
 
 
 /* Returns index of key that matches param key if in page.
    Returns -1 if key not in page. */
 template <typename BPlusTreePageType, typename KeyType, typename KeyComparator>
-int FindKey(BPlusTreePageType *page, KeyType key, KeyComparator comparator) {
-  int i = 0;
-  for (; i < page->GetSize(); i++) {
-    if (comparator(page->KeyAt(i), key) == 0) 
-      return i;
+int FindKey(BPlusTreePageType *page, const KeyType &key, const KeyComparator &comparator) {
+  const int i = SearchPage(page, 0, key, comparator, false);
+  if (i < page->GetSize() && comparator(page->KeyAt(i), key) == 0) {
+    return i;
   }
   return -1;
 }
@@ -74,90 +94,105 @@ int FindKey(BPlusTreePageType *page, KeyType key, KeyComparator comparator) {
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
-                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
+                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size,
+                          bool open_existing)
     : index_name_(std::move(name)),
       bpm_(buffer_pool_manager),
       comparator_(std::move(comparator)),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size),
       header_page_id_(header_page_id) {
-  // WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
-  // auto root_page = guard.AsMut<BPlusTreeHeaderPage>();
-  // root_page->root_page_id_ = INVALID_PAGE_ID;
   INVALID_KEY.SetFromInteger(-69);
-  auto header_page = reinterpret_cast<BPlusTreeHeaderPage*>(bpm_->FetchPage(header_page_id)->GetData());
-  bpm_->NewPage(&header_page->root_page_id_);
-  LeafPage* root_page = reinterpret_cast<LeafPage*>(bpm_->FetchPage(header_page->root_page_id_)->GetData());
-  root_page->Init();
-  bpm_->UnpinPage(header_page->root_page_id_, true);
-  bpm_->UnpinPage(header_page_id, true);
-  size_ = 0;
+  if (open_existing) {
+    return;
+  }
+  WritePageGuard header_guard = bpm_->FetchPageWrite(header_page_id_);
+  auto header_page = header_guard.AsMut<BPlusTreeHeaderPage>();
+  WritePageGuard root_guard = NewPageWrite(&header_page->root_page_id_, header_page_id_);
+  root_guard.AsMut<LeafPage>()->Init(leaf_max_size_);
 }
 
 
+/* The descent starts at the header page and keeps it latched until the root is, so that it never follows a root page
+   id that a split of the root is replacing. */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::GetMaxLeafPageId() -> page_id_t {
-  page_id_t current_page_id = GetRootPageId();
-  auto page = reinterpret_cast<InternalPage*>(bpm_->FetchPage(current_page_id)->GetData());
-  while (!page->IsLeafPage()) {
-    int index = page->GetSize() - 1;
-    InternalPage *prev_page = page;
-    current_page_id = prev_page->ValueAt(index);
-    page = reinterpret_cast<InternalPage*>(bpm_->FetchPage(current_page_id)->GetData());
-    bpm_->UnpinPage(current_page_id, false);
+auto BPLUSTREE_TYPE::FindLeafRead(const KeyType *key) -> ReadPageGuard {
+  ReadPageGuard parent_guard = bpm_->FetchPageRead(header_page_id_);
+  ReadPageGuard guard = bpm_->FetchPageRead(parent_guard.As<BPlusTreeHeaderPage>()->root_page_id_);
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    auto page = guard.As<InternalPage>();
+    int index = 0;
+    if (key != nullptr) {
+      index = FindGuidepostIndexInternal<const InternalPage,KeyType,KeyComparator>(page, *key, comparator_);
+    }
+    ReadPageGuard child_guard = bpm_->FetchPageRead(page->ValueAt(index));
+    parent_guard = std::move(guard);
+    guard = std::move(child_guard);
   }
-  return current_page_id;
+  return guard;
 }
 
 
+/* Optimistic lock coupling: no page latch or pin is taken on the way down. Every page is read through an
+   OptimisticReadGuard. A parent is validated before the child id read from it is fetched, so that a torn or stale id,
+   e.g. of a page that was just deleted or past the end of the file, is never loaded into the pool, and again once the
+   child is fetched, so that the parent still pointed to it then. Sizes read from a page are bounded before they index
+   it, since the page may be torn until it is validated. */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::GetLeafPageId(KeyType key) -> page_id_t {
-  auto page = reinterpret_cast<InternalPage*>(bpm_->FetchPage(GetRootPageId())->GetData());
-  page_id_t current_page_id;
-
-  while (!page->IsLeafPage()) {
-    int index = FindGuidepostIndexInternal<InternalPage,KeyType,KeyComparator>(page, key, comparator_);
-    InternalPage *prev_page = page;
-    current_page_id = prev_page->ValueAt(index);
-    page = reinterpret_cast<InternalPage*>(bpm_->FetchPage(current_page_id)->GetData());
-    bpm_->UnpinPage(current_page_id, false);
+auto BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType &key) -> OptimisticReadGuard {
+  OptimisticReadGuard header_guard = bpm_->FetchPageOptimistic(header_page_id_);
+  page_id_t page_id = header_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (page_id < 0 || !header_guard.Validate()) {
+    return {};
+  }
+  OptimisticReadGuard guard = bpm_->FetchPageOptimistic(page_id);
+  if (!guard.IsValid() || !header_guard.Validate()) {
+    return {};
+  }
+  header_guard.Drop();
+  while (true) {
+    auto page = guard.As<InternalPage>();
+    const bool is_leaf = page->IsLeafPage();
+    const int size = page->GetSize();
+    if (size < 0 || size > (is_leaf ? MAX_LEAF_ENTRIES : MAX_INTERNAL_ENTRIES)) {
+      return {};
+    }
+    if (is_leaf) {
+      return guard;
+    }
+    int index = FindGuidepostIndexInternal<const InternalPage,KeyType,KeyComparator>(page, key, comparator_);
+    page_id = index >= 0 && index < size ? page->ValueAt(index) : INVALID_PAGE_ID;
+    if (page_id < 0 || !guard.Validate()) {
+      return {};
+    }
+    OptimisticReadGuard child_guard = bpm_->FetchPageOptimistic(page_id);
+    if (!child_guard.IsValid() || !guard.Validate()) {
+      return {};
+    }
+    guard = std::move(child_guard);
   }
-  return current_page_id;
 }
 
 
-
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::GetLeafPage(KeyType key, std::vector<page_id_t> &page_path) -> page_id_t {
-  /* Start searching at root page */
-  auto page = reinterpret_cast<InternalPage*>(bpm_->FetchPage(GetRootPageId())->GetData());
-  page_path.push_back(GetRootPageId());
-  while (!page->IsLeafPage()) {
-    int index = FindGuidepostIndexInternal<InternalPage,KeyType,KeyComparator>(page, key, comparator_);
-    InternalPage *prev_page = page;
-    page_id_t current_page_id = prev_page->ValueAt(index);
-    page_path.push_back(current_page_id);
-    page = reinterpret_cast<InternalPage*>(bpm_->FetchPage(current_page_id)->GetData());
-    bpm_->UnpinPage(current_page_id, false);
+auto BPLUSTREE_TYPE::NewPageWrite(page_id_t *page_id, page_id_t hint, BufferRing *ring) -> WritePageGuard {
+  Page *page = bpm_->NewPage(page_id, hint, ring);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame for a new B+ tree page");
   }
-  page_id_t leaf_page_id = page_path.back();
-  page_path.pop_back();
-  return leaf_page_id;
+  page->WLatch();
+  return {bpm_, page};
 }
 
 
-
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::IsEmpty() -> bool {
-  auto root_page_id = GetRootPageId();
-  auto root_page = reinterpret_cast<LeafPage*>(bpm_->FetchPage(root_page_id)->GetData());
-  if (root_page->GetSize() > 0) {
-    return false;
-  }
-  return true;
+  ReadPageGuard header_guard = bpm_->FetchPageRead(header_page_id_);
+  ReadPageGuard root_guard = bpm_->FetchPageRead(header_guard.As<BPlusTreeHeaderPage>()->root_page_id_);
+  return root_guard.As<BPlusTreePage>()->GetSize() == 0;
 }
 
 
@@ -172,19 +207,143 @@ auto BPLUSTREE_TYPE::IsEmpty() -> bool {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn) -> bool {
-  // Declaration of context instance.
-  Context ctx;
-  (void)ctx;
-  std::vector<page_id_t> page_path;
-  auto leaf_page_id = GetLeafPage(key, page_path);
-  auto leaf_page = reinterpret_cast<LeafPage*>(bpm_->FetchPage(leaf_page_id)->GetData());
-  int index = FindKey<LeafPage,KeyType,KeyComparator>(leaf_page, key, comparator_);
+  /* Descend without page latches first, see FindLeafOptimistic. The leaf is read like the pages above it and the
+     lookup is retried if a writer changed the leaf in the meantime. A lookup that keeps losing to writers crabs down
+     with read latches instead, which writers have to wait for. */
+  for (int attempt = 0; attempt < BPLUS_TREE_OPTIMISTIC_ATTEMPTS; attempt++) {
+    OptimisticReadGuard guard = FindLeafOptimistic(key);
+    if (!guard.IsValid()) {
+      continue;
+    }
+    auto leaf_page = guard.As<LeafPage>();
+    int index = FindKey<const LeafPage,KeyType,KeyComparator>(leaf_page, key, comparator_);
+    std::optional<ValueType> value;
+    if (index != -1) {
+      value = leaf_page->ValueAt(index);
+    }
+    if (!guard.Validate()) {
+      continue;
+    }
+    if (value.has_value()) {
+      *result = {*value};
+      return true;
+    }
+    *result = {};
+    return false;
+  }
+
+  num_latched_lookups_.fetch_add(1, std::memory_order_relaxed);
+  ReadPageGuard guard = FindLeafRead(&key);
+  auto leaf_page = guard.As<LeafPage>();
+  int index = FindKey<const LeafPage,KeyType,KeyComparator>(leaf_page, key, comparator_);
+  if (index == -1) {
+    *result = {};
+    return false;
+  }
+  *result = {leaf_page->ValueAt(index)};
+  return true;
+}
+
+
+/*
+ * Every lookup tries the optimistic path up to BPLUS_TREE_OPTIMISTIC_ATTEMPTS times, like GetValue, and then falls back
+ * to GetValue itself.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::optional<ValueType>> *result,
+                               Transaction *txn) -> size_t {
+  result->assign(keys.size(), std::nullopt);
+  LookupPath path;
+  size_t num_found = 0;
+  for (size_t i = 0; i < keys.size(); i++) {
+    bool done = false;
+    for (int attempt = 0; attempt < BPLUS_TREE_OPTIMISTIC_ATTEMPTS && !done; attempt++) {
+      done = GetValueOnPath(keys[i], &path, &(*result)[i]);
+    }
+    std::vector<ValueType> values;
+    if (!done && GetValue(keys[i], &values, txn)) {
+      (*result)[i] = values[0];
+    }
+    num_found += (*result)[i].has_value() ? 1 : 0;
+  }
+  return num_found;
+}
+
+/* The descent is the one of FindLeafOptimistic, except that the guards stay on the path. A page that is kept for the
+   next key is validated again when its data is used: before and after a child is fetched from it, or, for the leaf,
+   after the search. The range of a page only changes by a split, merge or borrow that latches the page itself, so a page whose
+   guard still validates still covers the range it was reached with. */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetValueOnPath(const KeyType &key, LookupPath *path, std::optional<ValueType> *value) -> bool {
+  auto fail = [path] {
+    while (!path->guards_.empty()) {
+      path->Pop();
+    }
+    return false;
+  };
+  while (!path->guards_.empty() &&
+         ((path->lower_.back().has_value() && comparator_(key, *path->lower_.back()) < 0) ||
+          (path->upper_.back().has_value() && comparator_(key, *path->upper_.back()) >= 0))) {
+    path->Pop();
+  }
+
+  if (path->guards_.empty()) {
+    OptimisticReadGuard header_guard = bpm_->FetchPageOptimistic(header_page_id_);
+    const page_id_t root_page_id = header_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (root_page_id < 0 || !header_guard.Validate()) {
+      return false;
+    }
+    OptimisticReadGuard root_guard = bpm_->FetchPageOptimistic(root_page_id);
+    if (!root_guard.IsValid() || !header_guard.Validate()) {
+      return false;
+    }
+    path->Push(std::move(root_guard), std::nullopt, std::nullopt);
+  }
+
+  while (true) {
+    auto page = path->guards_.back().template As<InternalPage>();
+    const int size = page->GetSize();
+    const bool is_leaf = page->IsLeafPage();
+    if (size < 0 || size > (is_leaf ? MAX_LEAF_ENTRIES : MAX_INTERNAL_ENTRIES)) {
+      return fail();
+    }
+    if (is_leaf) {
+      break;
+    }
+    int index = FindGuidepostIndexInternal<const InternalPage,KeyType,KeyComparator>(page, key, comparator_);
+    if (index < 0 || index >= size) {
+      return fail();
+    }
+    const page_id_t child_page_id = page->ValueAt(index);
+    std::optional<KeyType> lower = path->lower_.back();
+    std::optional<KeyType> upper = path->upper_.back();
+    if (index > 0) {
+      lower = page->KeyAt(index);
+    }
+    if (index + 1 < size) {
+      upper = page->KeyAt(index + 1);
+    }
+    if (child_page_id < 0 || !path->guards_.back().Validate()) {
+      return fail();
+    }
+    OptimisticReadGuard child_guard = bpm_->FetchPageOptimistic(child_page_id);
+    if (!child_guard.IsValid() || !path->guards_.back().Validate()) {
+      return fail();
+    }
+    path->Push(std::move(child_guard), std::move(lower), std::move(upper));
+  }
+
+  auto leaf_page = path->guards_.back().template As<LeafPage>();
+  int index = FindKey<const LeafPage,KeyType,KeyComparator>(leaf_page, key, comparator_);
+  std::optional<ValueType> found;
   if (index != -1) {
-    *result = {leaf_page->ValueAt(index)};
-    return true;
+    found = leaf_page->ValueAt(index);
+  }
+  if (!path->guards_.back().Validate()) {
+    return fail();
   }
-  *result = {};
-  return false;
+  *value = found;
+  return true;
 }
 
 
@@ -203,85 +362,179 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *txn) -> bool {
   // Declaration of context instance.
   Context ctx;
-  (void)ctx;
-  
-  /* Saved order in which pages were traversed to reach leaf_page.
-     Does not include leaf_page. (last one is parent of it.) */
-  std::vector<page_id_t> page_path;
-  auto leaf_page_id = GetLeafPage(key, page_path);
-  auto leaf_page = reinterpret_cast<LeafPage*>(bpm_->FetchPage(leaf_page_id)->GetData());
-
-  if (leaf_page->GetSize() < leaf_page->GetMaxSize()) { /* If not full */
-    /* Check if duplicate, return false if it is, insert and return true if not. */
-    int index = FindKeyIndexBeforeLeaf<LeafPage,KeyType,KeyComparator>(leaf_page, key, comparator_);
-    if (index > 0 && comparator_(leaf_page->KeyAt(index-1), key) == 0) 
-      return false;
-    leaf_page->Insert(key, value, index);
-  } else {
-    /* Split leaf page (TODO: make split recursive) */
-    std::tuple<page_id_t,page_id_t,KeyType> leaf_page_tuple = SplitLeafNode(leaf_page_id);
-    page_id_t left_page_id = std::get<0>(leaf_page_tuple);
-    page_id_t right_page_id = std::get<1>(leaf_page_tuple);
-    KeyType key_middle = std::get<2>(leaf_page_tuple);
-    LeafPage* left_page_ptr = reinterpret_cast<LeafPage*>(bpm_->FetchPage(left_page_id)->GetData());
-    LeafPage* right_page_ptr = reinterpret_cast<LeafPage*>(bpm_->FetchPage(right_page_id)->GetData());
-
-    UpdateParent(left_page_id, right_page_id, key_middle, page_path);
-    left_page_ptr->SetNextPageId(right_page_id);
-    right_page_ptr->SetNextPageId(leaf_page->GetNextPageId());
-
-    KeyType left_page_end_key = left_page_ptr->KeyAt(left_page_ptr->GetSize()-1);
-    LeafPage* target_page;
-    /* If end key in left page is smaller or equal to key. */
-    if (comparator_(left_page_end_key, key) == 1 || comparator_(left_page_end_key, key) == 0) {
-      target_page = left_page_ptr;
-    } else {
-      target_page = right_page_ptr;
-    }
-    size_t index = (size_t)FindKeyIndexBeforeLeaf<LeafPage,KeyType,KeyComparator>(target_page, key, comparator_);
-    target_page->Insert(key, value, index);
-    // TODO unpin left_page_ptr and right_page_ptr
+  std::optional<bool> inserted = InsertOptimistic(key, value, &ctx);
+  if (!inserted.has_value()) {
+    inserted = InsertPessimistic(key, value, &ctx);
   }
-  size_ ++;
-  return true;
-  /*
-   - Look for biggest key that is less than or equal to key searching for 
-   - Follow pointer to level below and repeat recursively until at leaf layer
-   - Search for kbiggest key that is less than or equal to insert key and insert
-     key-value at that location
-   - if leaf layer full then need to split current ndoe into two and move
-     middle value to layer above. The value moved should point to newly made node. 
-     Repeat this recursively if layer above is also filled.
-
-  */
+  if (*inserted) {
+    size_++;
+  }
+  return *inserted;
 }
 
 
 
+/* Crabs down with read latches like a lookup, but write-latches the leaf. The parent of the leaf stays read-latched
+   while the read latch of the leaf is traded for the write latch: a leaf only splits or merges under the write latch
+   of its parent, so it still covers key then. */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafWrite(const KeyType &key, Context *ctx, bool *is_root) -> WritePageGuard {
+  ctx->read_set_.push_back(bpm_->FetchPageRead(header_page_id_));
+  page_id_t page_id = ctx->read_set_.back().As<BPlusTreeHeaderPage>()->root_page_id_;
+  ctx->read_set_.push_back(bpm_->FetchPageRead(page_id));
+  *is_root = true;
+  while (!ctx->read_set_.back().As<BPlusTreePage>()->IsLeafPage()) {
+    auto page = ctx->read_set_.back().As<InternalPage>();
+    int index = FindGuidepostIndexInternal<const InternalPage,KeyType,KeyComparator>(page, key, comparator_);
+    page_id = page->ValueAt(index);
+    ctx->read_set_.push_back(bpm_->FetchPageRead(page_id));
+    ctx->read_set_.pop_front();
+    *is_root = false;
+  }
+  ctx->read_set_.pop_back();
+  WritePageGuard guard = bpm_->FetchPageWrite(page_id);
+  ctx->read_set_.clear();
+  return guard;
+}
+
+
 
+/* Most inserts find room in their leaf and need nothing but the leaf exclusively. */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::UpdateParent(page_id_t left_page_id, page_id_t right_page_id,
-                  KeyType key_middle, std::vector<page_id_t> page_path) -> void {
-  page_id_t parent_page_id;
-  if (page_path.size() > 0) { /* Add middle elem to parent page */
-      parent_page_id = page_path.back();
-      page_path.pop_back();
-      auto parent_page = reinterpret_cast<InternalPage*>(bpm_->FetchPage(parent_page_id)->GetData());
-      parent_page->SetPageType(IndexPageType::INTERNAL_PAGE);
-      int index = FindGuidepostIndexInternal<InternalPage,KeyType,KeyComparator>(parent_page, key_middle, comparator_);
-      /* Old guidepost points to left_page_ptr now and key_middle guidepost points to right_page_ptr */
-      parent_page->Replace(parent_page->KeyAt(index), left_page_id, index);
-      parent_page->Insert(key_middle, right_page_id, index+1);
+auto BPLUSTREE_TYPE::InsertOptimistic(const KeyType &key, const ValueType &value, Context *ctx)
+    -> std::optional<bool> {
+  bool is_root;
+  WritePageGuard guard = FindLeafWrite(key, ctx, &is_root);
+  auto leaf_page = guard.As<LeafPage>();
+  int index = FindKeyIndexBeforeLeaf<const LeafPage,KeyType,KeyComparator>(leaf_page, key, comparator_);
+  if (index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0) {
+    return false;
+  }
+  if (leaf_page->GetSize() >= leaf_page->GetMaxSize()) {
+    return std::nullopt;
+  }
+  guard.AsMut<LeafPage>()->Insert(key, value, index);
+  return true;
+}
+
 
-    } else { /* Create new page that is now parent page and add middle elem */
-      InternalPage* parent_page = reinterpret_cast<InternalPage*>(bpm_->NewPage(&parent_page_id)->GetData());
-      parent_page->Init();
-      /* Initialise invalid key ptr to point to left_page_ptr and first guidepost to point to right_page_ptr */
-      parent_page->Insert(key_middle, left_page_id, 0);
-      parent_page->Insert(key_middle, right_page_id, 1);
-      SetRootPageId(parent_page_id);
+
+/* Latch crabbing with write latches. A page is safe if it has room for one more entry, since a split below it then
+   stops at it; once a safe page is latched, the latches of all pages above it, the header page included, are
+   released. What is left in ctx is the chain of full pages that the insert may split, below the page that takes the
+   last separator. */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertPessimistic(const KeyType &key, const ValueType &value, Context *ctx) -> bool {
+  ctx->header_page_ = bpm_->FetchPageWrite(header_page_id_);
+  ctx->root_page_id_ = ctx->header_page_->As<BPlusTreeHeaderPage>()->root_page_id_;
+  page_id_t page_id = ctx->root_page_id_;
+  while (true) {
+    WritePageGuard guard = bpm_->FetchPageWrite(page_id);
+    auto page = guard.As<InternalPage>();
+    if (page->GetSize() < page->GetMaxSize()) {
+      ctx->header_page_ = std::nullopt;
+      ctx->write_set_.clear();
+    }
+    const bool is_leaf = page->IsLeafPage();
+    if (!is_leaf) {
+      int index = FindGuidepostIndexInternal<const InternalPage,KeyType,KeyComparator>(page, key, comparator_);
+      page_id = page->ValueAt(index);
     }
-    bpm_->UnpinPage(parent_page_id, true);
+    ctx->write_set_.push_back(std::move(guard));
+    if (is_leaf) {
+      break;
+    }
+  }
+
+  WritePageGuard leaf_guard = std::move(ctx->write_set_.back());
+  ctx->write_set_.pop_back();
+  auto leaf_page = leaf_guard.As<LeafPage>();
+  int index = FindKeyIndexBeforeLeaf<const LeafPage,KeyType,KeyComparator>(leaf_page, key, comparator_);
+  if (index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0) {
+    return false;
+  }
+  if (leaf_page->GetSize() < leaf_page->GetMaxSize()) {
+    leaf_guard.AsMut<LeafPage>()->Insert(key, value, index);
+    return true;
+  }
+
+  /* Split the leaf: the lower half of its entries and the new one stays, the upper half moves to a new right sibling,
+     placed next to the leaf on disk so that range scans read them sequentially. */
+  std::vector<MappingType> entries;
+  entries.reserve(leaf_page->GetSize() + 1);
+  for (int i = 0; i < leaf_page->GetSize(); i++) {
+    entries.push_back(leaf_page->KeyValueAt(i));
+  }
+  entries.insert(entries.begin() + index, {key, value});
+
+  page_id_t right_page_id;
+  WritePageGuard right_guard = NewPageWrite(&right_page_id, leaf_guard.PageId());
+  auto right_page = right_guard.AsMut<LeafPage>();
+  right_page->Init(leaf_max_size_);
+  auto left_page = leaf_guard.AsMut<LeafPage>();
+  const size_t left_size = (entries.size() + 1) / 2;
+  left_page->SetSize(0);
+  for (size_t i = 0; i < entries.size(); i++) {
+    LeafPage *page = i < left_size ? left_page : right_page;
+    page->Insert(entries[i].first, entries[i].second, page->GetSize());
+  }
+  right_page->SetNextPageId(left_page->GetNextPageId());
+  left_page->SetNextPageId(right_page_id);
+
+  InsertIntoParent(ctx, leaf_guard.PageId(), right_page->KeyAt(0), right_page_id);
+  return true;
+}
+
+
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParent(Context *ctx, page_id_t left_page_id, const KeyType &key,
+                                      page_id_t right_page_id) {
+  if (ctx->write_set_.empty()) {
+    /* The root split: grow the tree by a level. The header page is still latched, since a full root is not safe. */
+    BUSTUB_ASSERT(ctx->header_page_.has_value(), "a split reached the root without the header page latched");
+    page_id_t root_page_id;
+    WritePageGuard root_guard = NewPageWrite(&root_page_id, left_page_id);
+    auto root_page = root_guard.AsMut<InternalPage>();
+    root_page->Init(internal_max_size_);
+    /* The invalid key ptr points to the left page and the first guidepost to the right page */
+    root_page->Insert(key, left_page_id, 0);
+    root_page->Insert(key, right_page_id, 1);
+    ctx->header_page_->AsMut<BPlusTreeHeaderPage>()->root_page_id_ = root_page_id;
+    ctx->root_page_id_ = root_page_id;
+    return;
+  }
+
+  WritePageGuard parent_guard = std::move(ctx->write_set_.back());
+  ctx->write_set_.pop_back();
+  auto parent_page = parent_guard.AsMut<InternalPage>();
+  const int index = parent_page->ValueIndex(left_page_id) + 1;
+  if (parent_page->GetSize() < parent_page->GetMaxSize()) {
+    parent_page->Insert(key, right_page_id, index);
+    return;
+  }
+
+  /* Split the parent like a leaf. The key of the first entry of the new sibling moves up as its separator; within the
+     sibling it becomes the invalid key. */
+  std::vector<std::pair<KeyType, page_id_t>> entries;
+  entries.reserve(parent_page->GetSize() + 1);
+  for (int i = 0; i < parent_page->GetSize(); i++) {
+    entries.emplace_back(parent_page->KeyAt(i), parent_page->ValueAt(i));
+  }
+  entries.insert(entries.begin() + index, {key, right_page_id});
+
+  page_id_t sibling_page_id;
+  WritePageGuard sibling_guard = NewPageWrite(&sibling_page_id, parent_guard.PageId());
+  auto sibling_page = sibling_guard.AsMut<InternalPage>();
+  sibling_page->Init(internal_max_size_);
+  const size_t left_size = (entries.size() + 1) / 2;
+  parent_page->SetSize(0);
+  for (size_t i = 0; i < entries.size(); i++) {
+    InternalPage *page = i < left_size ? parent_page : sibling_page;
+    page->Insert(entries[i].first, entries[i].second, page->GetSize());
+  }
+
+  InsertIntoParent(ctx, parent_guard.PageId(), sibling_page->KeyAt(0), sibling_page_id);
 }
 
 
@@ -300,36 +553,317 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
   // Declaration of context instance.
   Context ctx;
-  (void)ctx;
-  size_ --;
-  /* IMPORTANT: Insert() relies on compacting leaf array when removing an element. */
-  /* IMPORTANT: Ensure next_page_id_ is updated including to -1 to prev leaf page 
-                if removed leaf page is end one. */
+  std::optional<bool> removed = RemoveOptimistic(key, &ctx);
+  if (!removed.has_value()) {
+    removed = RemovePessimistic(key, &ctx);
+  }
+  if (*removed) {
+    size_--;
+  }
 }
 
 
 
+/* Most removes leave their leaf above its minimum size and need nothing but the leaf exclusively. A root leaf has no
+   minimum size. */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::SplitLeafNode(page_id_t leaf_page_id) -> std::tuple<page_id_t,page_id_t,KeyType> {
-  auto leaf_page = reinterpret_cast<LeafPage*>(bpm_->FetchPage(leaf_page_id)->GetData());
-  int index_middle = (int)leaf_page->GetSize() / 2;
-  KeyType key_middle = leaf_page->KeyAt(index_middle);
-  page_id_t right_page_id;
-  auto right_page_ptr = reinterpret_cast<LeafPage*>(bpm_->NewPage(&right_page_id)->GetData());
-  right_page_ptr->Init();
-  for (int i=0; i < (int)leaf_page->GetSize(); i ++) {
-    
-    if (i >= index_middle) {
-      right_page_ptr->Insert(leaf_page->KeyAt(i), leaf_page->ValueAt(i), right_page_ptr->GetSize());
+auto BPLUSTREE_TYPE::RemoveOptimistic(const KeyType &key, Context *ctx) -> std::optional<bool> {
+  bool is_root;
+  WritePageGuard guard = FindLeafWrite(key, ctx, &is_root);
+  auto leaf_page = guard.As<LeafPage>();
+  int index = FindKey<const LeafPage,KeyType,KeyComparator>(leaf_page, key, comparator_);
+  if (index == -1) {
+    return false;
+  }
+  if (!is_root && leaf_page->GetSize() <= leaf_page->GetMinSize()) {
+    return std::nullopt;
+  }
+  guard.AsMut<LeafPage>()->Remove(index);
+  return true;
+}
+
+
+
+/* Latch crabbing with write latches, like InsertPessimistic. Here a page is safe if it stays at or above its minimum
+   size without one of its entries, since a merge below it then stops at it. The root has no minimum size, but an
+   internal root that is left with one child is collapsed, so it is only safe with three or more. */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemovePessimistic(const KeyType &key, Context *ctx) -> bool {
+  ctx->header_page_ = bpm_->FetchPageWrite(header_page_id_);
+  ctx->root_page_id_ = ctx->header_page_->As<BPlusTreeHeaderPage>()->root_page_id_;
+  page_id_t page_id = ctx->root_page_id_;
+  while (true) {
+    WritePageGuard guard = bpm_->FetchPageWrite(page_id);
+    auto page = guard.As<InternalPage>();
+    const bool is_leaf = page->IsLeafPage();
+    int min_size = page->GetMinSize();
+    if (ctx->IsRootPage(page_id)) {
+      min_size = is_leaf ? 0 : 2;
+    }
+    if (page->GetSize() > min_size) {
+      ctx->header_page_ = std::nullopt;
+      ctx->write_set_.clear();
+    }
+    if (!is_leaf) {
+      int index = FindGuidepostIndexInternal<const InternalPage,KeyType,KeyComparator>(page, key, comparator_);
+      page_id = page->ValueAt(index);
+    }
+    ctx->write_set_.push_back(std::move(guard));
+    if (is_leaf) {
+      break;
     }
   }
-  leaf_page->SetSize(index_middle - 1);
-  bpm_->UnpinPage(right_page_id, true);
-  return {leaf_page_id, right_page_id, key_middle};
+
+  auto leaf_page = ctx->write_set_.back().As<LeafPage>();
+  int index = FindKey<const LeafPage,KeyType,KeyComparator>(leaf_page, key, comparator_);
+  if (index == -1) {
+    return false;
+  }
+  ctx->write_set_.back().AsMut<LeafPage>()->Remove(index);
+  RebalanceAfterRemove(ctx);
+  return true;
 }
 
 
 
+/* A page below its minimum size borrows an entry from a sibling that has more than its own minimum. Otherwise the
+   two pages are merged into the left one, the right one is returned to the buffer pool, and the parent loses their
+   separator, which may take the parent below its minimum in turn. */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RebalanceAfterRemove(Context *ctx) {
+  while (true) {
+    WritePageGuard node_guard = std::move(ctx->write_set_.back());
+    ctx->write_set_.pop_back();
+    const page_id_t node_page_id = node_guard.PageId();
+    auto node = node_guard.As<BPlusTreePage>();
+    const bool is_leaf = node->IsLeafPage();
+
+    if (ctx->IsRootPage(node_page_id)) {
+      if (!is_leaf && node->GetSize() == 1) {
+        /* The root is left with a single child, which becomes the root: the tree shrinks by a level. The header page
+           is still latched, since an internal root with two children is not safe. */
+        BUSTUB_ASSERT(ctx->header_page_.has_value(), "the root collapsed without the header page latched");
+        ctx->root_page_id_ = node_guard.As<InternalPage>()->ValueAt(0);
+        ctx->header_page_->AsMut<BPlusTreeHeaderPage>()->root_page_id_ = ctx->root_page_id_;
+        node_guard.Drop();
+        bpm_->DeletePage(node_page_id);
+      }
+      return;
+    }
+    if (node->GetSize() >= node->GetMinSize()) {
+      return;
+    }
+
+    /* Take the right sibling if there is one. Latches are taken from left to right, like iterators do, so the page is
+       released before its left sibling is latched; nothing can change it meanwhile, since that takes the write latch
+       of the parent. */
+    auto parent = ctx->write_set_.back().AsMut<InternalPage>();
+    const int index = parent->ValueIndex(node_page_id);
+    const bool node_is_left = index + 1 < parent->GetSize();
+    const int right_index = node_is_left ? index + 1 : index;
+    WritePageGuard left_guard;
+    WritePageGuard right_guard;
+    if (node_is_left) {
+      left_guard = std::move(node_guard);
+      right_guard = bpm_->FetchPageWrite(parent->ValueAt(right_index));
+    } else {
+      node_guard.Drop();
+      left_guard = bpm_->FetchPageWrite(parent->ValueAt(index - 1));
+      right_guard = bpm_->FetchPageWrite(node_page_id);
+    }
+    auto sibling = (node_is_left ? right_guard : left_guard).As<BPlusTreePage>();
+    const bool borrow = sibling->GetSize() > sibling->GetMinSize();
+
+    if (is_leaf) {
+      auto left = left_guard.AsMut<LeafPage>();
+      auto right = right_guard.AsMut<LeafPage>();
+      if (borrow && node_is_left) {
+        left->Insert(right->KeyAt(0), right->ValueAt(0), left->GetSize());
+        right->Remove(0);
+      } else if (borrow) {
+        right->Insert(left->KeyAt(left->GetSize() - 1), left->ValueAt(left->GetSize() - 1), 0);
+        left->Remove(left->GetSize() - 1);
+      } else {
+        for (int i = 0; i < right->GetSize(); i++) {
+          left->Insert(right->KeyAt(i), right->ValueAt(i), left->GetSize());
+        }
+        left->SetNextPageId(right->GetNextPageId());
+      }
+      if (borrow) {
+        parent->SetKeyAt(right_index, right->KeyAt(0));
+      }
+    } else {
+      /* The separator in the parent comes down as the key of the first child of the right page, and the key that
+         moves up replaces it. */
+      auto left = left_guard.AsMut<InternalPage>();
+      auto right = right_guard.AsMut<InternalPage>();
+      if (borrow && node_is_left) {
+        left->Insert(parent->KeyAt(right_index), right->ValueAt(0), left->GetSize());
+        parent->SetKeyAt(right_index, right->KeyAt(1));
+        right->Remove(0);
+      } else if (borrow) {
+        const int last = left->GetSize() - 1;
+        right->SetKeyAt(0, parent->KeyAt(right_index));
+        right->Insert(left->KeyAt(last), left->ValueAt(last), 0);
+        parent->SetKeyAt(right_index, left->KeyAt(last));
+        left->Remove(last);
+      } else {
+        left->Insert(parent->KeyAt(right_index), right->ValueAt(0), left->GetSize());
+        for (int i = 1; i < right->GetSize(); i++) {
+          left->Insert(right->KeyAt(i), right->ValueAt(i), left->GetSize());
+        }
+      }
+    }
+    if (borrow) {
+      return;
+    }
+
+    /* A page that is still pinned, e.g. by a prefetch, cannot be deleted; it is then left unused in the file. */
+    const page_id_t right_page_id = right_guard.PageId();
+    parent->Remove(right_index);
+    right_guard.Drop();
+    bpm_->DeletePage(right_page_id);
+  }
+}
+
+
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/* Fills one level of a bulk-loaded tree from left to right, each page up to fill_factor of max_size entries before the
+   next one is started. The last two pages stay latched so that Finish can even them out. */
+template <typename PageType, typename KeyType, typename ValueType, typename KeyComparator>
+class BulkLoadLevel {
+ public:
+  using NewPage = std::function<WritePageGuard(page_id_t *, page_id_t)>;
+
+  BulkLoadLevel(NewPage new_page, int max_size, double fill_factor)
+      : new_page_(std::move(new_page)), max_size_(max_size), fill_factor_(fill_factor) {}
+
+  /* Appends an entry after all the entries so far, starting a new page if the last one is filled. */
+  void Append(const KeyType &key, const ValueType &value) {
+    if (last_ == nullptr || last_->GetSize() >= fill_size_) {
+      page_id_t page_id;
+      WritePageGuard guard = new_page_(&page_id, last_ == nullptr ? INVALID_PAGE_ID : last_guard_.PageId());
+      auto page = guard.template AsMut<PageType>();
+      page->Init(max_size_);
+      fill_size_ = std::clamp(static_cast<int>(max_size_ * fill_factor_), std::max(page->GetMinSize(), 1), max_size_);
+      if constexpr (IS_LEAF) {
+        if (last_ != nullptr) {
+          last_->SetNextPageId(page_id);
+        }
+      }
+      before_last_guard_ = std::move(last_guard_);
+      before_last_ = last_;
+      last_guard_ = std::move(guard);
+      last_ = page;
+      pages_.emplace_back(key, page_id);
+    }
+    last_->Insert(key, value, last_->GetSize());
+  }
+
+  /* Brings the last page up to its minimum size with entries from the page before it, or merges the two if there
+     are not enough entries for both. A level of one page is the root, which has no minimum size. Returns the first
+     key and the page id of every page of the level. */
+  auto Finish(BufferPoolManager *bpm) -> std::vector<std::pair<KeyType, page_id_t>> {
+    if (before_last_ != nullptr && last_->GetSize() < last_->GetMinSize()) {
+      if (before_last_->GetSize() + last_->GetSize() >= 2 * last_->GetMinSize()) {
+        while (last_->GetSize() < last_->GetMinSize()) {
+          const int index = before_last_->GetSize() - 1;
+          last_->Insert(before_last_->KeyAt(index), before_last_->ValueAt(index), 0);
+          before_last_->Remove(index);
+        }
+        pages_.back().first = last_->KeyAt(0);
+      } else {
+        for (int i = 0; i < last_->GetSize(); i++) {
+          before_last_->Insert(last_->KeyAt(i), last_->ValueAt(i), before_last_->GetSize());
+        }
+        if constexpr (IS_LEAF) {
+          before_last_->SetNextPageId(INVALID_PAGE_ID);
+        }
+        const page_id_t last_page_id = last_guard_.PageId();
+        last_guard_.Drop();
+        bpm->DeletePage(last_page_id);
+        pages_.pop_back();
+      }
+    }
+    before_last_guard_.Drop();
+    last_guard_.Drop();
+    return std::move(pages_);
+  }
+
+ private:
+  static constexpr bool IS_LEAF = std::is_same_v<PageType, BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>;
+
+  NewPage new_page_;
+  int max_size_;
+  double fill_factor_;
+  int fill_size_{0};
+  WritePageGuard before_last_guard_;
+  WritePageGuard last_guard_;
+  PageType *before_last_{nullptr};
+  PageType *last_{nullptr};
+  std::vector<std::pair<KeyType, page_id_t>> pages_;
+};
+
+/*
+ * The leaves are filled as the entries come in, and every level above is built from the first keys and page ids of
+ * the level below it, until a level fits in one page: the root.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor,
+                              BufferRing *ring) -> size_t {
+  /* The header stays latched throughout, so that nobody finds the tree before it is complete. */
+  WritePageGuard header_guard = bpm_->FetchPageWrite(header_page_id_);
+  auto header_page = header_guard.AsMut<BPlusTreeHeaderPage>();
+  const page_id_t empty_root_page_id = header_page->root_page_id_;
+  if (bpm_->FetchPageRead(empty_root_page_id).As<BPlusTreePage>()->GetSize() != 0) {
+    throw Exception("bulk load into a B+ tree that is not empty");
+  }
+
+  auto new_page = [this, ring](page_id_t *page_id, page_id_t hint) { return NewPageWrite(page_id, hint, ring); };
+  BulkLoadLevel<LeafPage, KeyType, ValueType, KeyComparator> leaves(new_page, leaf_max_size_, fill_factor);
+  KeyType key;
+  ValueType value;
+  KeyType last_key;
+  size_t num_entries = 0;
+  while (next(&key, &value)) {
+    if (num_entries > 0) {
+      const int cmp = comparator_(last_key, key);
+      if (cmp > 0) {
+        throw Exception("bulk load entries are not in ascending key order");
+      }
+      if (cmp == 0) {
+        continue;
+      }
+    }
+    leaves.Append(key, value);
+    last_key = key;
+    num_entries++;
+  }
+  if (num_entries == 0) {
+    return 0;
+  }
+
+  std::vector<std::pair<KeyType, page_id_t>> level = leaves.Finish(bpm_);
+  while (level.size() > 1) {
+    BulkLoadLevel<InternalPage, KeyType, page_id_t, KeyComparator> parents(new_page, internal_max_size_, fill_factor);
+    for (const auto &[first_key, page_id] : level) {
+      parents.Append(first_key, page_id);
+    }
+    level = parents.Finish(bpm_);
+  }
+
+  header_page->root_page_id_ = level[0].second;
+  header_guard.Drop();
+  /* A reader that latched the empty root before the header was latched may still have it pinned; the page is then
+     left unused in the file. */
+  bpm_->DeletePage(empty_root_page_id);
+  size_ += num_entries;
+  return num_entries;
+}
+
 /*****************************************************************************
  * INDEX ITERATOR
  *****************************************************************************/
@@ -340,9 +874,7 @@ auto BPLUSTREE_TYPE::SplitLeafNode(page_id_t leaf_page_id) -> std::tuple<page_id
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-  KeyType index_key;
-  index_key.SetFromInteger(0);
-  return {bpm_, {GetLeafPageId(index_key), 0}};
+  return {bpm_, FindLeafRead(nullptr), 0};
 }
 
 
@@ -350,19 +882,13 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
 /*
  * Input parameter is low key, find the leaf page that contains the input key
  * first, then construct index iterator
- * @return : index iterator
+ * @return : index iterator at the first key not less than the low key
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { 
-  std::vector<page_id_t> page_path;
-  auto leaf_page_id = GetLeafPage(key, page_path);
-  auto leaf_page = reinterpret_cast<LeafPage*>(bpm_->FetchPage(leaf_page_id)->GetData());
-  for (int offset=0; offset < leaf_page->GetSize(); offset++) {
-    if (comparator_(leaf_page->KeyAt(offset), key) == 0) {
-      return {bpm_, {leaf_page_id, offset}};
-    }
-  }
-  return INDEXITERATOR_TYPE(); 
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  ReadPageGuard guard = FindLeafRead(&key);
+  int index = FindKeyIndexBeforeLeaf<const LeafPage,KeyType,KeyComparator>(guard.As<LeafPage>(), key, comparator_);
+  return {bpm_, std::move(guard), static_cast<size_t>(index)};
 }
 
 /*
@@ -371,10 +897,8 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { 
-  page_id_t max_leaf_page_id = GetMaxLeafPageId();
-  LeafPage* max_leaf_page = reinterpret_cast<LeafPage*>(bpm_->FetchPage(max_leaf_page_id)->GetData());
-  return {bpm_, {max_leaf_page_id, max_leaf_page->GetSize()}};
+auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
+  return {bpm_, {INVALID_PAGE_ID, 0}};
 }
 
 
@@ -384,17 +908,14 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
-  auto header_page = reinterpret_cast<BPlusTreeHeaderPage*>(bpm_->FetchPage(header_page_id_)->GetData());
-  page_id_t root_page_id = header_page->root_page_id_;
-  bpm_->UnpinPage(header_page_id_, false);
-  return root_page_id;
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  return guard.As<BPlusTreeHeaderPage>()->root_page_id_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::SetRootPageId(page_id_t root_page_id) {
-  auto header_page = reinterpret_cast<BPlusTreeHeaderPage*>(bpm_->FetchPage(header_page_id_)->GetData());
-  header_page->root_page_id_ = root_page_id;
-  bpm_->UnpinPage(header_page_id_, true);
+  WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
+  guard.AsMut<BPlusTreeHeaderPage>()->root_page_id_ = root_page_id;
 }
 
 
@@ -438,9 +959,8 @@ void BPLUSTREE_TYPE::RemoveFromFile(const std::string &file_name, Transaction *t
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Print(BufferPoolManager *bpm) {
   auto root_page_id = GetRootPageId();
-  // auto guard = bpm->FetchPageBasic(root_page_id);
-  auto root_page = reinterpret_cast<BPlusTreePage*>(bpm_->FetchPage(root_page_id)->GetData());
-  PrintTree(root_page_id, root_page);
+  auto guard = bpm->FetchPageBasic(root_page_id);
+  PrintTree(root_page_id, guard.template As<BPlusTreePage>());
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -475,9 +995,8 @@ void BPLUSTREE_TYPE::PrintTree(page_id_t page_id, const BPlusTreePage *page) {
     std::cout << std::endl;
     std::cout << std::endl;
     for (int i = 0; i < internal->GetSize(); i++) {
-      // auto guard = bpm_->FetchPageBasic(internal->ValueAt(i));
-      auto* page = reinterpret_cast<BPlusTreePage*>(bpm_->FetchPage(internal->ValueAt(i))->GetData());
-      PrintTree(internal->ValueAt(i), page);
+      auto guard = bpm_->FetchPageBasic(internal->ValueAt(i));
+      PrintTree(internal->ValueAt(i), guard.template As<BPlusTreePage>());
     }
   }
 }
@@ -495,9 +1014,8 @@ void BPLUSTREE_TYPE::Draw(BufferPoolManager *bpm, const std::string &outf) {
   std::ofstream out(outf);
   out << "digraph G {" << std::endl;
   auto root_page_id = GetRootPageId();
-  // auto guard = bpm->FetchPageBasic(root_page_id);
-  auto* root_page = reinterpret_cast<BPlusTreePage*>(bpm_->FetchPage(root_page_id)->GetData());
-  ToGraph(root_page_id, root_page, out);
+  auto guard = bpm->FetchPageBasic(root_page_id);
+  ToGraph(root_page_id, guard.template As<BPlusTreePage>(), out);
   out << "}" << std::endl;
   out.close();
 }
@@ -562,15 +1080,13 @@ void BPLUSTREE_TYPE::ToGraph(page_id_t page_id, const BPlusTreePage *page, std::
     out << "</TABLE>>];\n";
     // Print leaves
     for (int i = 0; i < inner->GetSize(); i++) {
-      // auto child_guard = bpm_->FetchPageBasic(inner->ValueAt(i));
+      auto child_guard = bpm_->FetchPageBasic(inner->ValueAt(i));
       page_id_t child_page_id = inner->ValueAt(i);
-      // auto child_page = child_guard.template As<BPlusTreePage>();
-      auto* child_page = reinterpret_cast<BPlusTreePage*>(bpm_->FetchPage(inner->ValueAt(i))->GetData());
+      auto child_page = child_guard.template As<BPlusTreePage>();
       ToGraph(inner->ValueAt(i), child_page, out);
       if (i > 0) {
-        // auto sibling_guard = bpm_->FetchPageBasic(inner->ValueAt(i - 1));
-        // auto sibling_page = sibling_guard.template As<BPlusTreePage>();
-        auto sibling_page = reinterpret_cast<BPlusTreePage*>(bpm_->FetchPage(inner->ValueAt(i - 1))->GetData());
+        auto sibling_guard = bpm_->FetchPageBasic(inner->ValueAt(i - 1));
+        auto sibling_page = sibling_guard.template As<BPlusTreePage>();
         page_id_t sibling_page_id = inner->ValueAt(i - 1);
         if (!sibling_page->IsLeafPage() && !child_page->IsLeafPage()) {
           out << "{rank=same " << internal_prefix << sibling_page_id << " " << internal_prefix
@@ -602,14 +1118,12 @@ auto BPLUSTREE_TYPE::DrawBPlusTree() -> std::string {
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::ToPrintableBPlusTree(page_id_t root_id) -> PrintableBPlusTree {
-  // auto root_page_guard = bpm_->FetchPageBasic(root_id);
-  // auto root_page = root_page_guard.template As<BPlusTreePage>();
-  auto root_page = reinterpret_cast<BPlusTreePage*>(bpm_->FetchPage(root_id)->GetData());
+  auto root_page_guard = bpm_->FetchPageBasic(root_id);
+  auto root_page = root_page_guard.template As<BPlusTreePage>();
   PrintableBPlusTree proot;
 
   if (root_page->IsLeafPage()) {
-    // auto leaf_page = root_page_guard.template As<LeafPage>();
-    auto leaf_page = reinterpret_cast<LeafPage*>(root_page);
+    auto leaf_page = root_page_guard.template As<LeafPage>();
     proot.keys_ = leaf_page->ToString();
     proot.size_ = proot.keys_.size() + 4;  // 4 more spaces for indent
 
@@ -617,8 +1131,7 @@ auto BPLUSTREE_TYPE::ToPrintableBPlusTree(page_id_t root_id) -> PrintableBPlusTr
   }
 
   // draw internal page
-  // auto internal_page = root_page_guard.template As<InternalPage>();
-  auto internal_page = reinterpret_cast<InternalPage*>(root_page);
+  auto internal_page = root_page_guard.template As<InternalPage>();
   proot.keys_ = internal_page->ToString();
   proot.size_ = 0;
   for (int i = 0; i < internal_page->GetSize(); i++) {
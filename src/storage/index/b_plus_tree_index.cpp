@@ -11,6 +11,9 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include "buffer/buffer_ring.h"
+#include "storage/index/external_sorter.h"
+
 namespace bustub {
 /*
  * Constructor
@@ -51,6 +54,43 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_->GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i]);
+  }
+  std::vector<std::optional<ValueType>> values;
+  container_->GetValues(index_keys, &values, transaction);
+
+  results->resize(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    (*results)[i].clear();
+    if (values[i].has_value()) {
+      (*results)[i].push_back(*values[i]);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(Tuple *, RID *)> &next, Transaction *transaction,
+                                    double fill_factor, size_t sort_memory_bytes) -> size_t {
+  ExternalSorter<KeyType, ValueType, KeyComparator> sorter(comparator_, sort_memory_bytes);
+  Tuple key;
+  RID rid;
+  KeyType index_key;
+  while (next(&key, &rid)) {
+    index_key.SetFromKey(key);
+    sorter.Add(index_key, rid);
+  }
+
+  // the new pages are written once and not read again for a while, so they should not crowd out the pool
+  auto ring = BufferRing::OfBytes(BULK_WRITE_RING_BYTES);
+  return container_->BulkLoad([&sorter](KeyType *key, ValueType *value) { return sorter.Next(key, value); },
+                              fill_factor, &ring);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_->Begin(); }
 
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.cpp
+//
+// Identification: src/storage/index/external_sorter.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/external_sorter.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+ExternalSorter<KeyType, ValueType, KeyComparator>::ExternalSorter(const KeyComparator &comparator, size_t memory_bytes)
+    : comparator_(comparator), memory_pairs_(std::max<size_t>(1, memory_bytes / sizeof(MappingType))) {
+  static_assert(std::is_trivially_copyable_v<KeyType> && std::is_trivially_copyable_v<ValueType>,
+                "runs are written to disk byte for byte");
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ExternalSorter<KeyType, ValueType, KeyComparator>::~ExternalSorter() {
+  for (auto &run : runs_) {
+    std::fclose(run.file_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ExternalSorter<KeyType, ValueType, KeyComparator>::Add(const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(!merging_, "pairs cannot be added once the merge started");
+  if (memory_.size() == memory_pairs_) {
+    Spill();
+  }
+  memory_.emplace_back(key, value);
+  num_pairs_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ExternalSorter<KeyType, ValueType, KeyComparator>::SortMemory() {
+  std::stable_sort(memory_.begin(), memory_.end(), [this](const MappingType &a, const MappingType &b) {
+    return comparator_(a.first, b.first) < 0;
+  });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ExternalSorter<KeyType, ValueType, KeyComparator>::Spill() {
+  SortMemory();
+  // tmpfile unlinks the file right away, so that it goes away with the sorter or the process
+  std::FILE *file = std::tmpfile();
+  if (file == nullptr) {
+    throw Exception("can't create a temporary file to spill a sorted run to");
+  }
+  if (std::fwrite(memory_.data(), sizeof(MappingType), memory_.size(), file) != memory_.size()) {
+    std::fclose(file);
+    throw Exception("can't write a sorted run to its temporary file");
+  }
+  std::rewind(file);
+  runs_.push_back({file, memory_.size(), {}});
+  memory_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ExternalSorter<KeyType, ValueType, KeyComparator>::Refill(Run *run) {
+  // the runs share a budget as large as the one for the pairs in memory
+  const size_t buffer_pairs = std::max<size_t>(1, memory_pairs_ / runs_.size());
+  run->buffer_.resize(std::min(buffer_pairs, run->num_unread_));
+  if (std::fread(run->buffer_.data(), sizeof(MappingType), run->buffer_.size(), run->file_) != run->buffer_.size()) {
+    throw Exception("can't read a sorted run back from its temporary file");
+  }
+  run->num_unread_ -= run->buffer_.size();
+  run->next_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ExternalSorter<KeyType, ValueType, KeyComparator>::Current(size_t source) const -> const MappingType & {
+  if (source == runs_.size()) {
+    return memory_[memory_next_];
+  }
+  const Run &run = runs_[source];
+  return run.buffer_[run.next_];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ExternalSorter<KeyType, ValueType, KeyComparator>::Advance(size_t source) -> bool {
+  if (source == runs_.size()) {
+    return ++memory_next_ < memory_.size();
+  }
+  Run &run = runs_[source];
+  if (++run.next_ < run.buffer_.size()) {
+    return true;
+  }
+  if (run.num_unread_ == 0) {
+    run.buffer_ = {};
+    return false;
+  }
+  Refill(&run);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ExternalSorter<KeyType, ValueType, KeyComparator>::Next(KeyType *key, ValueType *value) -> bool {
+  if (!merging_) {
+    merging_ = true;
+    SortMemory();
+    for (size_t source = 0; source < runs_.size(); source++) {
+      Refill(&runs_[source]);
+      heap_.push(source);
+    }
+    if (!memory_.empty()) {
+      heap_.push(runs_.size());
+    }
+  }
+  if (heap_.empty()) {
+    return false;
+  }
+  const size_t source = heap_.top();
+  heap_.pop();
+  *key = Current(source).first;
+  *value = Current(source).second;
+  if (Advance(source)) {
+    heap_.push(source);
+  }
+  return true;
+}
+
+template class ExternalSorter<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSorter<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSorter<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSorter<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSorter<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -17,41 +17,68 @@ INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager* bpm, std::pair<page_id_t,size_t> pos) {
-    // b_plus_tree_ = associated_b_plus_tree;
     bpm_ = bpm;
     pos_ = pos;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager* bpm, ReadPageGuard &&guard, size_t offset)
+    : bpm_(bpm), guard_(std::move(guard)) {
+    pos_ = {guard_.PageId(), offset};
+    PrefetchNextLeaf();
+    MoveToNextLeaf();
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::IsEnd() -> bool {
-    LeafPage* page = reinterpret_cast<LeafPage*>(bpm_->FetchPage(pos_.first)->GetData());
-    if (page->GetNextPageId() == -1 && (int)pos_.second == page->GetSize()-1) {
-        return true;
-    }
-    return false;
+    return pos_.first == INVALID_PAGE_ID;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
-    LeafPage* page = reinterpret_cast<LeafPage*>(bpm_->FetchPage(pos_.first)->GetData());
-    return page->KeyValueAt((int)pos_.second);
-
+    return guard_.As<LeafPage>()->KeyValueAt(static_cast<int>(pos_.second));
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
-    LeafPage* page = reinterpret_cast<LeafPage*>(bpm_->FetchPage(pos_.first)->GetData());
-    if ((int)pos_.second >= page->GetSize()) {
-        pos_ = {page->GetNextPageId(), 0};
-    } else {
-        pos_.second ++;
-    }
+    pos_.second++;
+    MoveToNextLeaf();
     return *this;
 }
 
+/*
+ * Crabs to the right: the next leaf is latched before the current one is released, so that a split of the current
+ * leaf cannot move keys past the iterator. Writers latch leaves left to right as well. Empty leaves are skipped. Past
+ * the last key of the last leaf the iterator releases the leaf and becomes End(), which holds no latch, so that
+ * comparing with End() never waits for a writer.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::MoveToNextLeaf() {
+    while (pos_.second >= static_cast<size_t>(guard_.As<LeafPage>()->GetSize())) {
+        page_id_t next_page_id = guard_.As<LeafPage>()->GetNextPageId();
+        if (next_page_id == INVALID_PAGE_ID) {
+            guard_.Drop();
+            pos_ = {INVALID_PAGE_ID, 0};
+            return;
+        }
+        ReadPageGuard next_guard = bpm_->FetchPageRead(next_page_id);
+        guard_ = std::move(next_guard);
+        pos_ = {next_page_id, 0};
+        PrefetchNextLeaf();
+    }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::PrefetchNextLeaf() {
+    page_id_t next_page_id = guard_.As<LeafPage>()->GetNextPageId();
+    if (next_page_id != INVALID_PAGE_ID) {
+        bpm_->Prefetch({next_page_id});
+    }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const -> bool {
     if (pos_.first == itr.GetPos().first && pos_.second == itr.GetPos().second) {
@@ -28,24 +28,28 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(int max_size) {
   memset(array_, 0, INTERNAL_PAGE_SIZE);
   SetSize(0);
   SetPageType(IndexPageType::INTERNAL_PAGE);
-  SetMaxSize(INTERNAL_PAGE_SIZE);
+  SetMaxSize(max_size);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Insert(KeyType key, const ValueType &value, size_t index) {
-  if (index >= INTERNAL_PAGE_SIZE)
+  if (index > static_cast<size_t>(GetSize()) || static_cast<size_t>(GetSize()) >= INTERNAL_PAGE_SIZE)
     return;
-  
-  MappingType* temp_arr = (MappingType*) malloc(GetMaxSize() - index);
-  std::memcpy(temp_arr, &array_[index], GetMaxSize() - index);
-    
-  if ((int)index != GetSize()) 
-    std::memcpy(&array_[index+1], temp_arr, GetMaxSize() - index);
 
+  std::memmove(&array_[index + 1], &array_[index], (GetSize() - index) * sizeof(MappingType));
   array_[index] = {key, value};
   SetSize(GetSize() + 1);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(size_t index) {
+  if (index >= static_cast<size_t>(GetSize()))
+    return;
+
+  std::memmove(&array_[index], &array_[index + 1], (GetSize() - index - 1) * sizeof(MappingType));
+  SetSize(GetSize() - 1);
+}
+
 /**
  * @brief Replaces whatever is at index with key,val pair.
  * 
@@ -75,6 +79,19 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
   array_[index].first = key;
 }
 
+/*
+ * Helper method to find the index of the child pointer value, -1 if the page
+ * does not point to it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < GetSize(); i++) {
+    if (array_[i].second == value)
+      return i;
+  }
+  return -1;
+}
+
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
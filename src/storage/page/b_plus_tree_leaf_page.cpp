@@ -58,30 +58,34 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
 
 
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) -> ValueType {
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType {
   return array_[index].second;
 }
 
-INDEX_TEMPLATE_ARGUMENTS 
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyValueAt(int index) -> const MappingType& {
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyValueAt(int index) const -> const MappingType & {
   return array_[index];
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, size_t index) {
-  if (index >= LEAF_PAGE_SIZE)
+  if (index > static_cast<size_t>(GetSize()) || static_cast<size_t>(GetSize()) >= LEAF_PAGE_SIZE)
     return;
-  
-  MappingType* temp_arr = (MappingType*) malloc(GetMaxSize() - index);
-  std::memcpy(temp_arr, &array_[index], GetMaxSize() - index);
-    
-  if ((int)index != GetSize()) 
-    std::memcpy(&array_[index+1], temp_arr, GetMaxSize() - index);
 
+  std::memmove(&array_[index + 1], &array_[index], (GetSize() - index) * sizeof(MappingType));
   array_[index] = {key, value};
   SetSize(GetSize() + 1);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Remove(size_t index) {
+  if (index >= static_cast<size_t>(GetSize()))
+    return;
+
+  std::memmove(&array_[index], &array_[index + 1], (GetSize() - index - 1) * sizeof(MappingType));
+  SetSize(GetSize() - 1);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::PrintArray() {
   std::cout << "array_ (KeyType, ValueType): " << std::endl;
@@ -50,10 +50,12 @@ void BPlusTreePage::SetMaxSize(int size) {
 
 /*
  * Helper method to get min page size
- * Generally, min page size == max page size / 2
+ * Generally, min page size == max page size / 2. An internal page counts its
+ * child pointers and rounds up, so that it keeps at least two of them and two
+ * pages at the minimum less one still fit into one page when merged.
  */
 auto BPlusTreePage::GetMinSize() const -> int {
-    return max_size_ / 2;
+    return IsLeafPage() ? max_size_ / 2 : (max_size_ + 1) / 2;
 }
 
 }  // namespace bustub
@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksum.cpp
+//
+// Identification: src/storage/page/page_checksum.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/page_checksum.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/util/crc32c.h"
+
+namespace bustub {
+
+auto PageChecksum::Compute(page_id_t page_id, const char *page_data) -> uint32_t {
+  const uint32_t crc = Crc32c::Value(reinterpret_cast<const char *>(&page_id), sizeof(page_id));
+  return Crc32c::Extend(crc, page_data, BUSTUB_PAGE_DATA_SIZE);
+}
+
+void PageChecksum::Stamp(page_id_t page_id, char *page_data) {
+  const uint32_t checksum = Compute(page_id, page_data);
+  memcpy(page_data + OFFSET_CHECKSUM, &checksum, sizeof(checksum));
+}
+
+auto PageChecksum::Verify(page_id_t page_id, const char *page_data) -> bool {
+  if (GetStored(page_data) == Compute(page_id, page_data)) {
+    return true;
+  }
+  // only scanned on a mismatch, so that verifying a written page costs a single pass
+  return std::all_of(page_data, page_data + BUSTUB_PAGE_SIZE, [](char byte) { return byte == 0; });
+}
+
+auto PageChecksum::GetStored(const char *page_data) -> uint32_t {
+  uint32_t checksum;
+  memcpy(&checksum, page_data + OFFSET_CHECKSUM, sizeof(checksum));
+  return checksum;
+}
+
+}  // namespace bustub
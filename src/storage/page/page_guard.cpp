@@ -1,30 +1,152 @@
 #include "storage/page/page_guard.h"
+
+#include <atomic>
+
 #include "buffer/buffer_pool_manager.h"
+#include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
-BasicPageGuard::BasicPageGuard(BasicPageGuard &&that) noexcept {}
+BasicPageGuard::BasicPageGuard(BasicPageGuard &&that) noexcept
+    : bpm_(that.bpm_), page_(that.page_), is_dirty_(that.is_dirty_) {
+  that.bpm_ = nullptr;
+  that.page_ = nullptr;
+  that.is_dirty_ = false;
+}
 
-void BasicPageGuard::Drop() {}
+void BasicPageGuard::Drop() {
+  if (bpm_ != nullptr && page_ != nullptr) {
+    bpm_->UnpinPage(page_->GetPageId(), is_dirty_);
+  }
+  bpm_ = nullptr;
+  page_ = nullptr;
+  is_dirty_ = false;
+}
 
-auto BasicPageGuard::operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard & { return *this; }
+auto BasicPageGuard::operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard & {
+  if (this != &that) {
+    Drop();
+    bpm_ = that.bpm_;
+    page_ = that.page_;
+    is_dirty_ = that.is_dirty_;
+    that.bpm_ = nullptr;
+    that.page_ = nullptr;
+    that.is_dirty_ = false;
+  }
+  return *this;
+}
 
-BasicPageGuard::~BasicPageGuard(){};  // NOLINT
+BasicPageGuard::~BasicPageGuard() { Drop(); };  // NOLINT
 
-ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept
+    : guard_(std::move(that.guard_)),
+      mapped_disk_manager_(that.mapped_disk_manager_),
+      mapped_page_id_(that.mapped_page_id_),
+      mapped_data_(that.mapped_data_) {
+  that.mapped_disk_manager_ = nullptr;
+  that.mapped_page_id_ = INVALID_PAGE_ID;
+  that.mapped_data_ = nullptr;
+}
 
-auto ReadPageGuard::operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard & { return *this; }
+auto ReadPageGuard::operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard & {
+  if (this != &that) {
+    Drop();
+    guard_ = std::move(that.guard_);
+    mapped_disk_manager_ = that.mapped_disk_manager_;
+    mapped_page_id_ = that.mapped_page_id_;
+    mapped_data_ = that.mapped_data_;
+    that.mapped_disk_manager_ = nullptr;
+    that.mapped_page_id_ = INVALID_PAGE_ID;
+    that.mapped_data_ = nullptr;
+  }
+  return *this;
+}
 
-void ReadPageGuard::Drop() {}
+void ReadPageGuard::Drop() {
+  // release the latch before the pin: once unpinned, the frame may be reused for another page
+  if (guard_.page_ != nullptr) {
+    guard_.page_->RUnlatch();
+  }
+  guard_.Drop();
+  if (mapped_data_ != nullptr) {
+    mapped_disk_manager_->UnpinMappedPage(mapped_page_id_);
+  }
+  mapped_disk_manager_ = nullptr;
+  mapped_page_id_ = INVALID_PAGE_ID;
+  mapped_data_ = nullptr;
+}
 
-ReadPageGuard::~ReadPageGuard() {}  // NOLINT
+ReadPageGuard::~ReadPageGuard() { Drop(); }  // NOLINT
 
 WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept = default;
 
-auto WritePageGuard::operator=(WritePageGuard &&that) noexcept -> WritePageGuard & { return *this; }
+auto WritePageGuard::operator=(WritePageGuard &&that) noexcept -> WritePageGuard & {
+  if (this != &that) {
+    Drop();
+    guard_ = std::move(that.guard_);
+  }
+  return *this;
+}
+
+void WritePageGuard::Drop() {
+  if (guard_.page_ != nullptr) {
+    guard_.page_->WUnlatch();
+  }
+  guard_.Drop();
+}
+
+WritePageGuard::~WritePageGuard() { Drop(); }  // NOLINT
+
+EpochReadGuard::EpochReadGuard(EpochReadGuard &&that) noexcept : page_(that.page_) { that.page_ = nullptr; }
+
+auto EpochReadGuard::operator=(EpochReadGuard &&that) noexcept -> EpochReadGuard & {
+  if (this != &that) {
+    Drop();
+    page_ = that.page_;
+    that.page_ = nullptr;
+  }
+  return *this;
+}
+
+void EpochReadGuard::Drop() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+  }
+  page_ = nullptr;
+}
+
+EpochReadGuard::~EpochReadGuard() { Drop(); }  // NOLINT
+
+OptimisticReadGuard::OptimisticReadGuard(OptimisticReadGuard &&that) noexcept
+    : page_(that.page_), version_(that.version_), mapped_(std::move(that.mapped_)) {
+  that.page_ = nullptr;
+}
+
+auto OptimisticReadGuard::operator=(OptimisticReadGuard &&that) noexcept -> OptimisticReadGuard & {
+  if (this != &that) {
+    Drop();
+    page_ = that.page_;
+    version_ = that.version_;
+    mapped_ = std::move(that.mapped_);
+    that.page_ = nullptr;
+  }
+  return *this;
+}
+
+void OptimisticReadGuard::Drop() {
+  page_ = nullptr;
+  mapped_.Drop();
+}
 
-void WritePageGuard::Drop() {}
+OptimisticReadGuard::~OptimisticReadGuard() { Drop(); }  // NOLINT
 
-WritePageGuard::~WritePageGuard() {}  // NOLINT
+auto OptimisticReadGuard::Validate() const -> bool {
+  if (page_ == nullptr) {
+    return mapped_.IsMapped();
+  }
+  // keep the reads of the page from moving below the version check
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return page_->GetVersion() == version_;
+}
 
 }  // namespace bustub
@@ -18,8 +18,8 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferRing *ring)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn), ring_(ring) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_)) {
       throw bustub::Exception("read non-existing tuple");
@@ -47,11 +47,17 @@ auto TableIterator::operator++() -> TableIterator & {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page = static_cast<TablePage *>(
+          buffer_pool_manager->FetchPage(cur_page->GetNextPageId(), AccessType::Scan, ring_));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
+      // Read the page after this one while the tuples of this page are consumed. Read-ahead lands in the whole pool,
+      // so scans confined to a ring do without.
+      if (ring_ == nullptr && cur_page->GetNextPageId() != INVALID_PAGE_ID) {
+        buffer_pool_manager->Prefetch({cur_page->GetNextPageId()});
+      }
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
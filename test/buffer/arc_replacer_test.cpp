@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+#include "common/exception.h"
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: load pages 100..103 into frames 0..3. They all start in T1.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    arc_replacer.RecordAccess(frame_id, AccessType::Get, 100 + frame_id);
+    arc_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(4, arc_replacer.Size());
+
+  // Scenario: a second access moves frame 0 to T2, so T1 is evicted first.
+  arc_replacer.RecordAccess(0, AccessType::Get, 100);
+  int value;
+  ASSERT_EQ(true, arc_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: page 101 comes back while it is in B1. It goes to T2 and T1 gets a target size of 1.
+  arc_replacer.RecordAccess(1, AccessType::Get, 101);
+  arc_replacer.SetEvictable(1, true);
+  ASSERT_EQ(true, arc_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  arc_replacer.RecordAccess(2, AccessType::Get, 104);
+  arc_replacer.SetEvictable(2, true);
+  ASSERT_EQ(true, arc_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+
+  // Scenario: T1 is at its target size, so the least recently used frame of T2 goes next.
+  ASSERT_EQ(true, arc_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: page 100 comes back from B2, which shrinks the target size of T1 back to 0.
+  arc_replacer.RecordAccess(0, AccessType::Get, 100);
+  arc_replacer.SetEvictable(0, true);
+  ASSERT_EQ(true, arc_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+
+  // Scenario: pinned frames are skipped. Only frame 0 is evictable.
+  arc_replacer.SetEvictable(1, false);
+  ASSERT_EQ(1, arc_replacer.Size());
+  ASSERT_EQ(true, arc_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(false, arc_replacer.Evict(&value));
+}
+
+TEST(ARCReplacerTest, ScanTest) {
+  ARCReplacer arc_replacer(4);
+  int value;
+
+  // Scenario: rescanning a frame does not move it to T2, so frame 0 is evicted before the point lookup of frame 1.
+  arc_replacer.RecordAccess(0, AccessType::Scan, 100);
+  arc_replacer.RecordAccess(0, AccessType::Scan, 100);
+  arc_replacer.RecordAccess(1, AccessType::Get, 101);
+  arc_replacer.RecordAccess(1, AccessType::Get, 101);
+  arc_replacer.SetEvictable(0, true);
+  arc_replacer.SetEvictable(1, true);
+  ASSERT_EQ(true, arc_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: removing a frame does not remember its page, and removing a pinned frame is an error.
+  arc_replacer.RecordAccess(2, AccessType::Get, 102);
+  EXPECT_THROW(arc_replacer.Remove(2), Exception);
+  arc_replacer.Remove(1);
+  ASSERT_EQ(0, arc_replacer.Size());
+}
+
+}  // namespace bustub
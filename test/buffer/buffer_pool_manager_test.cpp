@@ -10,13 +10,20 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <memory>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/page/page_checksum.h"
 
 namespace bustub {
 
@@ -32,7 +39,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   std::uniform_int_distribution<char> uniform_dist(0);
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -41,19 +48,20 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   ASSERT_NE(nullptr, page0);
   EXPECT_EQ(0, page_id_temp);
 
-  char random_binary_data[BUSTUB_PAGE_SIZE];
+  // the last bytes of a page are reserved for its checksum
+  char random_binary_data[BUSTUB_PAGE_DATA_SIZE];
   // Generate random binary data
   for (char &i : random_binary_data) {
     i = uniform_dist(rng);
   }
 
   // Insert terminal characters both in the middle and at end
-  random_binary_data[BUSTUB_PAGE_SIZE / 2] = '\0';
-  random_binary_data[BUSTUB_PAGE_SIZE - 1] = '\0';
+  random_binary_data[BUSTUB_PAGE_DATA_SIZE / 2] = '\0';
+  random_binary_data[BUSTUB_PAGE_DATA_SIZE - 1] = '\0';
 
   // Scenario: Once we have a page, we should be able to read and write content.
-  std::memcpy(page0->GetData(), random_binary_data, BUSTUB_PAGE_SIZE);
-  EXPECT_EQ(0, std::memcmp(page0->GetData(), random_binary_data, BUSTUB_PAGE_SIZE));
+  std::memcpy(page0->GetData(), random_binary_data, BUSTUB_PAGE_DATA_SIZE);
+  EXPECT_EQ(0, std::memcmp(page0->GetData(), random_binary_data, BUSTUB_PAGE_DATA_SIZE));
 
   // Scenario: We should be able to create new pages until we fill up the buffer pool.
   for (size_t i = 1; i < buffer_pool_size; ++i) {
@@ -79,7 +87,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   }
   // Scenario: We should be able to fetch the data we wrote a while ago.
   page0 = bpm->FetchPage(0);
-  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, BUSTUB_PAGE_DATA_SIZE));
   EXPECT_EQ(true, bpm->UnpinPage(0, true));
 
   // Shutdown the disk manager and remove the temporary file we created.
@@ -97,7 +105,7 @@ TEST(BufferPoolManagerTest, SampleTest) {
   const size_t k = 5;
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -147,4 +155,492 @@ TEST(BufferPoolManagerTest, SampleTest) {
   // delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Every replacement policy must keep pinned pages resident and hand out unpinned frames
+TEST(BufferPoolManagerTest, ReplacerPolicyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::Clock, ReplacerPolicy::LRUK, ReplacerPolicy::ARC,
+                      ReplacerPolicy::TwoQ, ReplacerPolicy::ClockPro}) {
+    SCOPED_TRACE(ReplacerPolicyToString(policy));
+    auto disk_manager = std::make_unique<DiskManager>(db_name);
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), k, nullptr, policy);
+
+    // Scenario: fill the pool, keep page 0 pinned and cycle more pages than there are frames through the rest.
+    page_id_t page_id_temp;
+    auto *page0 = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page0);
+    snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+    for (int i = 1; i < 10; ++i) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", i);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+
+    // Scenario: every page written so far can be fetched back, even after being evicted.
+    for (int i = 1; i < 10; ++i) {
+      auto *page = bpm->FetchPage(i, AccessType::Get);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+    EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+    // Scenario: with every frame pinned, no page can be brought in.
+    for (int i = 1; i < 4; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(nullptr, bpm->FetchPage(5));
+
+    disk_manager->ShutDown();
+    remove("test.db");
+  }
+}
+
+// NOLINTNEXTLINE
+// The background writer should clean unpinned pages so that evicting them does not write in the foreground
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), k);
+  bpm->StartBackgroundWriter(buffer_pool_size);
+
+  // Scenario: fill the pool with dirty pages, then unpin them all.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %zu", i);
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+
+  // Scenario: the writer cleans every unpinned page in the background.
+  for (int tries = 0; tries < 500 && bpm->GetBackgroundWriteCount() < buffer_pool_size; ++tries) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(buffer_pool_size, bpm->GetBackgroundWriteCount());
+
+  // Scenario: new pages now replace clean frames, so no write happens in the foreground.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(0, bpm->GetForegroundWriteCount());
+
+  // Scenario: the pages written in the background can be read back.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(buffer_pool_size + i, false));
+  }
+  bpm->StopBackgroundWriter();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+// Prefetched pages should be served from the buffer pool without a miss
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), k);
+
+  // Scenario: write pages 0..4, then push them out of the pool with ten more pages.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size + 5; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %zu", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: prefetch pages 0..4 and wait for the prefetch thread to load them.
+  bpm->Prefetch({0, 1, 2, 3, 4});
+  for (int tries = 0; tries < 500 && bpm->GetPrefetchCount() < 5; ++tries) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(5, bpm->GetPrefetchCount());
+
+  // Scenario: fetching the prefetched pages does not go to disk, and they are not left pinned.
+  auto misses = bpm->GetMissCount();
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    auto *page = bpm->FetchPage(page_id, AccessType::Scan);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false, AccessType::Scan));
+  }
+  EXPECT_EQ(misses, bpm->GetMissCount());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+// Deleted pages are handed out again by NewPage, and never show their old contents
+TEST(BufferPoolManagerTest, DeletePageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), k);
+
+  // Scenario: write pages 0..3 to disk, then delete page 1.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %zu", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  EXPECT_EQ(true, bpm->DeletePage(1));
+
+  // Scenario: the next new page reuses id 1, and starts out zeroed even after a round trip through the disk.
+  auto *page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(1, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  page = bpm->FetchPage(1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+
+  // Scenario: a page that is no longer in the pool can be deleted too.
+  EXPECT_EQ(true, bpm->DeletePage(0));
+  EXPECT_FALSE(disk_manager->IsPageAllocated(0));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+}
+
+// NOLINTNEXTLINE
+// A deleted page that a late reader fetched again gives way to the new page that reuses its id
+TEST(BufferPoolManagerTest, StaleFrameReuseTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(4, disk_manager.get(), 2);
+
+  page_id_t page_id;
+  for (int i = 0; i < 2; i++) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_DATA_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  EXPECT_EQ(true, bpm->DeletePage(1));
+
+  // Scenario: a reader that read id 1 before the delete fetches the page from disk, and pins it for a while.
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  std::thread reader([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  });
+
+  // Scenario: the new page waits for that pin, then takes id 1 with zeroed contents, and is the page id 1 fetches.
+  auto *page = bpm->NewPage(&page_id);
+  reader.join();
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(1, page_id);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_EQ(page, bpm->FetchPage(1));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_EQ(false, bpm->UnpinPage(1, false));
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+// GetStats counts hits, misses, evictions and write-backs; the heat map counts sampled accesses per page
+TEST(BufferPoolManagerTest, StatsTest) {
+  const size_t buffer_pool_size = 3;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), k);
+
+  // Scenario: The fourth page evicts a dirty page, which has to be written back first.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size + 1; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.pool_size_);
+  EXPECT_EQ(1, stats.evictions_);
+  EXPECT_EQ(1, stats.dirty_write_backs_);
+
+  // Scenario: A resident page is a hit, the evicted page 0 a miss that evicts another page.
+  ASSERT_NE(nullptr, bpm->FetchPage(3));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_DOUBLE_EQ(0.5, stats.GetHitRate());
+
+  // Scenario: With every frame pinned, NewPage and fetching a page that is not resident fail and are counted.
+  ASSERT_NE(nullptr, bpm->FetchPage(3));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(2, bpm->GetStats().all_pinned_);
+
+  // Scenario: The heat map is off until a sampling interval is set, and then ranks pages by their accesses.
+  EXPECT_TRUE(bpm->GetHottestPages(3).empty());
+  bpm->SetHeatMapSampleInterval(1);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(3));
+    EXPECT_EQ(true, bpm->UnpinPage(3, false));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  auto hottest = bpm->GetHottestPages(1);
+  ASSERT_EQ(1, hottest.size());
+  EXPECT_EQ(3, hottest[0].first);
+  EXPECT_EQ(3, hottest[0].second);
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+// Pages fetched and created through a buffer ring recycle the ring's frames instead of evicting other pages
+TEST(BufferPoolManagerTest, BufferRingTest) {
+  const size_t buffer_pool_size = 64;
+  const size_t k = 2;
+  const size_t num_hot_pages = 8;
+  const size_t num_bulk_pages = 200;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: A bulk load through a ring of 4 frames takes 4 frames and then keeps recycling them.
+  BufferRing load_ring(4);
+  std::vector<page_id_t> bulk_pages;
+  for (size_t i = 0; i < num_bulk_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp, INVALID_PAGE_ID, &load_ring);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "bulk %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    bulk_pages.push_back(page_id_temp);
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(num_bulk_pages - 4, stats.evictions_);
+  EXPECT_EQ(num_bulk_pages - 4, stats.dirty_write_backs_);
+
+  // Scenario: A scan through its own ring reads every page back without touching the hot pages.
+  BufferRing scan_ring(4);
+  for (auto page_id : bulk_pages) {
+    auto *page = bpm->FetchPage(page_id, AccessType::Scan, &scan_ring);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("bulk " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false, AccessType::Scan));
+  }
+  auto misses = bpm->GetMissCount();
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_hot_pages); ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(misses, bpm->GetMissCount());
+
+  // Scenario: A ring frame that is still pinned is left alone, and the ring moves on to a fresh frame.
+  BufferRing small_ring(1);
+  page_id_t pinned_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&pinned_page_id, INVALID_PAGE_ID, &small_ring));
+  auto *page = bpm->NewPage(&page_id_temp, INVALID_PAGE_ID, &small_ring);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  EXPECT_EQ(true, bpm->UnpinPage(pinned_page_id, false));
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+// Evicted clean pages are kept compressed in memory, and misses on them are served from there instead of the disk
+TEST(BufferPoolManagerTest, CompressedCacheTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_pages = 16;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), k);
+  bpm->SetCompressedCacheCapacity(num_pages * BUSTUB_PAGE_SIZE);
+
+  // Scenario: Pages pushed out of the pool, mostly zeroed, land in the cache in far less than a page each.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(num_pages - buffer_pool_size, stats.compressed_cache_pages_);
+  EXPECT_LT(stats.compressed_cache_size_, stats.compressed_cache_pages_ * BUSTUB_PAGE_SIZE / 16);
+
+  // Scenario: Every page comes back from the cache with its contents, the last ones after the first pushed them out.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  stats = bpm->GetStats();
+  EXPECT_EQ(num_pages, stats.compressed_cache_hits_);
+  EXPECT_EQ(0, stats.compressed_cache_misses_);
+  EXPECT_DOUBLE_EQ(1.0, stats.GetCompressedCacheHitRate());
+
+  // Scenario: A deleted page is dropped from the cache, and its reused id reads the new page, not the cached one.
+  ASSERT_TRUE(bpm->DeletePage(0));
+  for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  auto *page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, page_id_temp);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: Turning the cache off drops it, and misses go to the disk again.
+  bpm->SetCompressedCacheCapacity(0);
+  EXPECT_EQ(0, bpm->GetStats().compressed_cache_pages_);
+  for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+// Pages are stamped with a checksum on write-back, and a page that comes back from disk damaged is reported
+TEST(BufferPoolManagerTest, ChecksumTest) {
+  const size_t buffer_pool_size = 2;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Evicted pages were written with their checksum and read back without complaint.
+  char data[BUSTUB_PAGE_SIZE];
+  disk_manager->ReadPage(0, data);
+  EXPECT_TRUE(PageChecksum::Verify(0, data));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: A page torn by a write that only got halfway fails its checksum, and the fetch throws.
+  disk_manager->ReadPage(1, data);
+  snprintf(data + BUSTUB_PAGE_SIZE / 2, BUSTUB_PAGE_SIZE / 2, "half of a newer version");
+  disk_manager->WritePage(1, data);
+  EXPECT_THROW(bpm->FetchPage(1), Exception);
+  EXPECT_EQ(1, bpm->GetStats().checksum_failures_);
+
+  // Scenario: The failed fetch did not keep the page, so the next fetch reads it again and fails again.
+  EXPECT_THROW(bpm->FetchPage(1), Exception);
+  EXPECT_EQ(2, bpm->GetChecksumFailureCount());
+
+  // Scenario: With verification off, the damaged page is handed out as it is.
+  bpm->SetVerifyChecksums(false);
+  auto *page = bpm->FetchPage(1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page 1", std::string(page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_EQ(2, bpm->GetChecksumFailureCount());
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+// Flushes that race a writer of the page always leave a copy on disk that matches its checksum
+TEST(BufferPoolManagerTest, FlushWhileWritingTest) {
+  const size_t buffer_pool_size = 4;
+  const int num_flushes = 2000;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), 2);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+
+  // Each round fills the page with another byte, so a page whose stamp and contents come from different rounds fails.
+  std::atomic<bool> stop{false};
+  std::thread writer([&] {
+    for (int round = 0; !stop; round++) {
+      auto guard = bpm->FetchPageWrite(page_id);
+      memset(guard.GetDataMut(), round, BUSTUB_PAGE_DATA_SIZE);
+      std::this_thread::yield();
+    }
+  });
+  int torn_pages = 0;
+  char data[BUSTUB_PAGE_SIZE];
+  for (int i = 0; i < num_flushes; i++) {
+    if (i % 2 == 0) {
+      EXPECT_EQ(true, bpm->FlushPage(page_id));
+    } else {
+      bpm->FlushAllPages();
+    }
+    disk_manager->ReadPage(page_id, data);
+    torn_pages += PageChecksum::Verify(page_id, data) ? 0 : 1;
+  }
+  stop = true;
+  writer.join();
+  EXPECT_EQ(0, torn_pages);
+
+  // Scenario: Evicted and fetched again, the page passes its checksum.
+  EXPECT_EQ(true, bpm->FlushPage(page_id));
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  EXPECT_EQ(0, bpm->GetChecksumFailureCount());
+
+  disk_manager->ShutDown();
+}
+
 }  // namespace bustub
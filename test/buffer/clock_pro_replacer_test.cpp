@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer_test.cpp
+//
+// Identification: test/buffer/clock_pro_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/clock_pro_replacer.h"
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ClockProReplacerTest, SampleTest) {
+  ClockProReplacer replacer(4);
+
+  // Scenario: load pages 100..103 into frames 0..3. They all start cold, in their test period.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    replacer.RecordAccess(frame_id, AccessType::Get, 100 + frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(4, replacer.Size());
+
+  // Scenario: frame 1 is accessed again during its test period. HAND_cold evicts frame 0, then promotes frame 1 to
+  // hot instead of evicting it, and evicts frame 2.
+  replacer.RecordAccess(1, AccessType::Get, 101);
+  int value;
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+
+  // Scenario: page 100 comes back while it is still remembered as non-resident, so it is loaded as a hot page. The
+  // cold target grows, and HAND_hot demotes frame 1 to make room.
+  replacer.RecordAccess(0, AccessType::Get, 100);
+  replacer.SetEvictable(0, true);
+  ASSERT_EQ(3, replacer.Size());
+
+  // Scenario: the cold pages are evicted before the hot one.
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(false, replacer.Evict(&value));
+}
+
+TEST(ClockProReplacerTest, ScanTest) {
+  ClockProReplacer replacer(4);
+  int value;
+
+  // Scenario: a scanned frame does not start a test period, so rescanning it never makes it hot.
+  replacer.RecordAccess(0, AccessType::Scan, 100);
+  replacer.RecordAccess(0, AccessType::Scan, 100);
+  replacer.RecordAccess(1, AccessType::Get, 101);
+  replacer.RecordAccess(1, AccessType::Get, 101);
+  replacer.SetEvictable(0, true);
+  replacer.SetEvictable(1, true);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: page 100 was not remembered, so loading it again makes it cold. Frame 1 was accessed again during its
+  // test period, so HAND_cold promotes it to hot and evicts frame 0 instead.
+  replacer.RecordAccess(0, AccessType::Get, 100);
+  replacer.SetEvictable(0, true);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+}
+
+}  // namespace bustub
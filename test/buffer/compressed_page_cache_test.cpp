@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Compress a page, decompress it again and check nothing changed. */
+void ExpectRoundTrip(const std::array<char, BUSTUB_PAGE_SIZE> &page) {
+  std::string compressed;
+  ASSERT_TRUE(PageCodec::Compress(page.data(), page.size(), &compressed, BUSTUB_PAGE_SIZE + BUSTUB_PAGE_SIZE / 2));
+  std::array<char, BUSTUB_PAGE_SIZE> out{};
+  ASSERT_TRUE(PageCodec::Decompress(compressed.data(), compressed.size(), out.data(), out.size()));
+  EXPECT_EQ(0, memcmp(page.data(), out.data(), page.size()));
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, CodecTest) {
+  std::array<char, BUSTUB_PAGE_SIZE> page{};
+
+  // Scenario: A zeroed page compresses to a few bytes.
+  std::string compressed;
+  ASSERT_TRUE(PageCodec::Compress(page.data(), page.size(), &compressed, page.size()));
+  EXPECT_LT(compressed.size(), 64);
+  ExpectRoundTrip(page);
+
+  // Scenario: Repeated records, text and a page filled up to its last byte all come back unchanged.
+  for (size_t i = 0; i < page.size(); i += 16) {
+    snprintf(page.data() + i, 16, "key%08d", static_cast<int>(i / 16));
+  }
+  ExpectRoundTrip(page);
+  page.fill('a');
+  page[page.size() - 1] = 'b';
+  ExpectRoundTrip(page);
+
+  // Scenario: Random bytes do not compress, and are refused once the output reaches max_size.
+  std::mt19937 gen(15445);
+  for (auto &byte : page) {
+    byte = static_cast<char>(gen());
+  }
+  EXPECT_FALSE(PageCodec::Compress(page.data(), page.size(), &compressed, page.size()));
+  ExpectRoundTrip(page);
+
+  // Scenario: Truncated or corrupted input is rejected instead of read or written out of bounds.
+  page.fill(0);
+  snprintf(page.data(), page.size(), "hello hello hello hello");
+  ASSERT_TRUE(PageCodec::Compress(page.data(), page.size(), &compressed, page.size()));
+  std::array<char, BUSTUB_PAGE_SIZE> out{};
+  EXPECT_FALSE(PageCodec::Decompress(compressed.data(), compressed.size() / 2, out.data(), out.size()));
+  EXPECT_FALSE(PageCodec::Decompress(compressed.data(), compressed.size(), out.data(), out.size() - 1));
+  std::string corrupted(compressed.size(), static_cast<char>(0xFF));
+  EXPECT_FALSE(PageCodec::Decompress(corrupted.data(), corrupted.size(), out.data(), out.size()));
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, CacheTest) {
+  std::array<char, BUSTUB_PAGE_SIZE> page{};
+  std::array<char, BUSTUB_PAGE_SIZE> out{};
+  std::string compressed;
+  snprintf(page.data(), page.size(), "page");
+  ASSERT_TRUE(PageCodec::Compress(page.data(), page.size(), &compressed, page.size()));
+  const size_t entry_size = compressed.size();
+
+  // Scenario: A cache with room for three pages keeps the three inserted last.
+  CompressedPageCache cache(3 * entry_size);
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    EXPECT_TRUE(cache.Insert(page_id, page.data()));
+  }
+  EXPECT_EQ(3, cache.GetPageCount());
+  EXPECT_EQ(3 * entry_size, cache.GetSize());
+  EXPECT_FALSE(cache.Take(1, out.data()));
+  EXPECT_EQ(1, cache.GetMissCount());
+
+  // Scenario: Taking a page hands back its contents and removes it from the cache.
+  ASSERT_TRUE(cache.Take(4, out.data()));
+  EXPECT_EQ("page", std::string(out.data()));
+  EXPECT_EQ(1, cache.GetHitCount());
+  EXPECT_FALSE(cache.Take(4, out.data()));
+  EXPECT_EQ(2, cache.GetPageCount());
+
+  // Scenario: Erasing a page forgets it, and inserting a page again replaces its old copy.
+  cache.Erase(3);
+  EXPECT_FALSE(cache.Take(3, out.data()));
+  snprintf(page.data(), page.size(), "edit");
+  EXPECT_TRUE(cache.Insert(2, page.data()));
+  EXPECT_EQ(1, cache.GetPageCount());
+  ASSERT_TRUE(cache.Take(2, out.data()));
+  EXPECT_EQ("edit", std::string(out.data()));
+  EXPECT_EQ(0, cache.GetSize());
+
+  // Scenario: A page that does not compress into the capacity is not kept.
+  CompressedPageCache tiny(entry_size - 1);
+  EXPECT_FALSE(tiny.Insert(0, page.data()));
+  EXPECT_EQ(0, tiny.GetPageCount());
+}
+
+}  // namespace bustub
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager_test.cpp
+//
+// Identification: test/buffer/epoch_manager_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/epoch_manager.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(EpochManagerTest, RetireTest) {
+  EpochManager epochs;
+  EXPECT_EQ(EpochManager::NO_ACTIVE_EPOCH, epochs.GetOldestActiveEpoch());
+
+  // Scenario: A frame retired while a reader is inside an epoch stays retired until the reader exits.
+  size_t slot = epochs.Enter();
+  uint64_t retired = epochs.Advance();
+  EXPECT_FALSE(retired < epochs.GetOldestActiveEpoch());
+
+  // Scenario: Readers that enter after the frame was retired do not hold it up, nested ones neither.
+  std::thread([&epochs, retired] {
+    size_t late_slot = epochs.Enter();
+    size_t nested_slot = epochs.Enter();
+    epochs.Exit(nested_slot);
+    epochs.Exit(late_slot);
+    EXPECT_FALSE(retired < epochs.GetOldestActiveEpoch());
+  }).join();
+  EXPECT_FALSE(retired < epochs.GetOldestActiveEpoch());
+
+  epochs.Exit(slot);
+  EXPECT_TRUE(retired < epochs.GetOldestActiveEpoch());
+
+  slot = epochs.Enter();
+  EXPECT_TRUE(retired < epochs.GetOldestActiveEpoch());
+  epochs.Exit(slot);
+  EXPECT_EQ(EpochManager::NO_ACTIVE_EPOCH, epochs.GetOldestActiveEpoch());
+}
+
+// NOLINTNEXTLINE
+TEST(EpochManagerTest, ConcurrentTest) {
+  const int num_threads = 8;
+  const int num_rounds = 10000;
+  EpochManager epochs;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&epochs, t] {
+      for (int i = 0; i < num_rounds; i++) {
+        size_t slot = epochs.Enter();
+        if (t == 0) {
+          epochs.Advance();
+        }
+        EXPECT_NE(EpochManager::NO_ACTIVE_EPOCH, epochs.GetOldestActiveEpoch());
+        epochs.Exit(slot);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(EpochManager::NO_ACTIVE_EPOCH, epochs.GetOldestActiveEpoch());
+}
+
+}  // namespace bustub
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, SampleTest) {
+  const size_t num_frames = 600;
+  FrameArena arena(num_frames, {});
+
+  // Scenario: The frames are contiguous, start on a huge page boundary and are zeroed.
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrame(0)) % FRAME_ARENA_ALIGNMENT);
+  for (size_t i = 1; i < num_frames; i++) {
+    ASSERT_EQ(arena.GetFrame(0) + i * BUSTUB_PAGE_SIZE, arena.GetFrame(static_cast<frame_id_t>(i)));
+  }
+  char zeros[BUSTUB_PAGE_SIZE] = {0};
+  EXPECT_EQ(0, std::memcmp(zeros, arena.GetFrame(num_frames - 1), BUSTUB_PAGE_SIZE));
+
+  // Scenario: Every frame can be written without touching its neighbours.
+  for (size_t i = 0; i < num_frames; i++) {
+    std::memset(arena.GetFrame(static_cast<frame_id_t>(i)), static_cast<int>(i % 127), BUSTUB_PAGE_SIZE);
+  }
+  for (size_t i = 0; i < num_frames; i++) {
+    char *frame = arena.GetFrame(static_cast<frame_id_t>(i));
+    ASSERT_EQ(static_cast<char>(i % 127), frame[0]);
+    ASSERT_EQ(static_cast<char>(i % 127), frame[BUSTUB_PAGE_SIZE - 1]);
+  }
+  EXPECT_EQ(-1, arena.GetNode(0));
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, OptionsTest) {
+  const size_t num_frames = 1024;
+  const size_t num_nodes = FrameArena::GetNumNodes();
+  ASSERT_GE(num_nodes, 1);
+
+  // Scenario: Huge pages fall back to a normal mapping where none are reserved, and NUMA-aware arenas place every frame
+  // on a node.
+  FrameArena arena(num_frames, {true, true});
+  std::memset(arena.GetFrame(0), 1, num_frames * BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < num_frames; i++) {
+    ASSERT_GE(arena.GetNode(static_cast<frame_id_t>(i)), 0);
+  }
+  if (num_nodes == 1) {
+    EXPECT_EQ(arena.GetNode(0), arena.GetNode(num_frames - 1));
+  }
+
+  // Scenario: The instances of a parallel buffer pool are spread over the nodes, one node each.
+  FrameArena first(num_frames, {false, true}, 2, 0);
+  FrameArena second(num_frames, {false, true}, 2, 1);
+  EXPECT_EQ(first.GetNode(0), first.GetNode(num_frames - 1));
+  EXPECT_EQ(second.GetNode(0), second.GetNode(num_frames - 1));
+  if (num_nodes > 1) {
+    EXPECT_NE(first.GetNode(0), second.GetNode(0));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, BufferPoolTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  BufferPoolManagerInstance bpm(16, disk_manager.get(), 2, nullptr, ReplacerPolicy::LRUK, {true, true});
+
+  page_id_t page_id;
+  for (int i = 0; i < 32; i++) {
+    auto *page = bpm.NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    bpm.UnpinPage(page_id, true);
+  }
+  for (page_id_t i = 0; i < 32; i++) {
+    auto *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::string(page->GetData()), "page " + std::to_string(i));
+    bpm.UnpinPage(i, false);
+  }
+
+#ifndef BUSTUB_PER_PAGE_FRAMES
+  // Scenario: The frames of the pool sit next to each other.
+  for (size_t i = 1; i < bpm.GetPoolSize(); i++) {
+    EXPECT_EQ(bpm.GetPage(0)->GetData() + i * BUSTUB_PAGE_SIZE, bpm.GetPage(i)->GetData());
+  }
+#endif
+}
+
+}  // namespace bustub
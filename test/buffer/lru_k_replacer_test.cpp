@@ -16,7 +16,7 @@
 
 namespace bustub {
 
-TEST(LRUKReplacerTest, DISABLED_SampleTest) {
+TEST(LRUKReplacerTest, SampleTest) {
   LRUKReplacer lru_replacer(7, 2);
 
   // Scenario: add six elements to the replacer. We have [1,2,3,4,5]. Frame 6 is non-evictable.
@@ -95,4 +95,46 @@ TEST(LRUKReplacerTest, DISABLED_SampleTest) {
   ASSERT_EQ(false, lru_replacer.Evict(&value));
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_replacer(8, 2);
+
+  // Scenario: frames 0 and 1 are read by point lookups, then frames 2..5 are touched by a sequential scan.
+  lru_replacer.RecordAccess(0, AccessType::Get);
+  lru_replacer.RecordAccess(0, AccessType::Get);
+  lru_replacer.RecordAccess(1, AccessType::Get);
+  for (frame_id_t frame_id = 2; frame_id < 6; frame_id++) {
+    lru_replacer.RecordAccess(frame_id, AccessType::Scan);
+  }
+  // Scanning frame 1 again must not count as a second access.
+  lru_replacer.RecordAccess(1, AccessType::Scan);
+  for (frame_id_t frame_id = 0; frame_id < 6; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(6, lru_replacer.Size());
+
+  // Scenario: the scanned frames go first in LRU order, then frame 1 (+inf distance), then frame 0.
+  int value;
+  for (frame_id_t frame_id = 2; frame_id < 6; frame_id++) {
+    ASSERT_EQ(true, lru_replacer.Evict(&value));
+    ASSERT_EQ(frame_id, value);
+  }
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: a point lookup on a scanned frame makes it a regular frame. Both of its accesses count, so its
+  // backward 2-distance is smaller than frame 0's.
+  lru_replacer.RecordAccess(6, AccessType::Scan);
+  lru_replacer.RecordAccess(6, AccessType::Get);
+  lru_replacer.RecordAccess(7, AccessType::Scan);
+  lru_replacer.SetEvictable(6, true);
+  lru_replacer.SetEvictable(7, true);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(7, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(6, value);
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+}
 }  // namespace bustub
@@ -22,41 +22,43 @@ namespace bustub {
 TEST(LRUReplacerTest, SampleTest) {
   LRUReplacer lru_replacer(7);
 
-  // Scenario: unpin six elements, i.e. add them to the replacer.
-  lru_replacer.Unpin(1);
-  lru_replacer.Unpin(2);
-  lru_replacer.Unpin(3);
-  lru_replacer.Unpin(4);
-  lru_replacer.Unpin(5);
-  lru_replacer.Unpin(6);
-  lru_replacer.Unpin(1);
+  // Scenario: access six elements and unpin them, i.e. make them evictable.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_replacer.RecordAccess(frame_id);
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  // Making a frame evictable again has no effect.
+  lru_replacer.SetEvictable(1, true);
   EXPECT_EQ(6, lru_replacer.Size());
 
-  // Scenario: get three victims from the lru.
+  // Scenario: get three victims.
   int value;
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(1, value);
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(2, value);
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(3, value);
 
-  // Scenario: pin elements in the replacer.
-  // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  lru_replacer.Pin(3);
-  lru_replacer.Pin(4);
+  // Scenario: pin elements in the replacer, which accesses them and makes them non-evictable.
+  // Note that 3 has already been victimized, so pinning 3 starts tracking it again but does not change the size.
+  lru_replacer.RecordAccess(3);
+  lru_replacer.SetEvictable(3, false);
+  lru_replacer.RecordAccess(4);
+  lru_replacer.SetEvictable(4, false);
   EXPECT_EQ(2, lru_replacer.Size());
 
-  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  lru_replacer.Unpin(4);
+  // Scenario: unpin 4. It was accessed last, so it is evicted last.
+  lru_replacer.SetEvictable(4, true);
 
   // Scenario: continue looking for victims. We expect these victims.
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(5, value);
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(6, value);
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(4, value);
+  EXPECT_EQ(false, lru_replacer.Evict(&value));
 }
 
 }  // namespace bustub
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  const size_t num_frames = 16;
+  PageTable page_table(num_frames);
+  frame_id_t frame_id;
+
+  // Scenario: Strided page ids, as allocated by a parallel buffer pool instance, can all be found.
+  for (size_t i = 0; i < num_frames; i++) {
+    page_table.Insert(static_cast<page_id_t>(i * 8 + 3), static_cast<frame_id_t>(i));
+  }
+  EXPECT_EQ(num_frames, page_table.Size());
+  for (size_t i = 0; i < num_frames; i++) {
+    ASSERT_TRUE(page_table.Find(static_cast<page_id_t>(i * 8 + 3), &frame_id));
+    EXPECT_EQ(static_cast<frame_id_t>(i), frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(4, &frame_id));
+
+  // Scenario: Erased pages are gone, and the remaining ones are still found past the tombstones.
+  for (size_t i = 0; i < num_frames; i += 2) {
+    EXPECT_TRUE(page_table.Erase(static_cast<page_id_t>(i * 8 + 3)));
+  }
+  EXPECT_FALSE(page_table.Erase(3));
+  for (size_t i = 0; i < num_frames; i++) {
+    EXPECT_EQ(i % 2 == 1, page_table.Find(static_cast<page_id_t>(i * 8 + 3), &frame_id));
+  }
+
+  // Scenario: Many insert/erase cycles must not fill the table with tombstones.
+  for (page_id_t page_id = 1000; page_id < 11000; page_id++) {
+    page_table.Insert(page_id, 0);
+    EXPECT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_TRUE(page_table.Erase(page_id));
+  }
+  EXPECT_EQ(num_frames / 2, page_table.Size());
+  EXPECT_FALSE(page_table.Find(1000, &frame_id));
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentReadTest) {
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  for (size_t i = 0; i < num_frames / 2; i++) {
+    page_table.Insert(static_cast<page_id_t>(i), static_cast<frame_id_t>(i));
+  }
+
+  // Scenario: Readers never see a wrong frame for a stable page while a writer churns other pages.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; t++) {
+    readers.emplace_back([&] {
+      while (!done) {
+        for (size_t i = 0; i < num_frames / 2; i++) {
+          frame_id_t frame_id = -1;
+          if (page_table.Find(static_cast<page_id_t>(i), &frame_id)) {
+            EXPECT_EQ(static_cast<frame_id_t>(i), frame_id);
+          }
+        }
+      }
+    });
+  }
+  for (page_id_t page_id = 1000; page_id < 50000; page_id++) {
+    page_table.Insert(page_id, static_cast<frame_id_t>(num_frames - 1));
+    page_table.Erase(page_id);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 5;
+  const size_t buffer_pool_size = 2;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, k);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: New pages are spread round robin over the instances, and each page lives in the instance that the
+  // page id hashes to.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id_temp, page->GetPageId());
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page%d", page_id_temp);
+  }
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->GetInstance(i)->NewPage(&page_id_temp));
+  }
+
+  // Scenario: Once every instance is full, we should not be able to create any new pages.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Unpinning page 0 makes room in its instance only.
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0, page_id_temp % static_cast<page_id_t>(num_instances));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: Page 0 was written back on eviction and can be read again.
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "page0"));
+  EXPECT_EQ(1, bpm->GetInstance(0)->GetMissCount());
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(1, bpm->GetInstance(0)->GetHitCount());
+  EXPECT_EQ(1, bpm->GetStats().hits_);
+  EXPECT_EQ(1, bpm->GetStats().misses_);
+  EXPECT_EQ(bpm->GetPoolSize(), bpm->GetStats().pool_size_);
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: The counters and frames of the pool are those of all of its instances.
+  EXPECT_NE(nullptr, bpm->FetchPage(3));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+  EXPECT_EQ(2, bpm->GetHitCount());
+  EXPECT_EQ(1, bpm->GetMissCount());
+  EXPECT_EQ(bpm->GetStats().hits_, bpm->GetHitCount());
+  size_t num_resident = 0;
+  for (size_t i = 0; i < bpm->GetPoolSize(); i++) {
+    const page_id_t page_id = bpm->GetPage(i)->GetPageId();
+    if (page_id != INVALID_PAGE_ID) {
+      EXPECT_EQ(bpm->GetInstance(page_id % num_instances)->GetPage(i % buffer_pool_size), bpm->GetPage(i));
+      num_resident++;
+    }
+  }
+  EXPECT_EQ(num_instances * buffer_pool_size, num_resident);
+
+  // Scenario: Deleting a pinned page fails, deleting an unpinned one succeeds.
+  EXPECT_EQ(false, bpm->DeletePage(1));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_EQ(true, bpm->DeletePage(1));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
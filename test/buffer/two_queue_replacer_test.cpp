@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  // Kin = 2, Kout = 4.
+  TwoQueueReplacer replacer(8);
+
+  // Scenario: load pages 100..103 into frames 0..3. They all enter A1in.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    replacer.RecordAccess(frame_id, AccessType::Get, 100 + frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(4, replacer.Size());
+
+  // Scenario: A1in holds more than Kin frames, so it is evicted in FIFO order. A hit in A1in does not matter.
+  replacer.RecordAccess(0, AccessType::Get, 100);
+  int value;
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: page 100 is loaded again while it is in A1out, so it goes to Am. A1in is down to Kin frames, so Am is
+  // evicted next.
+  replacer.RecordAccess(0, AccessType::Get, 100);
+  replacer.SetEvictable(0, true);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: a scan that finds page 101 in A1out does not promote it to Am.
+  replacer.RecordAccess(4, AccessType::Scan, 101);
+  replacer.SetEvictable(4, true);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+
+  // Scenario: page 102 comes back to Am, while page 101 (only scanned) was not remembered when it left A1in.
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(4, value);
+  replacer.RecordAccess(5, AccessType::Get, 101);
+  replacer.RecordAccess(6, AccessType::Get, 102);
+  replacer.SetEvictable(5, true);
+  replacer.SetEvictable(6, true);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(6, value);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(5, value);
+  ASSERT_EQ(false, replacer.Evict(&value));
+}
+
+}  // namespace bustub
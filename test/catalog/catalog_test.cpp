@@ -10,11 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <numeric>
+#include <random>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/catalog.h"
 #include "catalog/table_generator.h"
 #include "execution/executor_context.h"
@@ -32,7 +35,7 @@ using BigintHashFunctionType = HashFunction<BigintKeyType>;
 
 TEST(CatalogTest, DISABLED_CreateTable1) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
 
   const std::string table_name{"foobar"};
@@ -63,7 +66,7 @@ TEST(CatalogTest, DISABLED_CreateTable1) {
 
 TEST(CatalogTest, DISABLED_CreateTable2) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
 
   const std::string table_name{"foobar"};
@@ -91,7 +94,7 @@ TEST(CatalogTest, DISABLED_CreateTable2) {
 
 TEST(CatalogTest, DISABLED_CreateTable3) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
 
   const std::string table_name{"foobar"};
@@ -123,7 +126,7 @@ TEST(CatalogTest, DISABLED_CreateTable3) {
 
 TEST(CatalogTest, DISABLED_CreateTableTest) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
 
   const std::string table_name{"foobar"};
@@ -178,7 +181,7 @@ TEST(CatalogTest, DISABLED_CreateTableTest) {
 // Vanilla index creation for valid table
 TEST(CatalogTest, DISABLED_CreateIndex1) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -220,7 +223,7 @@ TEST(CatalogTest, DISABLED_CreateIndex1) {
 // Attempts to create an index with duplicate name should fail
 TEST(CatalogTest, DISABLED_CreateIndex2) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -268,7 +271,7 @@ TEST(CatalogTest, DISABLED_CreateIndex2) {
 
 TEST(CatalogTest, DISABLED_CreateIndex3) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
 
   Transaction txn{0};
@@ -301,7 +304,7 @@ TEST(CatalogTest, DISABLED_CreateIndex3) {
 // Vanilla index queries by name
 TEST(CatalogTest, DISABLED_QueryIndex1) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -343,7 +346,7 @@ TEST(CatalogTest, DISABLED_QueryIndex1) {
 // Vanilla index queries by index OID
 TEST(CatalogTest, DISABLED_QueryIndex2) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -393,7 +396,7 @@ TEST(CatalogTest, DISABLED_QueryIndex2) {
 // Query for nonexistent index on table should fail
 TEST(CatalogTest, DISABLED_FailedQuery1) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -415,7 +418,7 @@ TEST(CatalogTest, DISABLED_FailedQuery1) {
 // Query for index on nonexistent table should fail
 TEST(CatalogTest, DISABLED_FailedQuery2) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -428,7 +431,7 @@ TEST(CatalogTest, DISABLED_FailedQuery2) {
 // Query for nonexistent index OID should throw
 TEST(CatalogTest, DISABLED_FailedQuery3) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -442,7 +445,7 @@ TEST(CatalogTest, DISABLED_FailedQuery3) {
 // Query for all indexes on nonexistent table should give empty collection
 TEST(CatalogTest, DISABLED_FailedQuery4) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -457,7 +460,7 @@ TEST(CatalogTest, DISABLED_FailedQuery4) {
 // indexes defined should return empty collection
 TEST(CatalogTest, DISABLED_FailedQuery5) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -480,7 +483,7 @@ TEST(CatalogTest, DISABLED_FailedQuery5) {
 // Should be able to create and interact with an index with a single BIGINT key
 TEST(CatalogTest, DISABLED_IndexInteraction0) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -532,7 +535,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction0) {
 // Should be able to create and interact with an index that is keyed by two INTEGER values
 TEST(CatalogTest, DISABLED_IndexInteraction1) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -584,7 +587,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction1) {
 // Should be able to create and interact with an index that is keyed by a single INTEGER column
 TEST(CatalogTest, DISABLED_IndexInteraction2) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -635,7 +638,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction2) {
 
 TEST(CatalogTest, DISABLED_IndexInteraction3) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
-  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
   auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
   auto txn = std::make_unique<Transaction>(0);
 
@@ -688,4 +691,53 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
   remove("catalog_test.log");
 }
 
+// NOLINTNEXTLINE
+// Creating an index on a table that already has tuples sorts and bulk-loads them, and the index finds every tuple
+TEST(CatalogTest, CreateIndexBackfill) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_backfill_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  Transaction txn{0};
+
+  std::vector<Column> columns{{"A", TypeId::BIGINT}, {"B", TypeId::BIGINT}};
+  Schema schema{columns};
+  auto *table_info = catalog->CreateTable(&txn, "foobar", schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+
+  // enough tuples for the index to outgrow the frames of its bulk-load ring, in no particular order
+  const int64_t num_tuples = 5000;
+  std::vector<int64_t> keys(num_tuples);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+  std::vector<RID> rids(num_tuples);
+  for (int64_t key : keys) {
+    Tuple tuple{std::vector<Value>{ValueFactory::GetBigIntValue(key), ValueFactory::GetBigIntValue(-key)}, &schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rids[key], &txn));
+  }
+
+  std::vector<Column> key_columns{{"A", TypeId::BIGINT}};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      &txn, "index1", "foobar", schema, key_schema, {0}, BIGINT_SIZE, BigintHashFunctionType{});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  for (int64_t key = 0; key < num_tuples; key++) {
+    Tuple key_tuple{std::vector<Value>{ValueFactory::GetBigIntValue(key)}, &key_schema};
+    std::vector<RID> result;
+    index_info->index_->ScanKey(key_tuple, &result, &txn);
+    ASSERT_EQ(1, result.size()) << key;
+    EXPECT_EQ(rids[key], result[0]);
+  }
+
+  // the bulk-loaded index keeps working as usual
+  Tuple key_tuple{std::vector<Value>{ValueFactory::GetBigIntValue(num_tuples)}, &key_schema};
+  index_info->index_->InsertEntry(key_tuple, RID{1, 1}, &txn);
+  std::vector<RID> result;
+  index_info->index_->ScanKey(key_tuple, &result, &txn);
+  EXPECT_EQ(1, result.size());
+
+  remove("catalog_backfill_test.db");
+  remove("catalog_backfill_test.log");
+}
+
 }  // namespace bustub
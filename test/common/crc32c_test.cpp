@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "storage/page/page_checksum.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, ValueTest) {
+  // Scenario: The standard check value, and the checksum of nothing.
+  EXPECT_EQ(0xE3069283, Crc32c::Value("123456789", 9));
+  EXPECT_EQ(0, Crc32c::Value("", 0));
+
+  // Scenario: Extending piece by piece, at every split and odd alignment, gives the checksum of the whole buffer.
+  std::array<char, 100> data;
+  std::mt19937 gen(15445);
+  for (auto &byte : data) {
+    byte = static_cast<char>(gen());
+  }
+  const uint32_t whole = Crc32c::Value(data.data(), data.size());
+  for (size_t split = 0; split <= data.size(); split++) {
+    EXPECT_EQ(whole, Crc32c::Extend(Crc32c::Value(data.data(), split), data.data() + split, data.size() - split));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, PageChecksumTest) {
+  std::array<char, BUSTUB_PAGE_SIZE> page{};
+
+  // Scenario: A page that has never been written verifies, as does a stamped one.
+  EXPECT_TRUE(PageChecksum::Verify(3, page.data()));
+  snprintf(page.data(), BUSTUB_PAGE_DATA_SIZE, "page 3");
+  EXPECT_FALSE(PageChecksum::Verify(3, page.data()));
+  PageChecksum::Stamp(3, page.data());
+  EXPECT_TRUE(PageChecksum::Verify(3, page.data()));
+
+  // Scenario: The same bytes at another page id, a flipped bit, or a page torn halfway through do not.
+  EXPECT_FALSE(PageChecksum::Verify(4, page.data()));
+  auto flipped = page;
+  flipped[BUSTUB_PAGE_DATA_SIZE - 1] ^= 1;
+  EXPECT_FALSE(PageChecksum::Verify(3, flipped.data()));
+  auto torn = page;
+  snprintf(torn.data(), BUSTUB_PAGE_DATA_SIZE, "page 3, version 2");
+  PageChecksum::Stamp(3, torn.data());
+  memcpy(torn.data(), page.data(), BUSTUB_PAGE_SIZE / 2);
+  EXPECT_FALSE(PageChecksum::Verify(3, torn.data()));
+}
+
+}  // namespace bustub
@@ -10,6 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -57,4 +61,83 @@ TEST(RWLatchTest, BasicTest) {
   }
   EXPECT_EQ(counter.Read(), 55);
 }
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, WriterPreferenceTest) {
+  ReaderWriterLatch latch;
+  std::mutex order_mutex;
+  std::vector<std::string> order;
+  auto record = [&](const std::string &event) {
+    std::scoped_lock lock(order_mutex);
+    order.push_back(event);
+  };
+
+  // Scenario: A writer waiting behind a reader keeps later readers out, even once it has parked.
+  latch.RLock();
+  std::thread writer([&]() {
+    latch.WLock();
+    record("writer");
+    latch.WUnlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::thread reader([&]() {
+    latch.RLock();
+    record("reader");
+    latch.RUnlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  {
+    std::scoped_lock lock(order_mutex);
+    EXPECT_TRUE(order.empty());
+  }
+  latch.RUnlock();
+  writer.join();
+  reader.join();
+  EXPECT_EQ(order, (std::vector<std::string>{"writer", "reader"}));
+
+#ifdef BUSTUB_LATCH_STATS
+  EXPECT_EQ(3, latch.GetAcquireCount());
+  EXPECT_EQ(2, latch.GetWaitCount());
+#else
+  EXPECT_EQ(0, latch.GetAcquireCount());
+#endif
+}
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, ContentionTest) {
+  const int num_threads = 8;
+  const int num_iterations = 20000;
+  ReaderWriterLatch latch;
+  int64_t first = 0;
+  int64_t second = 0;
+  std::atomic<bool> torn{false};
+  std::vector<std::thread> threads;
+  // Scenario: Writers keep the two counters equal; readers never see them differ, and no update is lost.
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid]() {
+      for (int i = 0; i < num_iterations; i++) {
+        if (tid % 2 == 0) {
+          latch.WLock();
+          first++;
+          second++;
+          latch.WUnlock();
+        } else {
+          latch.RLock();
+          if (first != second) {
+            torn = true;
+          }
+          latch.RUnlock();
+        }
+        if (i % 1000 == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(torn);
+  EXPECT_EQ(num_threads / 2 * num_iterations, first);
+}
 }  // namespace bustub
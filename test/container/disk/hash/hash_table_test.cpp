@@ -13,7 +13,7 @@
 #include <thread>  // NOLINT
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "common/logger.h"
 #include "container/disk/hash/disk_extendible_hash_table.h" 
 #include "gtest/gtest.h"
@@ -28,7 +28,7 @@ namespace bustub {
 // NOLINTNEXTLINE
 TEST(HashTableTest, DISABLED_SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
-  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
   DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
 
   // insert a few values
@@ -129,7 +129,7 @@ TEST(HashTableTest, DISABLED_SampleTest) {
 
 TEST(HashTableTest, Kobi_SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
-  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
   LinearProbeHashTable<int, int, IntComparator> ht("haaaary", bpm, IntComparator(), 50, HashFunction<int>());
 
   // insert a few values
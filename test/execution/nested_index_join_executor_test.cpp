@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// nested_index_join_executor_test.cpp
+//
+// Identification: test/execution/nested_index_join_executor_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "execution/executor_context.h"
+#include "execution/executors/nested_index_join_executor.h"
+#include "execution/executors/values_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/values_plan.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/**
+ * Joins outer keys 0..2399 in random order, and a few nulls, with an inner table that holds the even keys below 2000,
+ * and returns the joined rows.
+ */
+auto RunIndexJoin(JoinType join_type, std::vector<int64_t> *outer_keys) -> std::vector<std::vector<Value>> {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(128, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  Transaction txn{0};
+  auto exec_ctx = std::make_unique<ExecutorContext>(&txn, catalog.get(), bpm.get(), nullptr, nullptr);
+
+  auto inner_schema = std::make_shared<Schema>(std::vector<Column>{{"A", TypeId::BIGINT}, {"B", TypeId::BIGINT}});
+  auto *inner_info = catalog->CreateTable(&txn, "inner", *inner_schema);
+  for (int64_t key = 0; key < 2000; key += 2) {
+    Tuple tuple{std::vector<Value>{ValueFactory::GetBigIntValue(key), ValueFactory::GetBigIntValue(-key)},
+                inner_schema.get()};
+    RID rid;
+    inner_info->table_->InsertTuple(tuple, &rid, &txn);
+  }
+  Schema key_schema{std::vector<Column>{{"A", TypeId::BIGINT}}};
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "inner_a", "inner", *inner_schema, key_schema, {0}, 8, HashFunction<GenericKey<8>>{});
+
+  for (int64_t key = 0; key < 2400; key++) {
+    outer_keys->push_back(key);
+  }
+  std::shuffle(outer_keys->begin(), outer_keys->end(), std::default_random_engine{});
+  outer_keys->insert(outer_keys->begin() + 1500, 3, -1);
+  auto outer_schema = std::make_shared<Schema>(std::vector<Column>{{"X", TypeId::BIGINT}});
+  std::vector<std::vector<AbstractExpressionRef>> rows;
+  for (int64_t key : *outer_keys) {
+    Value value = key < 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT) : ValueFactory::GetBigIntValue(key);
+    rows.push_back({std::make_shared<ConstantValueExpression>(value)});
+  }
+  auto values_plan = std::make_shared<ValuesPlanNode>(outer_schema, rows);
+
+  auto output_schema = std::make_shared<Schema>(
+      std::vector<Column>{{"X", TypeId::BIGINT}, {"A", TypeId::BIGINT}, {"B", TypeId::BIGINT}});
+  NestedIndexJoinPlanNode join_plan(output_schema, values_plan,
+                                    std::make_shared<ColumnValueExpression>(0, 0, TypeId::BIGINT),
+                                    inner_info->oid_, index_info->index_oid_, "inner_a", "inner", inner_schema,
+                                    join_type);
+  NestIndexJoinExecutor executor(exec_ctx.get(), &join_plan,
+                                 std::make_unique<ValuesExecutor>(exec_ctx.get(), values_plan.get()));
+  executor.Init();
+
+  std::vector<std::vector<Value>> output;
+  Tuple tuple;
+  RID rid;
+  while (executor.Next(&tuple, &rid)) {
+    std::vector<Value> row;
+    for (uint32_t column = 0; column < output_schema->GetColumnCount(); column++) {
+      row.push_back(tuple.GetValue(output_schema.get(), column));
+    }
+    output.push_back(std::move(row));
+  }
+  return output;
+}
+
+// NOLINTNEXTLINE
+// An inner index join over several batches of outer keys returns the matches in the order of the outer tuples
+TEST(NestedIndexJoinExecutorTest, InnerJoinTest) {
+  std::vector<int64_t> outer_keys;
+  auto output = RunIndexJoin(JoinType::INNER, &outer_keys);
+
+  std::vector<int64_t> expected;
+  std::copy_if(outer_keys.begin(), outer_keys.end(), std::back_inserter(expected),
+               [](int64_t key) { return key >= 0 && key < 2000 && key % 2 == 0; });
+  ASSERT_EQ(expected.size(), output.size());
+  for (size_t i = 0; i < output.size(); i++) {
+    EXPECT_EQ(expected[i], output[i][0].GetAs<int64_t>());
+    EXPECT_EQ(expected[i], output[i][1].GetAs<int64_t>());
+    EXPECT_EQ(-expected[i], output[i][2].GetAs<int64_t>());
+  }
+}
+
+// NOLINTNEXTLINE
+// A left index join keeps every outer tuple, with nulls for the inner columns of keys the index does not have
+TEST(NestedIndexJoinExecutorTest, LeftJoinTest) {
+  std::vector<int64_t> outer_keys;
+  auto output = RunIndexJoin(JoinType::LEFT, &outer_keys);
+
+  ASSERT_EQ(outer_keys.size(), output.size());
+  for (size_t i = 0; i < output.size(); i++) {
+    const int64_t key = outer_keys[i];
+    EXPECT_EQ(key < 0, output[i][0].IsNull());
+    if (key >= 0 && key < 2000 && key % 2 == 0) {
+      EXPECT_EQ(key, output[i][0].GetAs<int64_t>());
+      EXPECT_EQ(key, output[i][1].GetAs<int64_t>());
+      EXPECT_EQ(-key, output[i][2].GetAs<int64_t>());
+    } else {
+      EXPECT_TRUE(output[i][1].IsNull());
+      EXPECT_TRUE(output[i][2].IsNull());
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager_test.cpp
+//
+// Identification: test/storage/async_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstring>
+#include <future>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
+
+namespace bustub {
+
+class AsyncDiskManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(AsyncDiskManagerTest, ReadWritePageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  AsyncDiskManager dm("test.db");
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Pages past the end of the file read as zeros.
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[BUSTUB_PAGE_SIZE - 1]);
+
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  std::memset(buf, 0, sizeof(buf));
+  dm.WritePage(5, data);
+  dm.ReadPage(5, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(AsyncDiskManagerTest, OutstandingRequestsTest) {
+  const size_t num_pages = 64;
+  std::vector<char> written(num_pages * BUSTUB_PAGE_SIZE);
+  std::vector<char> read(num_pages * BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < written.size(); i++) {
+    written[i] = static_cast<char>(i / BUSTUB_PAGE_SIZE + i % 251);
+  }
+
+  {
+    AsyncDiskManager dm("test.db", 8);
+
+    // Submit every write before waiting for any of them.
+    std::atomic<size_t> writes_done{0};
+    std::promise<void> all_written;
+    for (size_t i = 0; i < num_pages; i++) {
+      dm.WritePageAsync(static_cast<page_id_t>(i), &written[i * BUSTUB_PAGE_SIZE], [&](bool success) {
+        EXPECT_TRUE(success);
+        if (writes_done.fetch_add(1) + 1 == num_pages) {
+          all_written.set_value();
+        }
+      });
+    }
+    all_written.get_future().wait();
+    EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+    // Read them back in reverse order. Destroying the disk manager waits for the outstanding reads.
+    for (size_t i = num_pages; i > 0; i--) {
+      dm.ReadPageAsync(static_cast<page_id_t>(i - 1), &read[(i - 1) * BUSTUB_PAGE_SIZE],
+                       [](bool success) { EXPECT_TRUE(success); });
+    }
+    dm.ShutDown();
+  }
+  EXPECT_EQ(written, read);
+}
+
+// NOLINTNEXTLINE
+TEST_F(AsyncDiskManagerTest, ReadWritePagesTest) {
+  const size_t num_pages = 8;
+  std::vector<char> written(num_pages * BUSTUB_PAGE_SIZE);
+  std::vector<char> read(num_pages * BUSTUB_PAGE_SIZE, 1);
+  for (size_t i = 0; i < written.size(); i++) {
+    written[i] = static_cast<char>(i / BUSTUB_PAGE_SIZE + 1);
+  }
+  AsyncDiskManager dm("test.db");
+
+  // Pages 0..5 are adjacent and written with one pwritev.
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  for (size_t i = 0; i < 6; i++) {
+    writes.emplace_back(static_cast<page_id_t>(5 - i), &written[(5 - i) * BUSTUB_PAGE_SIZE]);
+  }
+  dm.WritePages(writes);
+  EXPECT_EQ(6, dm.GetNumWrites());
+  EXPECT_EQ(1, dm.GetNumIOs());
+
+  // Pages 6 and 7 lie past the end of the file and read as zeros.
+  std::vector<std::pair<page_id_t, char *>> reads;
+  for (size_t i = 0; i < num_pages; i++) {
+    reads.emplace_back(static_cast<page_id_t>(i), &read[i * BUSTUB_PAGE_SIZE]);
+  }
+  dm.ReadPages(reads);
+  EXPECT_EQ(num_pages, dm.GetNumReads());
+  EXPECT_EQ(0, std::memcmp(written.data(), read.data(), 6 * BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(0, read[6 * BUSTUB_PAGE_SIZE]);
+  EXPECT_EQ(0, read.back());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(AsyncDiskManagerTest, BufferPoolTest) {
+  AsyncDiskManager dm("test.db");
+  const size_t buffer_pool_size = 4;
+  {
+    BufferPoolManagerInstance bpm(buffer_pool_size, &dm);
+    bpm.StartBackgroundWriter(buffer_pool_size);
+
+    // Cycle more pages than there are frames through the pool, then read all of them back.
+    page_id_t page_id;
+    for (int i = 0; i < 16; i++) {
+      auto *page = bpm.NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", i);
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+    }
+    for (int i = 0; i < 16; i++) {
+      auto *page = bpm.FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+      EXPECT_EQ(true, bpm.UnpinPage(i, false));
+    }
+  }
+  dm.ShutDown();
+}
+
+}  // namespace bustub
@@ -0,0 +1,265 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using bustub::DiskManagerUnlimitedMemory;
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+/** Checks the size of every page below the root and that all leaves are at the same depth. Returns the leaf count. */
+auto CheckShape(BufferPoolManager *bpm, page_id_t page_id, bool is_root, int depth, int *leaf_depth) -> int {
+  ReadPageGuard guard = bpm->FetchPageRead(page_id);
+  const auto *page = guard.As<BPlusTreePage>();
+  EXPECT_LE(page->GetSize(), page->GetMaxSize());
+  if (!is_root) {
+    EXPECT_GE(page->GetSize(), page->GetMinSize());
+  }
+  if (page->IsLeafPage()) {
+    if (*leaf_depth == -1) {
+      *leaf_depth = depth;
+    }
+    EXPECT_EQ(*leaf_depth, depth);
+    return 1;
+  }
+  const auto *internal = guard.As<InternalPage>();
+  int num_leaves = 0;
+  for (int i = 0; i < internal->GetSize(); i++) {
+    num_leaves += CheckShape(bpm, internal->ValueAt(i), false, depth + 1, leaf_depth);
+  }
+  return num_leaves;
+}
+
+// NOLINTNEXTLINE
+// Pairs that outgrow the memory budget are spilled as runs and merged back in key order, equal keys in insertion order
+TEST(BPlusTreeBulkLoadTest, ExternalSortTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  // room for 100 pairs at a time
+  ExternalSorter<GenericKey<8>, RID, GenericComparator<8>> sorter(comparator,
+                                                           100 * sizeof(std::pair<GenericKey<8>, RID>));
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 1000; key++) {
+    keys.push_back(key / 2);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+  GenericKey<8> index_key;
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_key.SetFromInteger(keys[i]);
+    sorter.Add(index_key, RID(0, i));
+  }
+  EXPECT_EQ(1000, sorter.GetSize());
+  EXPECT_EQ(9, sorter.GetNumRuns());
+
+  RID rid;
+  int64_t count = 0;
+  uint32_t last_slot = 0;
+  while (sorter.Next(&index_key, &rid)) {
+    EXPECT_EQ(count / 2, keys[rid.GetSlotNum()]);
+    EXPECT_EQ(count / 2, index_key.ToString());
+    if (count % 2 == 1) {
+      EXPECT_LT(last_slot, rid.GetSlotNum());
+    }
+    last_slot = rid.GetSlotNum();
+    count++;
+  }
+  EXPECT_EQ(1000, count);
+  EXPECT_FALSE(sorter.Next(&index_key, &rid));
+}
+
+// NOLINTNEXTLINE
+// Trees of every size up to a few levels come out balanced, with all pages of a level filled to the fill factor
+TEST(BPlusTreeBulkLoadTest, ShapeTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (double fill_factor : {0.0, 0.5, 0.75, 1.0}) {
+    for (int64_t num_keys = 0; num_keys <= 200; num_keys++) {
+      auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+      auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+      page_id_t header_page_id;
+      bpm->NewPage(&header_page_id);
+      Tree tree("foo_pk", header_page_id, bpm.get(), comparator, 8, 6);
+
+      int64_t next_key = 0;
+      auto next = [&](GenericKey<8> *key, RID *rid) {
+        if (next_key == num_keys) {
+          return false;
+        }
+        key->SetFromInteger(next_key);
+        rid->Set(0, next_key);
+        next_key++;
+        return true;
+      };
+      ASSERT_EQ(num_keys, tree.BulkLoad(next, fill_factor));
+      EXPECT_EQ(num_keys == 0, tree.IsEmpty());
+
+      int leaf_depth = -1;
+      const int num_leaves = CheckShape(bpm.get(), tree.GetRootPageId(), true, 0, &leaf_depth);
+      // only the last leaf may take entries from, or be merged into, the one before
+      const int64_t fill_size = std::clamp(static_cast<int>(8 * fill_factor), 4, 8);
+      EXPECT_GE(num_leaves, std::max<int64_t>(1, num_keys / fill_size)) << num_keys << " keys at " << fill_factor;
+      EXPECT_LE(num_leaves, std::max<int64_t>(1, (num_keys + fill_size - 1) / fill_size));
+
+      int64_t current_key = 0;
+      for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+        EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+        current_key++;
+      }
+      EXPECT_EQ(num_keys, current_key);
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int64_t key = 0; key < num_keys; key++) {
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      }
+      bpm->UnpinPage(header_page_id, true);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+// A bulk-loaded tree drops duplicate keys, rejects out-of-order input, and takes inserts and removes afterwards
+TEST(BPlusTreeBulkLoadTest, ModifyAfterLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  Tree tree("foo_pk", header_page_id, bpm.get(), comparator, 3, 4);
+
+  // even keys only, each of them four times
+  int64_t next_key = 0;
+  auto next = [&](GenericKey<8> *key, RID *rid) {
+    if (next_key == 2000) {
+      return false;
+    }
+    key->SetFromInteger(next_key / 4 * 2);
+    rid->Set(0, next_key);
+    next_key++;
+    return true;
+  };
+  ASSERT_EQ(500, tree.BulkLoad(next, 1.0));
+  EXPECT_THROW(tree.BulkLoad(next, 1.0), Exception);
+
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 1000; key += 2) {
+    index_key.SetFromInteger(key);
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    EXPECT_EQ(key * 2, rids[0].GetSlotNum());
+  }
+
+  // the odd keys go between the full leaves, then the even ones are removed again
+  for (int64_t key = 1; key < 1000; key += 2) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, RID(0, key)));
+  }
+  for (int64_t key = 0; key < 1000; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, nullptr);
+  }
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key += 2;
+  }
+  EXPECT_EQ(1001, current_key);
+  int leaf_depth = -1;
+  CheckShape(bpm.get(), tree.GetRootPageId(), true, 0, &leaf_depth);
+
+  Tree unsorted_tree("bar_pk", bpm->NewPage(&header_page_id)->GetPageId(), bpm.get(), comparator, 3, 4);
+  next_key = 10;
+  auto descending = [&](GenericKey<8> *key, RID *rid) {
+    if (next_key == 0) {
+      return false;
+    }
+    key->SetFromInteger(next_key);
+    rid->Set(0, next_key--);
+    return true;
+  };
+  EXPECT_THROW(unsorted_tree.BulkLoad(descending), Exception);
+  bpm->UnpinPage(header_page_id, true);
+}
+
+// NOLINTNEXTLINE
+// Lookups through a full internal page of the default size take the optimistic path, without a latched retry
+TEST(BPlusTreeBulkLoadTest, FullPageOptimisticLookupTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  Tree tree("foo_pk", header_page_id, bpm.get(), comparator);
+
+  // The default sizes, both taken from the size of a leaf entry, so that a full internal page holds one entry more
+  // than a full leaf. Exactly enough keys for a root with as many full leaves as it can hold.
+  const int64_t leaf_max_size = (BUSTUB_PAGE_DATA_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+  const int64_t internal_max_size =
+      (BUSTUB_PAGE_DATA_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+  const int64_t num_keys = leaf_max_size * internal_max_size;
+  int64_t next_key = 0;
+  auto next = [&](GenericKey<8> *key, RID *rid) {
+    if (next_key == num_keys) {
+      return false;
+    }
+    key->SetFromInteger(next_key);
+    rid->Set(0, next_key);
+    next_key++;
+    return true;
+  };
+  ASSERT_EQ(num_keys, tree.BulkLoad(next, 1.0));
+  {
+    ReadPageGuard guard = bpm->FetchPageRead(tree.GetRootPageId());
+    const auto *root = guard.As<InternalPage>();
+    ASSERT_FALSE(root->IsLeafPage());
+    ASSERT_EQ(internal_max_size, root->GetSize());
+    ASSERT_EQ(root->GetMaxSize(), root->GetSize());
+  }
+
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  std::vector<GenericKey<8>> keys;
+  for (int64_t key = 0; key < num_keys; key += leaf_max_size / 2) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    EXPECT_EQ(key, rids[0].GetSlotNum());
+    keys.push_back(index_key);
+  }
+  index_key.SetFromInteger(num_keys - 1);
+  ASSERT_TRUE(tree.GetValue(index_key, &rids));
+  std::vector<std::optional<RID>> values;
+  EXPECT_EQ(keys.size(), tree.GetValues(keys, &values));
+  EXPECT_EQ(0, tree.GetLatchedLookupCount());
+  bpm->UnpinPage(header_page_id, true);
+}
+
+}  // namespace bustub
@@ -13,13 +13,15 @@
 #include <algorithm>
 #include <cstdio>
 #include <iostream>
+#include <random>
 
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager_memory.h"
 #include "storage/index/b_plus_tree.h"
 #include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -31,7 +33,7 @@ TEST(BPlusTreeTests, InsertTest1) {
   GenericComparator<8> comparator(key_schema.get());
 
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager.get());
   // create and fetch header_page
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
@@ -68,7 +70,7 @@ TEST(BPlusTreeTests, InsertTest2) {
   GenericComparator<8> comparator(key_schema.get());
 
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager.get());
   // create and fetch header_page
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
@@ -125,7 +127,7 @@ TEST(BPlusTreeTests, InsertTest3) {
   GenericComparator<8> comparator(key_schema.get());
 
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager.get());
   // create and fetch header_page
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
@@ -195,7 +197,7 @@ TEST(BPlusTreeTests, InsertTest4) {
   GenericComparator<8> comparator(key_schema.get());
 
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager.get());
   // create and fetch header_page
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
@@ -230,7 +232,7 @@ TEST(BPlusTreeTests, InsertTest5) {
   GenericComparator<8> comparator(key_schema.get());
 
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager.get());
   // create and fetch header_page
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
@@ -269,4 +271,176 @@ TEST(BPlusTreeTests, InsertTest5) {
 
 
 
+// NOLINTNEXTLINE
+// Batched lookups find the same values as one GetValue per key, for sorted, unsorted and missing keys
+TEST(BPlusTreeTests, GetValuesTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 4);
+  GenericKey<8> index_key;
+
+  std::vector<GenericKey<8>> keys(300);
+  std::vector<std::optional<RID>> result;
+  for (int64_t key = 0; key < 300; key++) {
+    keys[key].SetFromInteger(key);
+  }
+  EXPECT_EQ(0, tree.GetValues(keys, &result));
+  EXPECT_EQ(300, result.size());
+
+  // every third key
+  for (int64_t key = 0; key < 300; key += 3) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key));
+  }
+  EXPECT_EQ(100, tree.GetValues(keys, &result));
+  for (int64_t key = 0; key < 300; key++) {
+    ASSERT_EQ(key % 3 == 0, result[key].has_value()) << key;
+    if (key % 3 == 0) {
+      EXPECT_EQ(key, result[key]->GetSlotNum());
+    }
+  }
+
+  // out of order, with repeats
+  std::vector<GenericKey<8>> shuffled_keys = keys;
+  shuffled_keys.insert(shuffled_keys.end(), keys.begin(), keys.begin() + 50);
+  std::shuffle(shuffled_keys.begin(), shuffled_keys.end(), std::default_random_engine{});
+  EXPECT_EQ(117, tree.GetValues(shuffled_keys, &result));
+  for (size_t i = 0; i < shuffled_keys.size(); i++) {
+    const int64_t key = shuffled_keys[i].ToString();
+    ASSERT_EQ(key % 3 == 0, result[i].has_value()) << key;
+    if (key % 3 == 0) {
+      EXPECT_EQ(key, result[i]->GetSlotNum());
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+// Normalized keys order like their values do, column by column, for signed integers and decimals of either sign
+TEST(BPlusTreeTests, NormalizedKeyTest) {
+  auto key_schema = ParseCreateStatement("a boolean,b smallint,c double,d integer");
+  GenericComparator<16> comparator(key_schema.get());
+  EXPECT_EQ(15, comparator.GetNormalizedSize());
+
+  std::default_random_engine engine;
+  std::uniform_int_distribution<int> dist(-2, 2);
+  std::vector<std::vector<Value>> values;
+  std::vector<GenericKey<16>> keys;
+  for (int i = 0; i < 200; i++) {
+    values.push_back({ValueFactory::GetBooleanValue(dist(engine) > 0), ValueFactory::GetSmallIntValue(dist(engine)),
+                      ValueFactory::GetDecimalValue(dist(engine) * 0.5), ValueFactory::GetIntegerValue(dist(engine))});
+    keys.emplace_back();
+    keys.back().SetFromKey(Tuple(values.back(), key_schema.get()));
+  }
+  // -0.0 is 0.0
+  values.push_back(values.back());
+  values.back()[2] = ValueFactory::GetDecimalValue(-0.0);
+  keys.push_back(keys.back());
+  keys.back().SetFromKey(Tuple(values.back(), key_schema.get()));
+  values.back()[2] = ValueFactory::GetDecimalValue(0.0);
+  keys.push_back(keys.back());
+  keys.back().SetFromKey(Tuple(values.back(), key_schema.get()));
+  values.push_back(values.back());
+
+  for (size_t i = 0; i < keys.size(); i++) {
+    // the head comes from the first three columns only, the last of which it ends in the middle of
+    GenericComparator<16>::NormalizedKey normalized{};
+    comparator.Normalize(keys[i], &normalized);
+    ASSERT_EQ(GenericComparator<16>::Head(normalized, 0), comparator.NormalizeHead(keys[i])) << i;
+    for (size_t j = 0; j < keys.size(); j++) {
+      int expected = 0;
+      for (size_t column = 0; column < 4 && expected == 0; column++) {
+        if (values[i][column].CompareLessThan(values[j][column]) == CmpBool::CmpTrue) {
+          expected = -1;
+        } else if (values[i][column].CompareGreaterThan(values[j][column]) == CmpBool::CmpTrue) {
+          expected = 1;
+        }
+      }
+      ASSERT_EQ(expected, comparator(keys[i], keys[j])) << i << " " << j;
+    }
+  }
+
+  auto varchar_schema = ParseCreateStatement("a varchar(4)");
+  EXPECT_EQ(0, GenericComparator<16>(varchar_schema.get()).GetNormalizedSize());
+
+  // a null sorts before the smallest other value of its type
+  // timestamps are left out: tuples can't hold them, as they have no Type to serialize them
+  for (const auto &smallest :
+       {ValueFactory::GetBooleanValue(false), ValueFactory::GetSmallIntValue(BUSTUB_INT16_MIN),
+        ValueFactory::GetIntegerValue(BUSTUB_INT32_MIN), ValueFactory::GetBigIntValue(BUSTUB_INT64_MIN),
+        ValueFactory::GetDecimalValue(BUSTUB_DECIMAL_MIN)}) {
+    Schema null_schema({Column("a", smallest.GetTypeId())});
+    GenericComparator<8> null_comparator(&null_schema);
+    GenericKey<8> null_key;
+    GenericKey<8> smallest_key;
+    null_key.SetFromKey(Tuple({ValueFactory::GetNullValueByType(smallest.GetTypeId())}, &null_schema));
+    smallest_key.SetFromKey(Tuple({smallest}, &null_schema));
+    EXPECT_EQ(-1, null_comparator(null_key, smallest_key)) << smallest.ToString();
+    EXPECT_EQ(1, null_comparator(smallest_key, null_key)) << smallest.ToString();
+  }
+}
+
+// NOLINTNEXTLINE
+// Two-column keys, whose heads are often equal so that the rest of them decides, are found in key order
+TEST(BPlusTreeTests, MultiColumnKeyTest) {
+  auto key_schema = ParseCreateStatement("a integer,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<16>, RID, GenericComparator<16>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 5,
+                                                             5);
+  auto make_key = [&](int32_t a, int64_t b) {
+    GenericKey<16> index_key;
+    index_key.SetFromKey(Tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetBigIntValue(b)}, key_schema.get()));
+    return index_key;
+  };
+
+  // a from -4 to 3, b from -1000 to 1000 in steps of 40, slot numbers in key order
+  std::vector<std::pair<int32_t, int64_t>> pairs;
+  for (int32_t a = -4; a < 4; a++) {
+    for (int64_t b = -1000; b <= 1000; b += 40) {
+      pairs.emplace_back(a, b);
+    }
+  }
+  std::vector<size_t> order(pairs.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), std::default_random_engine{});
+  for (size_t i : order) {
+    ASSERT_TRUE(tree.Insert(make_key(pairs[i].first, pairs[i].second), RID(0, i)));
+  }
+
+  size_t current = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(current, (*iterator).second.GetSlotNum());
+    current++;
+  }
+  EXPECT_EQ(pairs.size(), current);
+
+  std::vector<RID> rids;
+  for (size_t i = 0; i < pairs.size(); i++) {
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(make_key(pairs[i].first, pairs[i].second), &rids));
+    EXPECT_EQ(i, rids[0].GetSlotNum());
+    EXPECT_FALSE(tree.GetValue(make_key(pairs[i].first, pairs[i].second + 1), &rids));
+  }
+  EXPECT_EQ(2 * 51 + 25, (*tree.Begin(make_key(-2, 0))).second.GetSlotNum());
+  EXPECT_EQ(2 * 51 + 26, (*tree.Begin(make_key(-2, 1))).second.GetSlotNum());
+  EXPECT_EQ(3 * 51, (*tree.Begin(make_key(-2, 5000))).second.GetSlotNum());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -24,12 +26,14 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   };
 };
 
@@ -55,6 +59,233 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadWritePagesTest) {
+  char data[4][BUSTUB_PAGE_SIZE] = {{0}};
+  char buf[5][BUSTUB_PAGE_SIZE] = {{0}};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  for (int i = 0; i < 4; i++) {
+    snprintf(data[i], BUSTUB_PAGE_SIZE, "page %d", i);
+  }
+
+  // Pages 1, 2 and 3 are adjacent and written with one call, page 7 with another.
+  dm.WritePages({{3, data[3]}, {1, data[1]}, {7, data[0]}, {2, data[2]}});
+  EXPECT_EQ(4, dm.GetNumWrites());
+  EXPECT_EQ(2, dm.GetNumIOs());
+
+  // Page 8 lies past the end of the file and reads as zeros.
+  std::memset(buf[4], 1, BUSTUB_PAGE_SIZE);
+  dm.ReadPages({{7, buf[0]}, {2, buf[2]}, {1, buf[1]}, {3, buf[3]}, {8, buf[4]}});
+  EXPECT_EQ(5, dm.GetNumReads());
+  EXPECT_EQ(4, dm.GetNumIOs());
+  EXPECT_EQ(std::memcmp(buf[0], data[0], BUSTUB_PAGE_SIZE), 0);
+  for (int i = 1; i < 4; i++) {
+    EXPECT_EQ(std::memcmp(buf[i], data[i], BUSTUB_PAGE_SIZE), 0);
+  }
+  EXPECT_EQ(0, buf[4][0]);
+  EXPECT_EQ(0, buf[4][BUSTUB_PAGE_SIZE - 1]);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocatePageTest) {
+  auto dm = DiskManager("test.db");
+  for (page_id_t i = 0; i < 10; i++) {
+    EXPECT_EQ(i, dm.AllocatePage());
+  }
+
+  // Freed pages are reused, lowest first, before the file grows.
+  dm.DeallocatePage(5);
+  dm.DeallocatePage(3);
+  dm.DeallocatePage(3);
+  EXPECT_FALSE(dm.IsPageAllocated(3));
+  EXPECT_EQ(2, dm.GetNumFreePages());
+  EXPECT_EQ(3, dm.AllocatePage());
+  EXPECT_EQ(5, dm.AllocatePage());
+  EXPECT_EQ(10, dm.AllocatePage());
+  EXPECT_EQ(0, dm.GetNumFreePages());
+
+  // With a hint, the closest free page wins, preferring pages after the hint.
+  dm.DeallocatePage(1);
+  dm.DeallocatePage(4);
+  dm.DeallocatePage(8);
+  EXPECT_EQ(8, dm.AllocatePage(6));
+  EXPECT_EQ(4, dm.AllocatePage(6));
+  // Nothing free near the hint, but the end of the file is.
+  EXPECT_EQ(11, dm.AllocatePage(9));
+  EXPECT_EQ(1, dm.AllocatePage(9 + FSM_HINT_DISTANCE * 2));
+
+  // Only ids of the requested stride are returned; the ids skipped are left free.
+  EXPECT_EQ(13, dm.AllocatePage(INVALID_PAGE_ID, 4, 1));
+  EXPECT_TRUE(dm.IsPageAllocated(13));
+  EXPECT_FALSE(dm.IsPageAllocated(12));
+  EXPECT_EQ(12, dm.AllocatePage());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreeSpaceMapPersistenceTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  {
+    auto dm = DiskManager("test.db");
+    for (page_id_t i = 0; i < 5; i++) {
+      EXPECT_EQ(i, dm.AllocatePage());
+      dm.WritePage(i, data);
+    }
+    dm.DeallocatePage(1);
+    dm.ShutDown();
+  }
+  {
+    // The map survives a restart.
+    auto dm = DiskManager("test.db");
+    EXPECT_FALSE(dm.IsPageAllocated(1));
+    EXPECT_TRUE(dm.IsPageAllocated(4));
+    EXPECT_EQ(1, dm.AllocatePage());
+    EXPECT_EQ(5, dm.AllocatePage());
+    dm.ShutDown();
+  }
+  remove("test.fsm");
+  {
+    // A database file without a map is assumed to use every page it holds.
+    auto dm = DiskManager("test.db");
+    EXPECT_TRUE(dm.IsPageAllocated(1));
+    EXPECT_EQ(5, dm.AllocatePage());
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+// Allocations reach the map file only when it is flushed, and each stride offset takes its own lowest free page
+TEST_F(DiskManagerTest, FreeSpaceMapFlushTest) {
+  auto dm = DiskManager("test.db");
+  const auto header_size = std::filesystem::file_size("test.fsm");
+  auto first_bitmap_byte = [] {
+    std::ifstream fsm("test.fsm", std::ios::binary);
+    fsm.seekg(BUSTUB_PAGE_SIZE);
+    return static_cast<uint8_t>(fsm.get());
+  };
+  for (page_id_t i = 0; i < 100; i++) {
+    EXPECT_EQ(i, dm.AllocatePage());
+  }
+  // Allocations are written through, deallocations wait for the flush.
+  EXPECT_EQ(header_size + BUSTUB_PAGE_SIZE, std::filesystem::file_size("test.fsm"));
+  EXPECT_EQ(0xFF, first_bitmap_byte());
+
+  for (page_id_t i = 0; i < 100; i++) {
+    dm.DeallocatePage(i);
+  }
+  EXPECT_EQ(0xFF, first_bitmap_byte());
+  dm.FlushFreeSpaceMap();
+  EXPECT_EQ(0x00, first_bitmap_byte());
+  EXPECT_EQ(3, dm.AllocatePage(INVALID_PAGE_ID, 4, 3));
+  EXPECT_EQ(7, dm.AllocatePage(INVALID_PAGE_ID, 4, 3));
+  EXPECT_EQ(0, dm.AllocatePage(INVALID_PAGE_ID, 4, 0));
+  EXPECT_EQ(50, dm.AllocatePage(51, 4, 2));
+  EXPECT_EQ(1, dm.AllocatePage(INVALID_PAGE_ID, 4, 1));
+  EXPECT_EQ(5, dm.AllocatePage(INVALID_PAGE_ID, 4, 1));
+  EXPECT_EQ(94, dm.GetNumFreePages());
+  EXPECT_EQ(2, dm.AllocatePage());
+  EXPECT_EQ(93, dm.GetNumFreePages());
+  dm.ShutDown();
+
+  auto reopened = DiskManager("test.db");
+  EXPECT_TRUE(reopened.IsPageAllocated(50));
+  EXPECT_FALSE(reopened.IsPageAllocated(4));
+  EXPECT_TRUE(reopened.IsPageAllocated(7));
+  // Free pages past the last allocated one are not kept across a reopen.
+  EXPECT_EQ(44, reopened.GetNumFreePages());
+  reopened.ShutDown();
+}
+
+// NOLINTNEXTLINE
+// Pages of the db file that a stale map does not know of, as a crash may leave it, are not handed out again
+TEST_F(DiskManagerTest, FreeSpaceMapStaleTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  {
+    auto dm = DiskManager("test.db");
+    for (page_id_t i = 0; i < 4; i++) {
+      EXPECT_EQ(i, dm.AllocatePage());
+      memset(data, 'A' + i, BUSTUB_PAGE_SIZE);
+      dm.WritePage(i, data);
+    }
+    dm.ShutDown();
+  }
+  // the map as it was before the pages were allocated: its header page only
+  std::filesystem::resize_file("test.fsm", BUSTUB_PAGE_SIZE);
+
+  {
+    auto dm = DiskManager("test.db");
+    EXPECT_TRUE(dm.IsPageAllocated(0));
+    EXPECT_TRUE(dm.IsPageAllocated(3));
+    EXPECT_EQ(0, dm.GetNumFreePages());
+    EXPECT_EQ(4, dm.AllocatePage());
+    dm.ReadPage(0, data);
+    EXPECT_EQ('A', data[0]);
+    dm.ShutDown();
+  }
+  // the pages are recorded in the map again
+  EXPECT_EQ(static_cast<uintmax_t>(2 * BUSTUB_PAGE_SIZE), std::filesystem::file_size("test.fsm"));
+}
+
+// NOLINTNEXTLINE
+// The db file records its page size in a header page, which is checked whether or not the map file is there
+TEST_F(DiskManagerTest, PageSizeHeaderTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  {
+    auto dm = DiskManager("test.db");
+    for (page_id_t i = 0; i < 3; i++) {
+      EXPECT_EQ(i, dm.AllocatePage());
+      dm.WritePage(i, data);
+    }
+    dm.ShutDown();
+  }
+  EXPECT_EQ(static_cast<uintmax_t>(4 * BUSTUB_PAGE_SIZE), std::filesystem::file_size("test.db"));
+  EXPECT_EQ(static_cast<uintmax_t>(2 * BUSTUB_PAGE_SIZE), std::filesystem::file_size("test.fsm"));
+
+  // A missing map is rebuilt with every page of the db file in use.
+  remove("test.fsm");
+  {
+    auto dm = DiskManager("test.db");
+    EXPECT_TRUE(dm.IsPageAllocated(2));
+    EXPECT_EQ(3, dm.AllocatePage());
+    dm.ShutDown();
+  }
+
+  // A database created with another page size is rejected, with or without its map.
+  const uint32_t page_size = BUSTUB_PAGE_SIZE;
+  const uint32_t other_page_size = BUSTUB_PAGE_SIZE * 2;
+  {
+    std::fstream db("test.db", std::ios::binary | std::ios::in | std::ios::out);
+    db.seekp(sizeof(uint32_t));
+    db.write(reinterpret_cast<const char *>(&other_page_size), sizeof(other_page_size));
+  }
+  EXPECT_THROW(DiskManager("test.db"), Exception);
+  remove("test.fsm");
+  EXPECT_THROW(DiskManager("test.db"), Exception);
+  EXPECT_FALSE(std::filesystem::exists("test.fsm"));
+  {
+    std::fstream db("test.db", std::ios::binary | std::ios::in | std::ios::out);
+    db.seekp(sizeof(uint32_t));
+    db.write(reinterpret_cast<const char *>(&page_size), sizeof(page_size));
+  }
+
+  // Neither a map file nor a db file without a header is used.
+  {
+    std::fstream fsm("test.fsm", std::ios::binary | std::ios::trunc | std::ios::out);
+    fsm.write(data, BUSTUB_PAGE_SIZE);
+  }
+  EXPECT_THROW(DiskManager("test.db"), Exception);
+  {
+    std::fstream db("test.db", std::ios::binary | std::ios::trunc | std::ios::out);
+    db.write(data, BUSTUB_PAGE_SIZE);
+  }
+  remove("test.fsm");
+  EXPECT_THROW(DiskManager("test.db"), Exception);
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager_test.cpp
+//
+// Identification: test/storage/mmap_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <string>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "storage/disk/mmap_disk_manager.h"
+
+namespace bustub {
+
+class MmapDiskManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  };
+};
+
+// NOLINTNEXTLINE
+// An existing db file is mapped whole pages at a time, and nothing can be written through the mapping disk manager
+TEST_F(MmapDiskManagerTest, PinMappedPageTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  EXPECT_THROW(MmapDiskManager("test.db"), Exception);
+
+  {
+    DiskManager dm("test.db");
+    std::strncpy(data, "A test string.", sizeof(data));
+    dm.WritePage(0, data);
+    dm.WritePage(3, data);
+    dm.ShutDown();
+  }
+
+  MmapDiskManager dm("test.db");
+  EXPECT_TRUE(dm.IsReadOnly());
+  const char *page = dm.PinMappedPage(3);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(std::memcmp(page, data, sizeof(data)), 0);
+  dm.UnpinMappedPage(3);
+  EXPECT_EQ(nullptr, dm.PinMappedPage(4));
+  EXPECT_EQ(nullptr, dm.PinMappedPage(INVALID_PAGE_ID));
+
+  EXPECT_THROW(dm.WritePage(0, data), Exception);
+  EXPECT_THROW(dm.WritePages({{0, data}}), Exception);
+
+  dm.ShutDown();
+}
+
+/** Writes pages 0, 1 and 2 holding "page <id>" through a buffer pool of the plain disk manager. */
+static void WriteTestPages(page_id_t *page_ids, size_t num_instances) {
+  DiskManager dm("test.db");
+  ParallelBufferPoolManager bpm(num_instances, 2, &dm);
+  for (size_t i = 0; i < 3; i++) {
+    auto *page = bpm.NewPage(&page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_DATA_SIZE, "page %d", page_ids[i]);
+    bpm.UnpinPage(page_ids[i], true);
+  }
+  bpm.FlushAllPages();
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+// Pages that are not resident are read from the mapping of a read-only pool, which hands out no page to write
+TEST_F(MmapDiskManagerTest, FetchPageReadTest) {
+  page_id_t page_ids[3];
+  WriteTestPages(page_ids, 1);
+
+  MmapDiskManager dm("test.db");
+  BufferPoolManagerInstance bpm(2, &dm);
+  {
+    auto guard = bpm.FetchPageRead(page_ids[0]);
+    EXPECT_TRUE(guard.IsMapped());
+    EXPECT_EQ(page_ids[0], guard.PageId());
+    EXPECT_EQ(std::string(guard.GetData()), "page 0");
+    EXPECT_EQ(1, bpm.GetMappedReadCount());
+  }
+
+  // a resident page is read from its frame
+  auto *page = bpm.FetchPage(page_ids[1]);
+  ASSERT_NE(nullptr, page);
+  {
+    auto guard = bpm.FetchPageRead(page_ids[1]);
+    EXPECT_FALSE(guard.IsMapped());
+    EXPECT_EQ(std::string(guard.GetData()), "page 1");
+  }
+  bpm.UnpinPage(page_ids[1], false);
+  EXPECT_EQ(1, bpm.GetMappedReadCount());
+
+  // writers, which could change a page under a reader of the mapping, are refused
+  page_id_t page_id;
+  EXPECT_THROW(bpm.FetchPageWrite(page_ids[2]), Exception);
+  EXPECT_THROW(bpm.NewPage(&page_id), Exception);
+  EXPECT_THROW(bpm.DeletePage(page_ids[2]), Exception);
+  {
+    auto guard = bpm.FetchPageRead(page_ids[2]);
+    EXPECT_TRUE(guard.IsMapped());
+    EXPECT_EQ(std::string(guard.GetData()), "page 2");
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+// A parallel pool looks for a resident page in its instance before reading it from the mapping
+TEST_F(MmapDiskManagerTest, ParallelFetchPageReadTest) {
+  page_id_t page_ids[3];
+  WriteTestPages(page_ids, 2);
+
+  MmapDiskManager dm("test.db");
+  ParallelBufferPoolManager bpm(2, 2, &dm);
+  auto *page = bpm.FetchPage(page_ids[1]);
+  ASSERT_NE(nullptr, page);
+  {
+    auto guard = bpm.FetchPageRead(page_ids[1]);
+    EXPECT_FALSE(guard.IsMapped());
+  }
+  bpm.UnpinPage(page_ids[1], false);
+  {
+    auto guard = bpm.FetchPageRead(page_ids[2]);
+    EXPECT_TRUE(guard.IsMapped());
+    EXPECT_EQ(std::string(guard.GetData()), fmt::format("page {}", page_ids[2]));
+  }
+
+  dm.ShutDown();
+}
+
+}  // namespace bustub
@@ -10,11 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "storage/disk/disk_manager_memory.h"
 #include "storage/page/page_guard.h"
 
@@ -29,7 +32,7 @@ TEST(PageGuardTest, DISABLED_SampleTest) {
   const size_t k = 2;
 
   auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_shared<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  auto bpm = std::make_shared<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), k);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -48,4 +51,224 @@ TEST(PageGuardTest, DISABLED_SampleTest) {
   disk_manager->ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST(PageGuardTest, OptimisticReadTest) {
+  const size_t buffer_pool_size = 5;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), k);
+
+  page_id_t page_id;
+  auto *page0 = bpm->NewPage(&page_id);
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "version 0");
+  bpm->UnpinPage(page_id, true);
+  EXPECT_EQ(0, page0->GetVersion());
+
+  // Scenario: Readers do not change the version, and it validates while nobody writes.
+  {
+    auto guard = bpm->FetchPageOptimistic(page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(0, page0->GetPinCount());
+    EXPECT_EQ(std::string(guard.GetData()), "version 0");
+    auto read_guard = bpm->FetchPageRead(page_id);
+    read_guard.Drop();
+    EXPECT_TRUE(guard.Validate());
+  }
+  EXPECT_EQ(0, page0->GetPinCount());
+
+  // Scenario: The version is odd while a writer holds the page, and readers that started before the write fail to
+  // validate.
+  {
+    auto guard = bpm->FetchPageOptimistic(page_id);
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    EXPECT_EQ(1, page0->GetVersion() % 2);
+    snprintf(write_guard.GetDataMut(), BUSTUB_PAGE_SIZE, "version 1");
+    write_guard.Drop();
+    EXPECT_EQ(2, page0->GetVersion());
+    EXPECT_FALSE(guard.Validate());
+
+    guard = bpm->FetchPageOptimistic(page_id);
+    EXPECT_EQ(std::string(guard.GetData()), "version 1");
+    EXPECT_TRUE(guard.Validate());
+  }
+
+  // Scenario: An empty guard never validates.
+  OptimisticReadGuard empty;
+  EXPECT_FALSE(empty.IsValid());
+  EXPECT_FALSE(empty.Validate());
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, EpochReadTest) {
+  const size_t buffer_pool_size = 5;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), k);
+
+  page_id_t page_id;
+  auto *page0 = bpm->NewPage(&page_id);
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "epoch");
+  bpm->UnpinPage(page_id, true);
+
+  // Scenario: An epoch guard does not pin the page, but its latch keeps the page in its frame.
+  {
+    auto guard = bpm->FetchPageEpoch(page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(0, page0->GetPinCount());
+    EXPECT_EQ(std::string(guard.GetData()), "epoch");
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      bpm->UnpinPage(page_id_temp, false);
+    }
+    EXPECT_EQ(page_id, page0->GetPageId());
+    EXPECT_EQ(std::string(guard.GetData()), "epoch");
+    EXPECT_FALSE(bpm->DeletePage(page_id));
+  }
+
+  // Scenario: Evicting a page under an optimistic reader fails its validation.
+  {
+    auto guard = bpm->FetchPageOptimistic(page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(0, page0->GetPinCount());
+    EXPECT_TRUE(guard.Validate());
+    std::vector<page_id_t> pinned_pages;
+    page_id_t page_id_temp;
+    while (bpm->NewPage(&page_id_temp) != nullptr) {
+      pinned_pages.push_back(page_id_temp);
+    }
+    EXPECT_EQ(buffer_pool_size, pinned_pages.size());
+    EXPECT_FALSE(guard.Validate());
+    for (auto pinned_page_id : pinned_pages) {
+      bpm->UnpinPage(pinned_page_id, false);
+    }
+  }
+
+  // Scenario: The evicted page is read back from disk.
+  {
+    auto guard = bpm->FetchPageEpoch(page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(std::string(guard.GetData()), "epoch");
+  }
+  EXPECT_TRUE(bpm->DeletePage(page_id));
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, EpochConcurrencyTest) {
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const int num_readers = 4;
+  const int num_reads = 20000;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), 2);
+
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+
+  // Readers keep finding the page they asked for although four times as many pages as frames are being read.
+  std::atomic<int> wrong_pages{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < num_readers; t++) {
+    readers.emplace_back([&, t] {
+      std::mt19937 gen(t);
+      for (int i = 0; i < num_reads; i++) {
+        page_id_t page_id = page_ids[gen() % page_ids.size()];
+        const std::string expected = "page " + std::to_string(page_id);
+        if (i % 2 == 0) {
+          auto guard = bpm->FetchPageEpoch(page_id);
+          if (!guard.IsValid() || expected != guard.GetData()) {
+            wrong_pages++;
+          }
+        } else {
+          auto guard = bpm->FetchPageOptimistic(page_id);
+          if (!guard.IsValid()) {
+            wrong_pages++;
+            continue;
+          }
+          const std::string data(guard.GetData(), expected.size());
+          if (guard.Validate() && data != expected) {
+            wrong_pages++;
+          }
+        }
+      }
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, wrong_pages);
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+// With more pin-free readers than epoch slots, evictions neither wait for readers nor lose the frames they retire
+TEST(PageGuardTest, EpochSharedSlotTest) {
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const size_t num_readers = EpochManager::EPOCH_SLOTS + 8;
+  const int num_reads = 500;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get(), 2);
+
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+
+  // A fetch may find every frame retired and come back empty, but a page it does return is the right one.
+  std::atomic<int> wrong_pages{0};
+  std::vector<std::thread> readers;
+  for (size_t t = 0; t < num_readers; t++) {
+    readers.emplace_back([&, t] {
+      std::mt19937 gen(t);
+      for (int i = 0; i < num_reads; i++) {
+        page_id_t page_id = page_ids[gen() % page_ids.size()];
+        auto guard = bpm->FetchPageEpoch(page_id);
+        if (guard.IsValid() && "page " + std::to_string(page_id) != guard.GetData()) {
+          wrong_pages++;
+        }
+      }
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, wrong_pages);
+
+  // Once the readers are gone, every retired frame can be reused.
+  std::vector<page_id_t> pinned_pages;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_ids[i]), page->GetData());
+    pinned_pages.push_back(page_ids[i]);
+  }
+  for (auto pinned_page_id : pinned_pages) {
+    bpm->UnpinPage(pinned_page_id, false);
+  }
+
+  disk_manager->ShutDown();
+}
+
 }  // namespace bustub
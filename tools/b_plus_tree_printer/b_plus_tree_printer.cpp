@@ -13,13 +13,13 @@
 #include <cstdio>
 #include <iostream>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "common/logger.h"
 #include "storage/index/b_plus_tree.h"
 #include "test_util.h"  // NOLINT
 
 using bustub::BPlusTree;
-using bustub::BufferPoolManager;
+using bustub::BufferPoolManagerInstance;
 using bustub::DiskManager;
 using bustub::Exception;
 using bustub::GenericComparator;
@@ -72,7 +72,7 @@ auto main(int argc, char **argv) -> int {
   GenericComparator<8> comparator(key_schema.get());
 
   auto *disk_manager = new DiskManager("test.db");
-  auto *bpm = new BufferPoolManager(100, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(100, disk_manager);
   // create and fetch header_page
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <memory>
@@ -6,14 +8,17 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <cpp_random_distributions/zipfian_int_distribution.h>
 
 #include "argparse/argparse.hpp"
 #include "binder/binder.h"
-#include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
@@ -100,16 +105,227 @@ struct BpmMetrics {
   }
 };
 
+/** Print hit, miss and latch contention counts of every buffer pool instance. */
+void ReportShards(bustub::BufferPoolManager *bpm) {
+  std::vector<bustub::BufferPoolManager *> shards;
+  if (auto *parallel_bpm = dynamic_cast<bustub::ParallelBufferPoolManager *>(bpm); parallel_bpm != nullptr) {
+    for (size_t i = 0; i < parallel_bpm->GetNumInstances(); i++) {
+      shards.push_back(parallel_bpm->GetInstance(i));
+    }
+  } else {
+    shards.push_back(bpm);
+  }
+
+  fmt::print("<<< BEGIN SHARDS\n");
+  for (size_t i = 0; i < shards.size(); i++) {
+    auto hit = shards[i]->GetHitCount();
+    auto miss = shards[i]->GetMissCount();
+    auto total = hit + miss;
+    fmt::print("shard {:>2}: hit={:<10} miss={:<10} hit_rate={:<6.3f} contention={:<10} fg_writes={:<10} bg_writes={:<10} "
+               "prefetches={}\n",
+               i, hit, miss, total == 0 ? 0.0 : hit / static_cast<double>(total), shards[i]->GetContentionCount(),
+               shards[i]->GetForegroundWriteCount(), shards[i]->GetBackgroundWriteCount(),
+               shards[i]->GetPrefetchCount());
+  }
+  fmt::print(">>> END SHARDS\n");
+}
+
+/** Print the counters of the whole buffer pool, and the hottest pages if the heat map was on. */
+void ReportStats(bustub::BufferPoolManager *bpm) {
+  fmt::print("<<< BEGIN STATS\n");
+  fmt::print("{}\n", bpm->GetStats().ToString());
+  for (const auto &[page_id, samples] : bpm->GetHottestPages(10)) {
+    fmt::print("hot page {:<8} sampled_accesses={}\n", page_id, samples);
+  }
+  fmt::print(">>> END STATS\n");
+}
+
+/**
+ * Compare lookups in the lock-free PageTable against a mutex-guarded std::unordered_map (the previous page table) at
+ * 1, 8 and 32 threads. Every lookup hits, as on the fast path of FetchPage.
+ */
+void RunPageTableBench(uint64_t duration_ms) {
+  using bustub::frame_id_t;
+  using bustub::page_id_t;
+
+  bustub::PageTable page_table(BUSTUB_BPM_SIZE);
+  std::unordered_map<page_id_t, frame_id_t> map;
+  std::mutex map_latch;
+  for (size_t i = 0; i < BUSTUB_BPM_SIZE; i++) {
+    page_table.Insert(static_cast<page_id_t>(i), static_cast<frame_id_t>(i));
+    map[static_cast<page_id_t>(i)] = static_cast<frame_id_t>(i);
+  }
+
+  auto run = [duration_ms](size_t thread_cnt, auto &&lookup) {
+    std::atomic<uint64_t> total{0};
+    std::vector<std::thread> threads;
+    auto start = ClockMs();
+    for (size_t thread_id = 0; thread_id < thread_cnt; thread_id++) {
+      threads.emplace_back([&total, &lookup, start, duration_ms, thread_id] {
+        uint64_t cnt = 0;
+        auto page_id = static_cast<page_id_t>(thread_id % BUSTUB_BPM_SIZE);
+        while (ClockMs() - start < duration_ms) {
+          // check the clock only every few thousand lookups so that it does not dominate the measurement
+          for (size_t i = 0; i < 4096; i++) {
+            if (lookup(page_id) != page_id) {
+              throw std::runtime_error("invalid frame");
+            }
+            page_id = static_cast<page_id_t>((page_id + 1) % BUSTUB_BPM_SIZE);
+          }
+          cnt += 4096;
+        }
+        total += cnt;
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    return total / static_cast<double>(ClockMs() - start) * 1000;
+  };
+
+  fmt::print("<<< BEGIN PAGE TABLE\n");
+  for (size_t thread_cnt : {1, 8, 32}) {
+    auto lock_free = run(thread_cnt, [&page_table](page_id_t page_id) {
+      frame_id_t frame_id = -1;
+      page_table.Find(page_id, &frame_id);
+      return frame_id;
+    });
+    auto latched = run(thread_cnt, [&map, &map_latch](page_id_t page_id) {
+      std::scoped_lock l(map_latch);
+      return map.find(page_id)->second;
+    });
+    fmt::print("threads={:<3} page_table: {:<14.0f} unordered_map+mutex: {:<14.0f}\n", thread_cnt, lock_free, latched);
+  }
+  fmt::print(">>> END PAGE TABLE\n");
+}
+
+/** One access of a replayed trace. */
+struct TraceAccess {
+  size_t page_idx_;
+  bustub::AccessType access_type_;
+};
+
+/**
+ * Build the trace of the main benchmark without running it: BUSTUB_SCAN_THREAD sequential scan cursors and
+ * BUSTUB_GET_THREAD zipfian point lookups, interleaved at random.
+ */
+auto MakeMixedTrace(size_t length) -> std::vector<TraceAccess> {
+  std::default_random_engine gen(42);
+  zipfian_int_distribution<size_t> get_dist(0, BUSTUB_PAGE_CNT - 1, 0.8);
+  std::uniform_int_distribution<size_t> thread_dist(0, BUSTUB_SCAN_THREAD + BUSTUB_GET_THREAD - 1);
+  std::vector<size_t> scan_cursors;
+  for (size_t thread_id = 0; thread_id < BUSTUB_SCAN_THREAD; thread_id++) {
+    scan_cursors.push_back(BUSTUB_PAGE_CNT * thread_id / BUSTUB_SCAN_THREAD);
+  }
+  std::vector<TraceAccess> trace;
+  trace.reserve(length);
+  for (size_t i = 0; i < length; i++) {
+    auto thread_id = thread_dist(gen);
+    if (thread_id < BUSTUB_SCAN_THREAD) {
+      auto &cursor = scan_cursors[thread_id];
+      trace.push_back({cursor, bustub::AccessType::Scan});
+      cursor = (cursor + 1) % BUSTUB_PAGE_CNT;
+    } else {
+      trace.push_back({get_dist(gen), bustub::AccessType::Get});
+    }
+  }
+  return trace;
+}
+
+/**
+ * Replay a trace against a buffer of BUSTUB_BPM_SIZE frames managed by one replacement policy, and print the hit rate
+ * of the Get and Scan accesses. Every access is recorded with its page so that policies keeping a history of evicted
+ * pages see the same input as inside the buffer pool.
+ */
+void ReplayTrace(bustub::ReplacerPolicy policy, const std::vector<TraceAccess> &trace) {
+  using bustub::AccessType;
+  using bustub::frame_id_t;
+
+  auto replacer = bustub::MakeReplacer(policy, BUSTUB_BPM_SIZE, LRU_K_SIZE);
+  std::unordered_map<size_t, frame_id_t> resident;
+  std::vector<size_t> frame_pages(BUSTUB_BPM_SIZE);
+  size_t used_frames = 0;
+  uint64_t hits[2] = {0, 0};
+  uint64_t accesses[2] = {0, 0};
+  for (const auto &access : trace) {
+    size_t type = access.access_type_ == AccessType::Get ? 0 : 1;
+    accesses[type]++;
+    frame_id_t frame_id;
+    if (auto it = resident.find(access.page_idx_); it != resident.end()) {
+      hits[type]++;
+      frame_id = it->second;
+    } else if (used_frames < BUSTUB_BPM_SIZE) {
+      frame_id = static_cast<frame_id_t>(used_frames++);
+    } else {
+      if (!replacer->Evict(&frame_id)) {
+        throw std::runtime_error("replacer has no victim");
+      }
+      resident.erase(frame_pages[frame_id]);
+    }
+    resident[access.page_idx_] = frame_id;
+    frame_pages[frame_id] = access.page_idx_;
+    replacer->RecordAccess(frame_id, access.access_type_, static_cast<bustub::page_id_t>(access.page_idx_));
+    replacer->SetEvictable(frame_id, true);
+  }
+  fmt::print("{:<10} get_hit_rate={:<8.4f} scan_hit_rate={:<8.4f}\n", bustub::ReplacerPolicyToString(policy),
+             hits[0] / static_cast<double>(accesses[0]), hits[1] / static_cast<double>(accesses[1]));
+}
+
+/** Compare the hit rates of every replacement policy on the same mixed scan/get trace. */
+void RunHitRateBench() {
+  using bustub::ReplacerPolicy;
+
+  auto trace = MakeMixedTrace(1000000);
+  fmt::print("<<< BEGIN HIT RATE\n");
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::Clock, ReplacerPolicy::LRUK, ReplacerPolicy::ARC,
+                      ReplacerPolicy::TwoQ, ReplacerPolicy::ClockPro}) {
+    ReplayTrace(policy, trace);
+  }
+  fmt::print(">>> END HIT RATE\n");
+}
+
+/** @return the policy whose short name is `name`; throws if there is none */
+auto ParseReplacerPolicy(const std::string &name) -> bustub::ReplacerPolicy {
+  using bustub::ReplacerPolicy;
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::Clock, ReplacerPolicy::LRUK, ReplacerPolicy::ARC,
+                      ReplacerPolicy::TwoQ, ReplacerPolicy::ClockPro}) {
+    if (bustub::ReplacerPolicyToString(policy) == name) {
+      return policy;
+    }
+  }
+  throw std::runtime_error("unknown replacer: " + name);
+}
+
 // NOLINTNEXTLINE
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
   using bustub::BufferPoolManager;
+  using bustub::BufferPoolManagerInstance;
   using bustub::DiskManagerUnlimitedMemory;
+  using bustub::ParallelBufferPoolManager;
   using bustub::page_id_t;
 
   argparse::ArgumentParser program("bustub-bpm-bench");
   program.add_argument("--duration").help("run bpm bench for n milliseconds");
   program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--instances").help("split the buffer pool into n parallel instances");
+  program.add_argument("--bg-writer").help("run a background writer keeping n frames clean");
+  program.add_argument("--prefetch").help("let scan threads prefetch the page n pages ahead of them");
+  program.add_argument("--heat-map").help("sample one in every n page accesses into a heat map");
+  program.add_argument("--compressed-cache").help("keep n MiB of evicted pages compressed in memory");
+  program.add_argument("--replacer").help("replacement policy: lru, clock, lru-k, arc, 2q or clock-pro");
+  program.add_argument("--epoch-reads")
+      .help("let get threads read pages through FetchPageEpoch instead of pinning them")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--page-table")
+      .help("only run the page table lookup microbenchmark")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--hit-rate")
+      .help("only compare replacer hit rates on a replayed mixed scan/get trace")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_args(argc, argv);
@@ -129,12 +345,44 @@ auto main(int argc, char **argv) -> int {
     latency_ms = std::stoi(program.get("--latency"));
   }
 
+  if (program.get<bool>("--page-table")) {
+    // split the duration over the two tables and the three thread counts
+    RunPageTableBench(std::max<uint64_t>(1, duration_ms / 6));
+    return 0;
+  }
+  if (program.get<bool>("--hit-rate")) {
+    RunHitRateBench();
+    return 0;
+  }
+
+  size_t bpm_instances = 1;
+  if (program.present("--instances")) {
+    bpm_instances = std::max(1, std::stoi(program.get("--instances")));
+  }
+
+  auto replacer_policy = bustub::ReplacerPolicy::LRUK;
+  if (program.present("--replacer")) {
+    replacer_policy = ParseReplacerPolicy(program.get("--replacer"));
+  }
+
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  std::unique_ptr<BufferPoolManager> bpm;
+  if (bpm_instances > 1) {
+    // keep the total number of frames fixed so that runs with different instance counts are comparable
+    auto instance_size = std::max<size_t>(1, BUSTUB_BPM_SIZE / bpm_instances);
+    bpm = std::make_unique<ParallelBufferPoolManager>(bpm_instances, instance_size, disk_manager.get(), LRU_K_SIZE,
+                                                      nullptr, replacer_policy);
+  } else {
+    bpm = std::make_unique<BufferPoolManagerInstance>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE, nullptr,
+                                                      replacer_policy);
+  }
   std::vector<page_id_t> page_ids;
 
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr,
+             "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}, bpm_instances={}, "
+             "replacer={}\n",
+             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, bpm->GetPoolSize(), bpm_instances,
+             bustub::ReplacerPolicyToString(replacer_policy));
 
   for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
     page_id_t page_id;
@@ -152,6 +400,25 @@ auto main(int argc, char **argv) -> int {
   // enable disk latency after creating all pages
   disk_manager->SetLatency(latency_ms);
 
+  if (program.present("--bg-writer")) {
+    bpm->StartBackgroundWriter(std::stoul(program.get("--bg-writer")));
+  }
+
+  size_t prefetch_distance = 0;
+  if (program.present("--prefetch")) {
+    prefetch_distance = std::stoul(program.get("--prefetch"));
+  }
+
+  if (program.present("--heat-map")) {
+    bpm->SetHeatMapSampleInterval(std::stoul(program.get("--heat-map")));
+  }
+
+  if (program.present("--compressed-cache")) {
+    bpm->SetCompressedCacheCapacity(std::stoul(program.get("--compressed-cache")) << 20);
+  }
+
+  const bool epoch_reads = program.get<bool>("--epoch-reads");
+
   fmt::print(stderr, "[info] benchmark start\n");
 
   BpmTotalMetrics total_metrics;
@@ -160,13 +427,16 @@ auto main(int argc, char **argv) -> int {
   std::vector<std::thread> threads;
 
   for (size_t thread_id = 0; thread_id < BUSTUB_SCAN_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, prefetch_distance, &total_metrics] {
       BpmMetrics metrics(fmt::format("scan {:>2}", thread_id), duration_ms);
       metrics.Begin();
 
       size_t page_idx = BUSTUB_PAGE_CNT * thread_id / BUSTUB_SCAN_THREAD;
 
       while (!metrics.ShouldFinish()) {
+        if (prefetch_distance > 0) {
+          bpm->Prefetch({page_ids[(page_idx + prefetch_distance) % BUSTUB_PAGE_CNT]});
+        }
         auto *page = bpm->FetchPage(page_ids[page_idx], AccessType::Scan);
         if (page == nullptr) {
           continue;
@@ -191,7 +461,7 @@ auto main(int argc, char **argv) -> int {
   }
 
   for (size_t thread_id = 0; thread_id < BUSTUB_GET_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, epoch_reads, &total_metrics] {
       std::random_device r;
       std::default_random_engine gen(r());
       zipfian_int_distribution<size_t> dist(0, BUSTUB_PAGE_CNT - 1, 0.8);
@@ -201,6 +471,19 @@ auto main(int argc, char **argv) -> int {
 
       while (!metrics.ShouldFinish()) {
         auto page_idx = dist(gen);
+        if (epoch_reads) {
+          auto guard = bpm->FetchPageEpoch(page_ids[page_idx]);
+          if (!guard.IsValid()) {
+            continue;
+          }
+          if (guard.GetData()[page_idx % 1024] == 0) {
+            throw std::runtime_error("invalid data");
+          }
+          guard.Drop();
+          metrics.Tick();
+          metrics.Report();
+          continue;
+        }
         auto *page = bpm->FetchPage(page_ids[page_idx], AccessType::Get);
         if (page == nullptr) {
           continue;
@@ -227,6 +510,8 @@ auto main(int argc, char **argv) -> int {
   }
 
   total_metrics.Report();
+  ReportShards(bpm.get());
+  ReportStats(bpm.get());
 
   return 0;
 }
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <memory>
@@ -6,13 +7,14 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include <cpp_random_distributions/zipfian_int_distribution.h>
 
 #include "argparse/argparse.hpp"
 #include "binder/binder.h"
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "buffer/lru_k_replacer.h"
 #include "common/config.h"
 #include "common/exception.h"
@@ -20,7 +22,9 @@
 #include "common/util/string_util.h"
 #include "fmt/format.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/mmap_disk_manager.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
 #include "storage/index/generic_key.h"
 #include "test_util.h"
 
@@ -110,15 +114,139 @@ auto KeyWillVanish(size_t key) -> bool { return key % 7 == 0; }
 // These keys will be overwritten to a new value
 auto KeyWillChange(size_t key) -> bool { return key % 5 == 0; }
 
+/**
+ * Insert TOTAL_KEYS keys into an empty tree from num_threads threads, each taking every num_threads-th key in random
+ * order, and then look all of them up the same way.
+ * @return the inserts and the lookups per second
+ */
+auto RunScalingStep(size_t num_threads) -> std::pair<double, double> {
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  auto key_schema = bustub::ParseCreateStatement("a bigint");
+  bustub::GenericComparator<8> comparator(key_schema.get());
+  bustub::page_id_t page_id;
+  auto header_page = bpm->NewPageGuarded(&page_id);
+  bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>> index("foo_pk", page_id,
+                                                                                            bpm.get(), comparator);
+
+  std::vector<std::vector<size_t>> thread_keys(num_threads);
+  for (size_t key = 0; key < TOTAL_KEYS; key++) {
+    thread_keys[key % num_threads].push_back(key);
+  }
+  std::default_random_engine gen(15445);
+  for (auto &keys : thread_keys) {
+    std::shuffle(keys.begin(), keys.end(), gen);
+  }
+
+  auto run = [&](bool insert) {
+    auto start = ClockMs();
+    std::vector<std::thread> threads;
+    for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
+      threads.emplace_back([&, thread_id] {
+        bustub::GenericKey<8> index_key;
+        std::vector<bustub::RID> rids;
+        for (auto key : thread_keys[thread_id]) {
+          index_key.SetFromInteger(key);
+          if (insert) {
+            uint32_t value = key;
+            index.Insert(index_key, bustub::RID(value, value), nullptr);
+          } else if (!index.GetValue(index_key, &rids)) {
+            throw std::runtime_error(fmt::format("key not found: {}", key));
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    return TOTAL_KEYS / static_cast<double>(std::max<uint64_t>(ClockMs() - start, 1)) * 1000;
+  };
+  auto insert_per_sec = run(true);
+  auto lookup_per_sec = run(false);
+  return {insert_per_sec, lookup_per_sec};
+}
+
+/** Run RunScalingStep for 1 to max_threads threads, doubling each time, and print the throughput curve. */
+void RunScaling(size_t max_threads) {
+  fmt::print(stderr, "[info] scaling: total_keys={}, bpm_size={}, threads=1..{}\n", TOTAL_KEYS, BUSTUB_BPM_SIZE,
+             max_threads);
+  fmt::print("<<< BEGIN\n");
+  fmt::print("{:>8} {:>14} {:>8} {:>14} {:>8}\n", "threads", "insert/s", "speedup", "lookup/s", "speedup");
+  std::pair<double, double> base;
+  for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    auto result = RunScalingStep(num_threads);
+    if (num_threads == 1) {
+      base = result;
+    }
+    fmt::print("{:>8} {:>14.0f} {:>8.2f} {:>14.0f} {:>8.2f}\n", num_threads, result.first, result.first / base.first,
+               result.second, result.second / base.second);
+  }
+  fmt::print(">>> END\n");
+}
+
+/**
+ * Build an index on num_keys keys in random order, once with one Insert per key and once by sorting the keys and
+ * loading them bottom-up, the way CREATE INDEX backfills an index, and print how long each took.
+ */
+void RunBulkLoad(size_t num_keys) {
+  using Tree = bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>>;
+  fmt::print(stderr, "[info] bulk load: keys={}, bpm_size={}\n", num_keys, BUSTUB_BPM_SIZE);
+  auto key_schema = bustub::ParseCreateStatement("a bigint");
+  bustub::GenericComparator<8> comparator(key_schema.get());
+  std::vector<size_t> keys(num_keys);
+  for (size_t key = 0; key < num_keys; key++) {
+    keys[key] = key;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine(15445));
+
+  fmt::print("<<< BEGIN\n");
+  for (bool bulk : {false, true}) {
+    auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+    bustub::page_id_t page_id;
+    auto header_page = bpm->NewPageGuarded(&page_id);
+    Tree index("foo_pk", page_id, bpm.get(), comparator);
+    bustub::GenericKey<8> index_key;
+    auto start = ClockMs();
+    if (bulk) {
+      bustub::ExternalSorter<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>> sorter(comparator);
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        sorter.Add(index_key, bustub::RID(key));
+      }
+      auto ring = bustub::BufferRing::OfBytes(bustub::BULK_WRITE_RING_BYTES);
+      index.BulkLoad([&](auto *key, auto *value) { return sorter.Next(key, value); },
+                     bustub::BPLUS_TREE_BULK_LOAD_FILL_FACTOR, &ring);
+    } else {
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        index.Insert(index_key, bustub::RID(key), nullptr);
+      }
+    }
+    auto elapsed = ClockMs() - start;
+    fmt::print("{:>12}: {} ms\n", bulk ? "bulk load" : "insert", elapsed);
+  }
+  fmt::print(">>> END\n");
+}
+
 // NOLINTNEXTLINE
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
-  using bustub::BufferPoolManager;
+  using bustub::BufferPoolManagerInstance;
+  using bustub::DiskManager;
   using bustub::DiskManagerUnlimitedMemory;
+  using bustub::MmapDiskManager;
   using bustub::page_id_t;
 
   argparse::ArgumentParser program("bustub-btree-bench");
   program.add_argument("--duration").help("run btree bench for n milliseconds");
+  program.add_argument("--disk-manager")
+      .help("memory, file, or mmap to build the index in a file and read it back read-only from a mapping of it");
+  program.add_argument("--write-threads").help("run n write threads next to the read threads");
+  program.add_argument("--scaling")
+      .help("instead of the mixed workload, measure inserts and lookups from 1, 2, 4, ... up to n threads");
+  program.add_argument("--bulk-load")
+      .help("instead of the mixed workload, compare building an index on n keys by inserts and by bulk load");
 
   try {
     program.parse_args(argc, argv);
@@ -128,16 +256,55 @@ auto main(int argc, char **argv) -> int {
     return 1;
   }
 
+  if (program.present("--scaling")) {
+    RunScaling(std::stoi(program.get("--scaling")));
+    return 0;
+  }
+
+  if (program.present("--bulk-load")) {
+    RunBulkLoad(std::stoul(program.get("--bulk-load")));
+    return 0;
+  }
+
   uint64_t duration_ms = 30000;
   if (program.present("--duration")) {
     duration_ms = std::stoi(program.get("--duration"));
   }
 
-  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  size_t write_threads = BUSTUB_WRITE_THREAD;
+  if (program.present("--write-threads")) {
+    write_threads = std::stoi(program.get("--write-threads"));
+  }
+
+  std::string disk_manager_name = "memory";
+  if (program.present("--disk-manager")) {
+    disk_manager_name = program.get("--disk-manager");
+  }
+  const bool mapped = disk_manager_name == "mmap";
+  if (mapped && write_threads > 0) {
+    // the mapping is only read while nothing writes the file
+    if (program.present("--write-threads")) {
+      std::cerr << "--disk-manager mmap opens the index read-only, so it runs no write threads" << std::endl;
+      return 1;
+    }
+    write_threads = 0;
+  }
+  const std::string db_file = "btree_bench.db";
+  std::unique_ptr<DiskManager> disk_manager;
+  if (disk_manager_name == "memory") {
+    disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  } else if (disk_manager_name == "file" || mapped) {
+    remove(db_file.c_str());
+    remove("btree_bench.fsm");
+    disk_manager = std::make_unique<DiskManager>(db_file);
+  } else {
+    std::cerr << "unknown disk manager: " << disk_manager_name << std::endl;
+    return 1;
+  }
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
 
-  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}\n", TOTAL_KEYS, duration_ms,
-             LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}, disk_manager={}\n", TOTAL_KEYS,
+             duration_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE, disk_manager_name);
 
   auto key_schema = bustub::ParseCreateStatement("a bigint");
   bustub::GenericComparator<8> comparator(key_schema.get());
@@ -145,8 +312,8 @@ auto main(int argc, char **argv) -> int {
   page_id_t page_id;
   auto header_page = bpm->NewPageGuarded(&page_id);
 
-  bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>> index("foo_pk", page_id,
-                                                                                            bpm.get(), comparator);
+  using BPlusTree = bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>>;
+  auto index = std::make_unique<BPlusTree>("foo_pk", page_id, bpm.get(), comparator);
 
   for (size_t key = 0; key < TOTAL_KEYS; key++) {
     bustub::GenericKey<8> index_key;
@@ -154,7 +321,25 @@ auto main(int argc, char **argv) -> int {
     uint32_t value = key;
     rid.Set(value, value);
     index_key.SetFromInteger(key);
-    index.Insert(index_key, rid, nullptr);
+    index->Insert(index_key, rid, nullptr);
+  }
+
+  if (mapped) {
+    // write the tree out and open it again read-only, so that reads of pages that are not resident come from the
+    // mapping
+    header_page.Drop();
+    index.reset();
+    bpm->FlushAllPages();
+    bpm.reset();
+    disk_manager->ShutDown();
+    disk_manager = std::make_unique<MmapDiskManager>(db_file);
+    bpm = std::make_unique<BufferPoolManagerInstance>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+    // the default sizes of the tree, see LEAF_PAGE_SIZE and INTERNAL_PAGE_SIZE
+    using KeyValue = std::pair<bustub::GenericKey<8>, bustub::RID>;
+    const int leaf_max_size = (bustub::BUSTUB_PAGE_DATA_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(KeyValue);
+    const int internal_max_size = (bustub::BUSTUB_PAGE_DATA_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(KeyValue);
+    index = std::make_unique<BPlusTree>("foo_pk", page_id, bpm.get(), comparator, leaf_max_size, internal_max_size,
+                                        true);
   }
 
   fmt::print(stderr, "[info] benchmark start\n");
@@ -165,7 +350,7 @@ auto main(int argc, char **argv) -> int {
   std::vector<std::thread> threads;
 
   for (size_t thread_id = 0; thread_id < BUSTUB_READ_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, index = index.get(), duration_ms, &total_metrics] {
       BTreeMetrics metrics(fmt::format("read  {:>2}", thread_id), duration_ms);
       metrics.Begin();
 
@@ -184,7 +369,7 @@ auto main(int argc, char **argv) -> int {
         for (auto key = base_key; key < key_end && cnt < KEY_MODIFY_RANGE; key++, cnt++) {
           rids.clear();
           index_key.SetFromInteger(key);
-          index.GetValue(index_key, &rids);
+          index->GetValue(index_key, &rids);
 
           if (!KeyWillVanish(key) && rids.empty()) {
             std::string msg = fmt::format("key not found: {}", key);
@@ -210,13 +395,13 @@ auto main(int argc, char **argv) -> int {
     }));
   }
 
-  for (size_t thread_id = 0; thread_id < BUSTUB_WRITE_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics] {
+  for (size_t thread_id = 0; thread_id < write_threads; thread_id++) {
+    threads.emplace_back(std::thread([thread_id, index = index.get(), duration_ms, write_threads, &total_metrics] {
       BTreeMetrics metrics(fmt::format("write {:>2}", thread_id), duration_ms);
       metrics.Begin();
 
-      size_t key_start = TOTAL_KEYS / BUSTUB_WRITE_THREAD * thread_id;
-      size_t key_end = TOTAL_KEYS / BUSTUB_WRITE_THREAD * (thread_id + 1);
+      size_t key_start = TOTAL_KEYS / write_threads * thread_id;
+      size_t key_end = TOTAL_KEYS / write_threads * (thread_id + 1);
       std::random_device r;
       std::default_random_engine gen(r());
       std::uniform_int_distribution<size_t> dis(key_start, key_end - 1);
@@ -235,9 +420,9 @@ auto main(int argc, char **argv) -> int {
             rid.Set(value, value);
             index_key.SetFromInteger(key);
             if (do_insert) {
-              index.Insert(index_key, rid, nullptr);
+              index->Insert(index_key, rid, nullptr);
             } else {
-              index.Remove(index_key, nullptr);
+              index->Remove(index_key, nullptr);
             }
             metrics.Tick();
             metrics.Report();
@@ -245,7 +430,7 @@ auto main(int argc, char **argv) -> int {
             uint32_t value = key;
             rid.Set(value, dis(gen));
             index_key.SetFromInteger(key);
-            index.Insert(index_key, rid, nullptr);
+            index->Insert(index_key, rid, nullptr);
             metrics.Tick();
             metrics.Report();
           }
@@ -262,6 +447,18 @@ auto main(int argc, char **argv) -> int {
   }
 
   total_metrics.Report();
+  fmt::print(stderr, "[info] hits={}, misses={}, mapped_reads={}\n", bpm->GetHitCount(), bpm->GetMissCount(),
+             bpm->GetMappedReadCount());
+
+  if (disk_manager_name != "memory") {
+    header_page.Drop();
+    bpm.reset();
+    disk_manager->ShutDown();
+    disk_manager.reset();
+    remove(db_file.c_str());
+    remove("btree_bench.log");
+    remove("btree_bench.fsm");
+  }
 
   return 0;
 }
@@ -0,0 +1,133 @@
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/config.h"
+#include "common/util/crc32c.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page_checksum.h"
+
+/** Pages each thread reads with one pread. */
+static const size_t SCRUB_BATCH_PAGES = 64;
+
+/**
+ * Verify the checksum of every page of a database file, with the file split into batches that a pool of threads
+ * takes in turn. Prints the pages that fail and exits with 1 if there are any.
+ */
+auto main(int argc, char **argv) -> int {
+  using bustub::page_id_t;
+  using bustub::BUSTUB_PAGE_SIZE;
+  using bustub::DbFileHeader;
+  using bustub::DiskManager;
+  using bustub::PageChecksum;
+
+  argparse::ArgumentParser program("bustub-scrub");
+  program.add_argument("file").help("the database file to verify");
+  program.add_argument("--threads").help("verify with n threads, one per core by default");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  const auto file_name = program.get<std::string>("file");
+  size_t num_threads = std::max(1U, std::thread::hardware_concurrency());
+  if (program.present("--threads")) {
+    num_threads = std::max(1, std::stoi(program.get("--threads")));
+  }
+
+  int fd = open(file_name.c_str(), O_RDONLY);
+  struct stat file_stat;
+  if (fd < 0 || fstat(fd, &file_stat) != 0) {
+    std::cerr << "Failed to open " << file_name << std::endl;
+    return 1;
+  }
+  DbFileHeader header{0, 0};
+  if (pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+      header.magic_ != DbFileHeader::MAGIC) {
+    std::cerr << file_name << " is not a database file" << std::endl;
+    return 1;
+  }
+  if (header.page_size_ != static_cast<uint32_t>(BUSTUB_PAGE_SIZE)) {
+    std::cerr << file_name << " has a page size of " << header.page_size_ << " bytes, but this build uses "
+              << BUSTUB_PAGE_SIZE << std::endl;
+    return 1;
+  }
+  // the pages follow the header page
+  const auto file_size = std::max(static_cast<size_t>(file_stat.st_size), DiskManager::PageOffset(0)) -
+                         DiskManager::PageOffset(0);
+  const size_t num_pages = file_size / BUSTUB_PAGE_SIZE;
+
+  fmt::print(stderr, "[info] file={}, pages={}, page_size={}, threads={}, crc32c={}\n", file_name, num_pages,
+             BUSTUB_PAGE_SIZE, num_threads, bustub::Crc32c::IsHardwareAccelerated() ? "sse4.2" : "software");
+
+  std::atomic<size_t> next_batch{0};
+  std::atomic<bool> read_failed{false};
+  std::mutex bad_pages_latch;
+  std::vector<page_id_t> bad_pages;
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([&] {
+      std::vector<char> buffer(SCRUB_BATCH_PAGES * BUSTUB_PAGE_SIZE);
+      std::vector<page_id_t> thread_bad_pages;
+      for (size_t first = next_batch.fetch_add(SCRUB_BATCH_PAGES); first < num_pages;
+           first = next_batch.fetch_add(SCRUB_BATCH_PAGES)) {
+        const size_t count = std::min(SCRUB_BATCH_PAGES, num_pages - first);
+        const size_t bytes = count * BUSTUB_PAGE_SIZE;
+        if (pread(fd, buffer.data(), bytes, static_cast<off_t>(DiskManager::PageOffset(static_cast<page_id_t>(first)))) !=
+            static_cast<ssize_t>(bytes)) {
+          read_failed = true;
+          return;
+        }
+        for (size_t j = 0; j < count; j++) {
+          const auto page_id = static_cast<page_id_t>(first + j);
+          if (!PageChecksum::Verify(page_id, &buffer[j * BUSTUB_PAGE_SIZE])) {
+            thread_bad_pages.push_back(page_id);
+          }
+        }
+      }
+      std::scoped_lock lock{bad_pages_latch};
+      bad_pages.insert(bad_pages.end(), thread_bad_pages.begin(), thread_bad_pages.end());
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  close(fd);
+  auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+  if (read_failed) {
+    std::cerr << "Failed to read " << file_name << std::endl;
+    return 1;
+  }
+  std::sort(bad_pages.begin(), bad_pages.end());
+  for (auto page_id : bad_pages) {
+    fmt::print("page {:<8} checksum mismatch\n", page_id);
+  }
+  // a file that ends inside a page was cut short by a torn write that extended it
+  const bool torn_tail = file_size % BUSTUB_PAGE_SIZE != 0;
+  if (torn_tail) {
+    fmt::print("page {:<8} truncated to {} bytes\n", num_pages, file_size % BUSTUB_PAGE_SIZE);
+  }
+  fmt::print("verified {} pages in {} ms ({:.1f} MiB/s), {} corrupted\n", num_pages, elapsed_ms,
+             static_cast<double>(file_size) / (1 << 20) / (std::max<int64_t>(elapsed_ms, 1) / 1000.0),
+             bad_pages.size() + (torn_tail ? 1 : 0));
+  return bad_pages.empty() && !torn_tail ? 0 : 1;
+}
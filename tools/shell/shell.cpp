@@ -27,24 +27,29 @@ auto GetWidthOfUtf8(const void *beg, const void *end, size_t *width) -> int {
 auto main(int argc, char **argv) -> int {
   ft_set_u8strwid_func(&GetWidthOfUtf8);
 
-  auto bustub = std::make_unique<bustub::BustubInstance>("test.db");
-
   auto default_prompt = "bustub> ";
   auto emoji_prompt = "\U0001f6c1> ";  // the bathtub emoji
   bool use_emoji_prompt = false;
   bool disable_tty = false;
+  size_t pool_size = bustub::DEFAULT_INSTANCE_POOL_SIZE;
 
   for (int i = 1; i < argc; i++) {
     if (strcmp(argv[i], "--emoji-prompt") == 0) {
       use_emoji_prompt = true;
-      break;
-    }
-    if (strcmp(argv[i], "--disable-tty") == 0) {
+    } else if (strcmp(argv[i], "--disable-tty") == 0) {
       disable_tty = true;
-      break;
+    } else if (strcmp(argv[i], "--pool-size") == 0 && i + 1 < argc) {
+      try {
+        pool_size = bustub::BustubInstance::ParsePoolSize(argv[++i]);
+      } catch (const bustub::Exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+      }
     }
   }
 
+  auto bustub = std::make_unique<bustub::BustubInstance>("test.db", 1, pool_size);
+
   bustub->GenerateMockTable();
 
   if (bustub->buffer_pool_manager_ != nullptr) {
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <fstream>
 #include <ios>
 #include <iostream>
@@ -147,6 +148,7 @@ auto main(int argc, char **argv) -> int {  // NOLINT
   program.add_argument("--verbose").help("increase output verbosity").default_value(false).implicit_value(true);
   program.add_argument("-d", "--diff").help("write diff file").default_value(false).implicit_value(true);
   program.add_argument("--in-memory").help("use in-memory backend").default_value(false).implicit_value(true);
+  program.add_argument("--pool-size").help("number of buffer pool frames");
 
   try {
     program.parse_args(argc, argv);
@@ -171,12 +173,23 @@ auto main(int argc, char **argv) -> int {  // NOLINT
 
   auto result = bustub::SQLLogicTestParser::Parse(script);
 
+  size_t pool_size = bustub::DEFAULT_INSTANCE_POOL_SIZE;
+  if (program.present("--pool-size")) {
+    try {
+      pool_size = bustub::BustubInstance::ParsePoolSize(program.get("--pool-size"));
+    } catch (const bustub::Exception &ex) {
+      std::cerr << ex.what() << std::endl;
+      std::cerr << program;
+      return 1;
+    }
+  }
+
   std::unique_ptr<bustub::BustubInstance> bustub;
 
   if (program.get<bool>("--in-memory")) {
-    bustub = std::make_unique<bustub::BustubInstance>();
+    bustub = std::make_unique<bustub::BustubInstance>(1, pool_size);
   } else {
-    bustub = std::make_unique<bustub::BustubInstance>("test.db");
+    bustub = std::make_unique<bustub::BustubInstance>("test.db", 1, pool_size);
   }
 
   bustub->GenerateMockTable();